@@ -8,11 +8,14 @@
 #include "../utils/logger.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
 
-EventMapper::EventMapper(ConfigManager* configManager)
-    : m_configManager(configManager), m_mouseSensitivity(1.0f), m_deadZone(3200) {
+EventMapper::EventMapper(ConfigManager* configManager, Clock* clock)
+    : m_configManager(configManager), m_clock(clock ? clock : Clock::getDefault()),
+      m_mouseSensitivity(1.0f), m_deadZone(3200),
+      m_stickFilterEnabled(true) {
     
-    m_lastMouseMoveTime = std::chrono::steady_clock::now();
+    m_lastMouseMoveMicros = m_clock->nowMicros();
     
     // Carregar mapeamentos padrão
     // Estes serão substituídos se existirem configurações salvas
@@ -22,6 +25,10 @@ EventMapper::EventMapper(ConfigManager* configManager)
     loadMappingsFromConfig();
 }
 
+Clock* EventMapper::getClock() const {
+    return m_clock;
+}
+
 void EventMapper::setupDefaultMappings() {
     // Mapeamentos padrão de teclas para botões
     m_keyMappings = {
@@ -73,9 +80,52 @@ void EventMapper::loadMappingsFromConfig() {
         Logger::info("Dead zone carregada: " + std::to_string(m_deadZone));
     }
     
+    // Filtro One-Euro dos analógicos controlados pelo mouse
+    m_stickFilterEnabled = m_configManager->getBoolValue("stick_filter_enabled", m_stickFilterEnabled);
+    const float minCutoff = m_configManager->getFloatValue("stick_filter_min_cutoff", 5.0f);
+    const float beta = m_configManager->getFloatValue("stick_filter_beta", 0.0005f);
+    const float derivativeCutoff = m_configManager->getFloatValue("stick_filter_d_cutoff", 1.0f);
+    for (auto& filter : m_stickFilters) {
+        filter.setParameters(minCutoff, beta, derivativeCutoff);
+        filter.reset();
+    }
+    
+    if (m_stickFilterEnabled) {
+        Logger::info("Filtro dos analógicos: corte mínimo " + std::to_string(minCutoff) +
+                     " Hz, beta " + std::to_string(beta));
+    }
+    
+    loadRulesFromConfig();
+    
     // Na implementação final, carregue também os mapeamentos de teclas, eixos, etc.
 }
 
+void EventMapper::loadRulesFromConfig() {
+    const std::string prefix = "mapping_rule_";
+    
+    // Ordenar pelo número após o prefixo ("mapping_rule_2" antes de "mapping_rule_10")
+    std::vector<std::pair<int, std::string>> ruleKeys;
+    for (const auto& key : m_configManager->getAllKeys()) {
+        if (key.compare(0, prefix.size(), prefix) == 0) {
+            ruleKeys.emplace_back(std::atoi(key.c_str() + prefix.size()), key);
+        }
+    }
+    std::sort(ruleKeys.begin(), ruleKeys.end());
+    
+    m_rules.clear();
+    for (const auto& entry : ruleKeys) {
+        const std::string text = m_configManager->getStringValue(entry.second);
+        std::string error;
+        if (!m_rules.addRule(text, error)) {
+            Logger::warning("Regra ignorada " + entry.second + " (\"" + text + "\"): " + error);
+        }
+    }
+    
+    if (!m_rules.empty()) {
+        Logger::info("Regras de mapeamento compiladas: " + std::to_string(m_rules.size()));
+    }
+}
+
 void EventMapper::saveMappingsToConfig() {
     // Salvar configurações atuais no ConfigManager
     m_configManager->setFloatValue("mouse_sensitivity", m_mouseSensitivity);
@@ -87,17 +137,47 @@ void EventMapper::saveMappingsToConfig() {
     Logger::info("Configurações de mapeamento salvas");
 }
 
-ControllerAction EventMapper::mapEvent(const InputEvent& event) {
+size_t EventMapper::mapEvent(const InputEvent& event, MappedActions& actions) {
+    actions.count = 0;
+    
+    updateRuleInputState(event);
+    
     // Mapeia diferentes tipos de eventos para ações do controle
     switch (event.type) {
         case InputEvent::TYPE_KEYBOARD:
-            return mapKeyboardEvent(event.data.keyboard);
+            actions.add(mapKeyboardEvent(event.data.keyboard));
+            break;
             
         case InputEvent::TYPE_MOUSE:
-            return mapMouseEvent(event.data.mouse);
+            mapMouseEvent(event.data.mouse, actions);
+            break;
             
         default:
-            return ControllerAction(); // Ação vazia
+            return 0; // Nenhuma ação
+    }
+    
+    // Regras condicionais podem bloquear, trocar ou escalar cada ação, na ordem
+    for (size_t i = 0; i < actions.count; i++) {
+        if (!m_rules.empty()) {
+            m_rules.apply(actions.actions[i], m_ruleState);
+        }
+        m_ruleState.applyAction(actions.actions[i]);
+    }
+    
+    return actions.count;
+}
+
+void EventMapper::updateRuleInputState(const InputEvent& event) {
+    if (event.type == InputEvent::TYPE_KEYBOARD) {
+        m_ruleState.setKey(event.data.keyboard.code, !(event.data.keyboard.state & INTERCEPTION_KEY_UP));
+    } else if (event.type == InputEvent::TYPE_MOUSE) {
+        const unsigned short state = event.data.mouse.state;
+        if (state & INTERCEPTION_MOUSE_LEFT_BUTTON_DOWN) m_ruleState.mouseButtons |= 1;
+        if (state & INTERCEPTION_MOUSE_LEFT_BUTTON_UP) m_ruleState.mouseButtons &= ~1;
+        if (state & INTERCEPTION_MOUSE_RIGHT_BUTTON_DOWN) m_ruleState.mouseButtons |= 2;
+        if (state & INTERCEPTION_MOUSE_RIGHT_BUTTON_UP) m_ruleState.mouseButtons &= ~2;
+        if (state & INTERCEPTION_MOUSE_MIDDLE_BUTTON_DOWN) m_ruleState.mouseButtons |= 4;
+        if (state & INTERCEPTION_MOUSE_MIDDLE_BUTTON_UP) m_ruleState.mouseButtons &= ~4;
     }
 }
 
@@ -163,7 +243,7 @@ ControllerAction EventMapper::updateAxisFromKeys(const AxisMapping& mapping) {
     return action;
 }
 
-ControllerAction EventMapper::mapMouseEvent(const InterceptionMouseStroke& mouseStroke) {
+void EventMapper::mapMouseEvent(const InterceptionMouseStroke& mouseStroke, MappedActions& actions) {
     ControllerAction action;
     
     // Processamento de botões do mouse
@@ -171,72 +251,63 @@ ControllerAction EventMapper::mapMouseEvent(const InterceptionMouseStroke& mouse
         action.type = ControllerAction::TYPE_BUTTON;
         action.data.buttonData.button = XUSB_GAMEPAD_RIGHT_THUMB; // Usar botão analógico direito
         action.data.buttonData.pressed = true;
-        return action;
+        actions.add(action);
+        return;
     }
     
     if (mouseStroke.state & INTERCEPTION_MOUSE_LEFT_BUTTON_UP) {
         action.type = ControllerAction::TYPE_BUTTON;
         action.data.buttonData.button = XUSB_GAMEPAD_RIGHT_THUMB;
         action.data.buttonData.pressed = false;
-        return action;
+        actions.add(action);
+        return;
     }
     
     if (mouseStroke.state & INTERCEPTION_MOUSE_RIGHT_BUTTON_DOWN) {
         action.type = ControllerAction::TYPE_BUTTON;
         action.data.buttonData.button = XUSB_GAMEPAD_LEFT_THUMB; // Usar botão analógico esquerdo
         action.data.buttonData.pressed = true;
-        return action;
+        actions.add(action);
+        return;
     }
     
     if (mouseStroke.state & INTERCEPTION_MOUSE_RIGHT_BUTTON_UP) {
         action.type = ControllerAction::TYPE_BUTTON;
         action.data.buttonData.button = XUSB_GAMEPAD_LEFT_THUMB;
         action.data.buttonData.pressed = false;
-        return action;
+        actions.add(action);
+        return;
     }
     
     // Processamento de movimento do mouse para eixos analógicos
-    if (mouseStroke.state & INTERCEPTION_MOUSE_MOVE_RELATIVE) {
+    // (INTERCEPTION_MOUSE_MOVE_RELATIVE vale 0 e fica em flags, não em state)
+    if (!(mouseStroke.flags & INTERCEPTION_MOUSE_MOVE_ABSOLUTE) &&
+        (mouseStroke.x != 0 || mouseStroke.y != 0)) {
         // Calcular delta de tempo desde o último movimento
-        auto currentTime = std::chrono::steady_clock::now();
-        float deltaTime = std::chrono::duration<float>(currentTime - m_lastMouseMoveTime).count();
-        m_lastMouseMoveTime = currentTime;
-        
-        // Evitar divisão por zero
-        if (deltaTime < 0.001f) deltaTime = 0.001f;
+        const int64_t currentMicros = m_clock->nowMicros();
+        const int64_t deltaMicros = currentMicros - m_lastMouseMoveMicros;
+        const float deltaTime = static_cast<float>(deltaMicros) / 1000000.0f;
+        m_lastMouseMoveMicros = currentMicros;
         
-        // Calcular velocidade (pixels por segundo)
-        float xSpeed = static_cast<float>(mouseStroke.x) / deltaTime;
-        float ySpeed = static_cast<float>(mouseStroke.y) / deltaTime;
-        
-        // Aplicar sensibilidade e limitar valor
+        // Aplicar sensibilidade, limite e dead zone (mesma referência do kernel em lote);
+        // uma ação por mapeamento, como mapMouseMotionBatch, para que X e Y se movam juntos
         for (const auto& mapping : m_mouseMappings) {
+            if (mapping.mouseAxis != 0 && mapping.mouseAxis != 1) {
+                continue;
+            }
+            
+            const int delta = (mapping.mouseAxis == 0) ? mouseStroke.x : mouseStroke.y;
+            const MouseAxisParams params(mapping.sensitivity, m_mouseSensitivity, m_deadZone, mapping.invert);
+            
             action.type = ControllerAction::TYPE_AXIS;
             action.data.axisData.axis = mapping.controllerAxis;
-            
-            if (mapping.mouseAxis == 0) { // Eixo X
-                float value = xSpeed * mapping.sensitivity * m_mouseSensitivity;
-                value = std::max(-32767.0f, std::min(32767.0f, value));
-                action.data.axisData.value = mapping.invert ? -static_cast<short>(value) : static_cast<short>(value);
-                
-                // Aplicar dead zone
-                if (std::abs(action.data.axisData.value) < m_deadZone) {
-                    action.data.axisData.value = 0;
-                }
-                
-                return action;
-            } else if (mapping.mouseAxis == 1) { // Eixo Y
-                float value = ySpeed * mapping.sensitivity * m_mouseSensitivity;
-                value = std::max(-32767.0f, std::min(32767.0f, value));
-                action.data.axisData.value = mapping.invert ? -static_cast<short>(value) : static_cast<short>(value);
-                
-                // Aplicar dead zone
-                if (std::abs(action.data.axisData.value) < m_deadZone) {
-                    action.data.axisData.value = 0;
-                }
-                
-                return action;
-            }
+            action.data.axisData.value = filterStickValue(mapping.controllerAxis,
+                mapMouseAxisValue(delta, deltaTime, params), deltaMicros);
+            actions.add(action);
+        }
+        
+        if (actions.count > 0) {
+            return;
         }
     }
     
@@ -258,14 +329,82 @@ ControllerAction EventMapper::mapMouseEvent(const InterceptionMouseStroke& mouse
                 action.data.triggerData.value = 255; // Valor máximo
             }
             
-            return action;
+            actions.add(action);
         }
     }
+}
+
+size_t EventMapper::mapMouseMotionBatch(const InterceptionMouseStroke* strokes, const float* deltaTimes,
+                                        size_t count, std::vector<ControllerAction>& actions) {
+    actions.clear();
+    
+    if (count == 0 || m_mouseMappings.empty()) {
+        return 0;
+    }
     
-    return action; // Ação vazia se não houver mapeamento
+    const size_t mappingCount = m_mouseMappings.size();
+    actions.resize(count * mappingCount);
+    m_batchDeltas.resize(count);
+    m_batchValues.resize(count);
+    
+    for (size_t m = 0; m < mappingCount; m++) {
+        const MouseAxisMapping& mapping = m_mouseMappings[m];
+        if (mapping.mouseAxis != 0 && mapping.mouseAxis != 1) {
+            continue;
+        }
+        
+        // Separar o eixo do mouse em um vetor contíguo para o kernel
+        for (size_t i = 0; i < count; i++) {
+            m_batchDeltas[i] = (mapping.mouseAxis == 0) ? strokes[i].x : strokes[i].y;
+        }
+        
+        const MouseAxisParams params(mapping.sensitivity, m_mouseSensitivity, m_deadZone, mapping.invert);
+        mapMouseAxisBatch(m_batchDeltas.data(), deltaTimes, count, params, m_batchValues.data());
+        
+        // O filtro depende da amostra anterior, então roda em ordem após o kernel
+        for (size_t i = 0; i < count; i++) {
+            const int64_t deltaMicros = std::llround(deltaTimes[i] * 1000000.0f);
+            
+            ControllerAction& action = actions[i * mappingCount + m];
+            action.type = ControllerAction::TYPE_AXIS;
+            action.data.axisData.axis = mapping.controllerAxis;
+            action.data.axisData.value = filterStickValue(mapping.controllerAxis, m_batchValues[i], deltaMicros);
+        }
+    }
+    
+    // Aplicar regras condicionais na ordem dos movimentos
+    for (auto& action : actions) {
+        if (action.type == ControllerAction::TYPE_NONE) {
+            continue;
+        }
+        if (!m_rules.empty()) {
+            m_rules.apply(action, m_ruleState);
+        }
+        m_ruleState.applyAction(action);
+    }
+    
+    // Remover posições de mapeamentos de eixo inválidos
+    actions.erase(std::remove_if(actions.begin(), actions.end(),
+        [](const ControllerAction& a) { return a.type == ControllerAction::TYPE_NONE; }), actions.end());
+    
+    return actions.size();
+}
+
+short EventMapper::filterStickValue(int axis, short value, int64_t deltaMicros) {
+    if (!m_stickFilterEnabled || axis < 0 || axis >= 4) {
+        return value;
+    }
+    
+    return m_stickFilters[axis].filter(value, deltaMicros);
 }
 
 bool EventMapper::shouldPassThrough(const InputEvent& event) {
+    MappedActions actions;
+    mapEvent(event, actions);
+    return shouldPassThrough(event, actions);
+}
+
+bool EventMapper::shouldPassThrough(const InputEvent& event, const MappedActions& actions) const {
     // Por padrão, não passa eventos mapeados para o sistema
     // Implementação mais complexa pode permitir configurar quais eventos são passados
     
@@ -275,11 +414,8 @@ bool EventMapper::shouldPassThrough(const InputEvent& event) {
         return true;
     }
     
-    // Verificar se o evento está mapeado
-    ControllerAction action = mapEvent(event);
-    
     // Se o evento gerar uma ação, não passa para o sistema
-    if (action.type != ControllerAction::TYPE_NONE) {
+    if (actions.count > 0) {
         return false;
     }
     
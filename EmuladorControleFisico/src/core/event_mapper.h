@@ -8,11 +8,14 @@
 
 #include "interception_manager.h"
 #include "virtual_controller.h"
+#include "mouse_kernel.h"
+#include "one_euro_filter.h"
+#include "mapping_rules.h"
 #include "../utils/config_manager.h"
+#include "../utils/clock.h"
 #include <unordered_map>
 #include <string>
 #include <vector>
-#include <chrono>
 
 /**
  * @struct KeyMapping
@@ -76,8 +79,15 @@ public:
     /**
      * @brief Construtor
      * @param configManager Referência para o gerenciador de configurações
+     * @param clock Relógio usado no cálculo de velocidade (nullptr = relógio real)
      */
-    EventMapper(ConfigManager* configManager);
+    EventMapper(ConfigManager* configManager, Clock* clock = nullptr);
+    
+    /**
+     * @brief Obtém o relógio do mapeamento (o mesmo dos instantes dos eventos)
+     * @return Relógio usado
+     */
+    Clock* getClock() const;
     
     /**
      * @brief Define o mapeamento de teclas para botões do controle
@@ -104,11 +114,31 @@ public:
     void setMouseMappings(const std::vector<MouseAxisMapping>& mappings);
     
     /**
-     * @brief Mapeia um evento de entrada para uma ação do controle
+     * @brief Mapeia um evento de entrada para ações do controle
+     * 
+     * Um movimento do mouse gera uma ação de eixo por mapeamento de mouse,
+     * como mapMouseMotionBatch; os demais eventos geram no máximo uma ação.
+     * 
      * @param event Evento de entrada a ser mapeado
-     * @return Ação do controle correspondente
+     * @param actions Recebe as ações geradas (é limpo antes)
+     * @return Número de ações geradas
      */
-    ControllerAction mapEvent(const InputEvent& event);
+    size_t mapEvent(const InputEvent& event, MappedActions& actions);
+    
+    /**
+     * @brief Mapeia um lote de movimentos relativos do mouse para ações de eixo
+     * 
+     * Usa o kernel vetorial de mouse_kernel.h. Gera uma ação de eixo por
+     * mapeamento de mouse para cada movimento, na ordem dos movimentos.
+     * 
+     * @param strokes Movimentos do mouse
+     * @param deltaTimes Intervalo de cada movimento em relação ao anterior, em segundos
+     * @param count Número de movimentos
+     * @param actions Vetor que recebe as ações geradas (é limpo antes)
+     * @return Número de ações geradas
+     */
+    size_t mapMouseMotionBatch(const InterceptionMouseStroke* strokes, const float* deltaTimes,
+                               size_t count, std::vector<ControllerAction>& actions);
     
     /**
      * @brief Determina se um evento deve ser passado para o sistema operacional
@@ -117,6 +147,18 @@ public:
      */
     bool shouldPassThrough(const InputEvent& event);
     
+    /**
+     * @brief Determina se um evento já mapeado deve ser passado para o sistema operacional
+     * 
+     * Evita mapear o evento uma segunda vez, o que alteraria o estado interno
+     * (teclas, tempo do mouse e filtros) com uma amostra duplicada.
+     * 
+     * @param event Evento a ser verificado
+     * @param actions Ações obtidas de mapEvent para este evento
+     * @return true se o evento deve ser passado, false caso contrário
+     */
+    bool shouldPassThrough(const InputEvent& event, const MappedActions& actions) const;
+    
     /**
      * @brief Carrega os mapeamentos a partir do gerenciador de configurações
      */
@@ -139,8 +181,13 @@ private:
     // Estado das teclas para eixos analógicos
     std::unordered_map<WORD, bool> m_keyStates;
     
-    // Último tempo em que processamos eventos
-    std::chrono::steady_clock::time_point m_lastMouseMoveTime;
+    // Regras condicionais compiladas e o estado que elas consultam
+    MappingRules m_rules;
+    RuleState m_ruleState;
+    
+    // Relógio e último instante de movimento do mouse, em microssegundos
+    Clock* m_clock;
+    int64_t m_lastMouseMoveMicros;
     
     // Sensibilidade do mouse
     float m_mouseSensitivity;
@@ -148,6 +195,43 @@ private:
     // Dead zone para analógicos
     int m_deadZone;
     
+    // Buffers reutilizados pelo mapeamento em lote (evitam alocação a cada lote)
+    std::vector<int> m_batchDeltas;
+    std::vector<short> m_batchValues;
+    
+    // Filtro de suavização por eixo do controle (0=LX, 1=LY, 2=RX, 3=RY).
+    // Roda a cada amostra do mouse, não no tick de saída: no tick ele veria só
+    // o último valor de cada intervalo. Com mouse de 1 kHz e ticks de 250 Hz
+    // (autoteste stick_filter), por amostra o jitter cai 95% com 4 ms de
+    // atraso; no tick cai 69% com 8 ms
+    OneEuroFilter m_stickFilters[4];
+    bool m_stickFilterEnabled;
+    
+    /**
+     * @brief Aplica o filtro de suavização ao valor de um eixo movido pelo mouse
+     * @param axis Índice do eixo do controle
+     * @param value Valor bruto do eixo
+     * @param deltaMicros Intervalo desde a amostra anterior, em microssegundos
+     * @return Valor filtrado (ou o próprio valor se o filtro estiver desativado)
+     */
+    short filterStickValue(int axis, short value, int64_t deltaMicros);
+    
+    /**
+     * @brief Compila as regras condicionais ("mapping_rule_N") da configuração
+     */
+    void loadRulesFromConfig();
+    
+    /**
+     * @brief Atualiza o estado de entrada consultado pelas regras
+     * @param event Evento recebido
+     */
+    void updateRuleInputState(const InputEvent& event);
+    
+    /**
+     * @brief Configura os mapeamentos padrão
+     */
+    void setupDefaultMappings();
+    
     /**
      * @brief Mapeia evento de teclado
      * @param keyStroke Evento de teclado
@@ -158,9 +242,9 @@ private:
     /**
      * @brief Mapeia evento de mouse
      * @param mouseStroke Evento de mouse
-     * @return Ação do controle
+     * @param actions Recebe as ações do controle (botão, um eixo por mapeamento ou gatilho)
      */
-    ControllerAction mapMouseEvent(const InterceptionMouseStroke& mouseStroke);
+    void mapMouseEvent(const InterceptionMouseStroke& mouseStroke, MappedActions& actions);
     
     /**
      * @brief Atualiza o estado de um eixo analógico com base no estado das teclas
@@ -0,0 +1,206 @@
+/**
+ * @file feedback_channel.cpp
+ * @brief Implementação do canal de retorno de vibração e LED
+ */
+
+#include "feedback_channel.h"
+#include "../utils/logger.h"
+#include "../utils/pipeline_counters.h"
+
+namespace {
+
+// Bit 63 marca que alguma notificação já foi recebida
+const uint64_t LATEST_VALID = 1ULL << 63;
+
+uint64_t packEvent(const FeedbackEvent& event) {
+    return LATEST_VALID |
+           static_cast<uint64_t>(event.largeMotor) |
+           (static_cast<uint64_t>(event.smallMotor) << 8) |
+           (static_cast<uint64_t>(event.ledNumber) << 16) |
+           (static_cast<uint64_t>(event.red) << 24) |
+           (static_cast<uint64_t>(event.green) << 32) |
+           (static_cast<uint64_t>(event.blue) << 40);
+}
+
+} // namespace
+
+void FeedbackLogListener::onFeedback(const FeedbackEvent& event) {
+    Logger::debug("Retorno do jogo: motor grave " + std::to_string(event.largeMotor) +
+                  ", motor agudo " + std::to_string(event.smallMotor) +
+                  ", LED " + std::to_string(event.ledNumber) +
+                  ", cor " + std::to_string(event.red) + "/" + std::to_string(event.green) + "/" +
+                  std::to_string(event.blue));
+}
+
+FeedbackChannel::FeedbackChannel(Clock* clock)
+    : m_clock(clock ? clock : Clock::getDefault()), m_wakeEvent(nullptr), m_running(false),
+      m_target(nullptr), m_targetType(OUTPUT_TARGET_X360), m_latest(0), m_receivedCount(0),
+      m_droppedCount(0) {
+}
+
+FeedbackChannel::~FeedbackChannel() {
+    detach();
+    stop();
+
+    if (m_wakeEvent) {
+        CloseHandle(m_wakeEvent);
+    }
+}
+
+void FeedbackChannel::addListener(FeedbackListener* listener) {
+    if (listener) {
+        m_listeners.push_back(listener);
+    }
+}
+
+bool FeedbackChannel::start() {
+    if (m_running) {
+        return true;
+    }
+
+    if (!m_wakeEvent) {
+        m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!m_wakeEvent) {
+            Logger::error("Falha ao criar evento do canal de retorno: " + std::to_string(GetLastError()));
+            return false;
+        }
+    }
+
+    m_running = true;
+    m_dispatchThread = std::thread(&FeedbackChannel::dispatchLoop, this);
+    return true;
+}
+
+void FeedbackChannel::stop() {
+    if (m_dispatchThread.joinable()) {
+        m_running = false;
+        SetEvent(m_wakeEvent);
+        m_dispatchThread.join();
+
+        if (m_droppedCount > 0) {
+            Logger::warning("Notificações de retorno descartadas por fila cheia: " +
+                            std::to_string(getDroppedCount()));
+        }
+    }
+}
+
+bool FeedbackChannel::attach(PVIGEM_CLIENT client, PVIGEM_TARGET target, OutputTargetType targetType) {
+    detach();
+
+    const VIGEM_ERROR result = (targetType == OUTPUT_TARGET_DS4)
+        ? vigem_target_ds4_register_notification(client, target, &FeedbackChannel::onDs4Notification, this)
+        : vigem_target_x360_register_notification(client, target, &FeedbackChannel::onX360Notification, this);
+
+    if (!VIGEM_SUCCESS(result)) {
+        Logger::error("Falha ao registrar notificações do controle virtual: " + std::to_string(result));
+        return false;
+    }
+
+    m_target = target;
+    m_targetType = targetType;
+    Logger::info("Canal de retorno (vibração/LED) registrado");
+    return true;
+}
+
+void FeedbackChannel::detach() {
+    if (!m_target) {
+        return;
+    }
+
+    // Após o cancelamento o driver não chama mais o callback
+    if (m_targetType == OUTPUT_TARGET_DS4) {
+        vigem_target_ds4_unregister_notification(m_target);
+    } else {
+        vigem_target_x360_unregister_notification(m_target);
+    }
+    m_target = nullptr;
+}
+
+bool FeedbackChannel::push(const FeedbackEvent& event) {
+    m_receivedCount.fetch_add(1, std::memory_order_relaxed);
+    m_latest.store(packEvent(event), std::memory_order_release);
+
+    if (!m_queue.tryPush(event)) {
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        PipelineCounters::increment(COUNTER_FEEDBACK_DROPPED);
+        return false;
+    }
+
+    if (m_wakeEvent) {
+        SetEvent(m_wakeEvent);
+    }
+    return true;
+}
+
+bool FeedbackChannel::getLatest(FeedbackEvent& event) const {
+    const uint64_t packed = m_latest.load(std::memory_order_acquire);
+    if (!(packed & LATEST_VALID)) {
+        return false;
+    }
+
+    event.timestamp = 0;
+    event.largeMotor = static_cast<BYTE>(packed);
+    event.smallMotor = static_cast<BYTE>(packed >> 8);
+    event.ledNumber = static_cast<BYTE>(packed >> 16);
+    event.red = static_cast<BYTE>(packed >> 24);
+    event.green = static_cast<BYTE>(packed >> 32);
+    event.blue = static_cast<BYTE>(packed >> 40);
+    return true;
+}
+
+uint64_t FeedbackChannel::getReceivedCount() const {
+    return m_receivedCount.load(std::memory_order_relaxed);
+}
+
+uint64_t FeedbackChannel::getDroppedCount() const {
+    return m_droppedCount.load(std::memory_order_relaxed);
+}
+
+void FeedbackChannel::dispatchLoop() {
+    while (m_running) {
+        WaitForSingleObject(m_wakeEvent, INFINITE);
+        drain();
+    }
+
+    // Entregar o que chegou durante o encerramento
+    drain();
+}
+
+void FeedbackChannel::drain() {
+    FeedbackEvent event;
+    while (m_queue.tryPop(event)) {
+        for (size_t i = 0; i < m_listeners.size(); ++i) {
+            m_listeners[i]->onFeedback(event);
+        }
+    }
+}
+
+void CALLBACK FeedbackChannel::onX360Notification(PVIGEM_CLIENT client, PVIGEM_TARGET target, UCHAR largeMotor,
+                                                  UCHAR smallMotor, UCHAR ledNumber, LPVOID userData) {
+    FeedbackChannel* channel = static_cast<FeedbackChannel*>(userData);
+
+    FeedbackEvent event;
+    event.timestamp = channel->m_clock->nowMicros();
+    event.largeMotor = largeMotor;
+    event.smallMotor = smallMotor;
+    event.ledNumber = ledNumber;
+    event.red = 0;
+    event.green = 0;
+    event.blue = 0;
+    channel->push(event);
+}
+
+void CALLBACK FeedbackChannel::onDs4Notification(PVIGEM_CLIENT client, PVIGEM_TARGET target, UCHAR largeMotor,
+                                                 UCHAR smallMotor, DS4_LIGHTBAR_COLOR lightbarColor, LPVOID userData) {
+    FeedbackChannel* channel = static_cast<FeedbackChannel*>(userData);
+
+    FeedbackEvent event;
+    event.timestamp = channel->m_clock->nowMicros();
+    event.largeMotor = largeMotor;
+    event.smallMotor = smallMotor;
+    event.ledNumber = 0;
+    event.red = lightbarColor.Red;
+    event.green = lightbarColor.Green;
+    event.blue = lightbarColor.Blue;
+    channel->push(event);
+}
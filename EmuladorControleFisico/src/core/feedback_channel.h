@@ -0,0 +1,169 @@
+/**
+ * @file feedback_channel.h
+ * @brief Canal de retorno de vibração e LED do controle virtual
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include "../lib/ViGEm/Client.h"
+#include "../utils/clock.h"
+#include "../utils/spsc_queue.h"
+#include "output_target.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct FeedbackEvent
+ * @brief Notificação do jogo para o controle virtual
+ */
+struct FeedbackEvent {
+    int64_t timestamp;    // Instante do recebimento, em microssegundos
+    BYTE largeMotor;      // Motor grave (0-255)
+    BYTE smallMotor;      // Motor agudo (0-255)
+    BYTE ledNumber;       // Xbox 360: número do LED do jogador
+    BYTE red;             // DualShock 4: cor da barra de luz
+    BYTE green;
+    BYTE blue;
+};
+
+/**
+ * @class FeedbackListener
+ * @brief Consumidor das notificações de vibração e LED
+ *
+ * Chamado na thread de despacho do canal, nunca na thread do driver.
+ */
+class FeedbackListener {
+public:
+    virtual ~FeedbackListener() {}
+
+    /**
+     * @brief Recebe uma notificação
+     * @param event Notificação recebida
+     */
+    virtual void onFeedback(const FeedbackEvent& event) = 0;
+};
+
+/**
+ * @class FeedbackLogListener
+ * @brief Registra em log as mudanças de vibração e LED
+ */
+class FeedbackLogListener : public FeedbackListener {
+public:
+    void onFeedback(const FeedbackEvent& event) override;
+};
+
+/**
+ * @class FeedbackChannel
+ * @brief Recebe notificações do driver e as entrega aos consumidores
+ *
+ * O callback do driver apenas insere a notificação numa fila sem bloqueio e
+ * sinaliza a thread de despacho; se a fila estiver cheia a notificação é
+ * descartada e contada. O estado mais recente também fica disponível para
+ * consulta direta (ex.: indicador na interface).
+ */
+class FeedbackChannel {
+public:
+    static const size_t QUEUE_CAPACITY = 256;
+
+    /**
+     * @brief Construtor
+     * @param clock Relógio usado para marcar as notificações (nullptr = relógio real)
+     */
+    explicit FeedbackChannel(Clock* clock = nullptr);
+
+    /**
+     * @brief Destrutor
+     */
+    ~FeedbackChannel();
+
+    /**
+     * @brief Adiciona um consumidor (antes de start; não assume a posse)
+     * @param listener Consumidor
+     */
+    void addListener(FeedbackListener* listener);
+
+    /**
+     * @brief Inicia a thread de despacho
+     * @return true se iniciada com sucesso, false caso contrário
+     */
+    bool start();
+
+    /**
+     * @brief Encerra a thread de despacho, entregando o que restar na fila
+     */
+    void stop();
+
+    /**
+     * @brief Registra o canal como receptor das notificações de um controle
+     * @param client Cliente ViGEm
+     * @param target Controle conectado
+     * @param targetType Tipo do controle
+     * @return true se registrado com sucesso, false caso contrário
+     */
+    bool attach(PVIGEM_CLIENT client, PVIGEM_TARGET target, OutputTargetType targetType);
+
+    /**
+     * @brief Cancela o registro junto ao controle, se houver
+     */
+    void detach();
+
+    /**
+     * @brief Insere uma notificação (apenas na thread do driver; nunca bloqueia)
+     * @param event Notificação
+     * @return true se enfileirada, false se descartada por fila cheia
+     */
+    bool push(const FeedbackEvent& event);
+
+    /**
+     * @brief Obtém o estado mais recente recebido
+     * @param event Recebe o estado
+     * @return true se alguma notificação já foi recebida
+     */
+    bool getLatest(FeedbackEvent& event) const;
+
+    /**
+     * @brief Obtém o número de notificações recebidas
+     * @return Total recebido
+     */
+    uint64_t getReceivedCount() const;
+
+    /**
+     * @brief Obtém o número de notificações descartadas por fila cheia
+     * @return Total descartado
+     */
+    uint64_t getDroppedCount() const;
+
+private:
+    Clock* m_clock;
+    SpscQueue<FeedbackEvent, QUEUE_CAPACITY> m_queue;
+    std::vector<FeedbackListener*> m_listeners;
+    HANDLE m_wakeEvent;
+    std::atomic<bool> m_running;
+    std::thread m_dispatchThread;
+
+    PVIGEM_TARGET m_target;
+    OutputTargetType m_targetType;
+
+    // Estado mais recente empacotado em 64 bits para leitura sem bloqueio
+    std::atomic<uint64_t> m_latest;
+    std::atomic<uint64_t> m_receivedCount;
+    std::atomic<uint64_t> m_droppedCount;
+
+    /**
+     * @brief Laço da thread de despacho
+     */
+    void dispatchLoop();
+
+    /**
+     * @brief Entrega aos consumidores todas as notificações pendentes
+     */
+    void drain();
+
+    static void CALLBACK onX360Notification(PVIGEM_CLIENT client, PVIGEM_TARGET target, UCHAR largeMotor,
+                                            UCHAR smallMotor, UCHAR ledNumber, LPVOID userData);
+    static void CALLBACK onDs4Notification(PVIGEM_CLIENT client, PVIGEM_TARGET target, UCHAR largeMotor,
+                                           UCHAR smallMotor, DS4_LIGHTBAR_COLOR lightbarColor, LPVOID userData);
+};
@@ -0,0 +1,302 @@
+/**
+ * @file input_fusion.cpp
+ * @brief Implementação da fusão de fontes de estado de controle
+ */
+
+#include "input_fusion.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+ReplayGamepadSource::ReplayGamepadSource(bool loop, Clock* clock)
+    : m_name("replay"), m_loop(loop), m_position(0),
+      m_clock(clock ? clock : Clock::getDefault()) {
+    m_startMicros = m_clock->nowMicros();
+}
+
+bool ReplayGamepadSource::load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        Logger::error("Não foi possível abrir gravação de controle: " + filename);
+        return false;
+    }
+
+    m_frames.clear();
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream ss(line);
+        long long timeMicros;
+        unsigned int buttons, leftTrigger, rightTrigger;
+        int lx, ly, rx, ry;
+
+        if (!(ss >> timeMicros >> std::hex >> buttons >> std::dec >> leftTrigger >> rightTrigger >> lx >> ly >> rx >> ry)) {
+            Logger::warning("Linha inválida na gravação " + filename + ": " + std::to_string(lineNumber));
+            continue;
+        }
+
+        XUSB_REPORT report;
+        ZeroMemory(&report, sizeof(XUSB_REPORT));
+        report.wButtons = static_cast<WORD>(buttons);
+        report.bLeftTrigger = static_cast<BYTE>(std::min(leftTrigger, 255u));
+        report.bRightTrigger = static_cast<BYTE>(std::min(rightTrigger, 255u));
+        report.sThumbLX = static_cast<SHORT>(std::max(-32768, std::min(32767, lx)));
+        report.sThumbLY = static_cast<SHORT>(std::max(-32768, std::min(32767, ly)));
+        report.sThumbRX = static_cast<SHORT>(std::max(-32768, std::min(32767, rx)));
+        report.sThumbRY = static_cast<SHORT>(std::max(-32768, std::min(32767, ry)));
+
+        addFrame(timeMicros, report);
+    }
+
+    // Garantir ordem cronológica para a busca sequencial em poll()
+    std::stable_sort(m_frames.begin(), m_frames.end(),
+        [](const Frame& a, const Frame& b) { return a.timeMicros < b.timeMicros; });
+
+    m_name = "replay:" + filename;
+    restart();
+
+    Logger::info("Gravação de controle carregada: " + filename + " (" + std::to_string(m_frames.size()) + " amostras)");
+    return !m_frames.empty();
+}
+
+void ReplayGamepadSource::addFrame(int64_t timeMicros, const XUSB_REPORT& report) {
+    Frame frame;
+    frame.timeMicros = timeMicros;
+    frame.report = report;
+    m_frames.push_back(frame);
+}
+
+void ReplayGamepadSource::restart() {
+    m_position = 0;
+    m_startMicros = m_clock->nowMicros();
+}
+
+bool ReplayGamepadSource::poll(XUSB_REPORT& report) {
+    if (m_frames.empty()) {
+        return false;
+    }
+
+    int64_t elapsed = m_clock->nowMicros() - m_startMicros;
+
+    const int64_t duration = m_frames.back().timeMicros;
+    if (elapsed > duration && m_loop && duration > 0) {
+        // Recomeçar a gravação mantendo a fase
+        const int64_t loops = elapsed / (duration + 1);
+        m_startMicros += loops * (duration + 1);
+        elapsed -= loops * (duration + 1);
+        m_position = 0;
+    }
+
+    // Avançar até a última amostra cujo instante já passou
+    while (m_position + 1 < m_frames.size() && m_frames[m_position + 1].timeMicros <= elapsed) {
+        m_position++;
+    }
+
+    report = m_frames[m_position].report;
+    return true;
+}
+
+std::string ReplayGamepadSource::getName() const {
+    return m_name;
+}
+
+InputFusion::InputFusion(int primaryPriority)
+    : m_primaryPriority(primaryPriority) {
+    // Padrão: botões e gatilhos combinados pelo maior valor, analógicos por prioridade
+    m_rules[FUSION_FIELD_BUTTONS] = FUSION_MAX;
+    m_rules[FUSION_FIELD_LEFT_TRIGGER] = FUSION_MAX;
+    m_rules[FUSION_FIELD_RIGHT_TRIGGER] = FUSION_MAX;
+    m_rules[FUSION_FIELD_LEFT_STICK] = FUSION_PRIORITY;
+    m_rules[FUSION_FIELD_RIGHT_STICK] = FUSION_PRIORITY;
+}
+
+void InputFusion::addSource(GamepadSource* source, int priority) {
+    if (!source) {
+        return;
+    }
+
+    if (m_sources.size() >= MAX_SOURCES) {
+        Logger::warning("Limite de fontes de fusão atingido, ignorando: " + source->getName());
+        return;
+    }
+
+    SourceEntry entry;
+    entry.source = source;
+    entry.priority = priority;
+    m_sources.push_back(entry);
+
+    Logger::info("Fonte de fusão adicionada: " + source->getName() + " (prioridade " + std::to_string(priority) + ")");
+}
+
+void InputFusion::setRule(FusionField field, FusionRule rule) {
+    if (field >= 0 && field < FUSION_FIELD_COUNT) {
+        m_rules[field] = rule;
+    }
+}
+
+FusionRule InputFusion::getRule(FusionField field) const {
+    return m_rules[field];
+}
+
+bool InputFusion::hasSources() const {
+    return !m_sources.empty();
+}
+
+void InputFusion::loadRulesFromConfig(const ConfigManager* configManager) {
+    if (!configManager) {
+        return;
+    }
+
+    m_primaryPriority = configManager->getIntValue("fusion_primary_priority", m_primaryPriority);
+
+    const FusionRule triggers = parseRule(configManager->getStringValue("fusion_rule_triggers"), m_rules[FUSION_FIELD_LEFT_TRIGGER]);
+    m_rules[FUSION_FIELD_BUTTONS] = parseRule(configManager->getStringValue("fusion_rule_buttons"), m_rules[FUSION_FIELD_BUTTONS]);
+    m_rules[FUSION_FIELD_LEFT_TRIGGER] = triggers;
+    m_rules[FUSION_FIELD_RIGHT_TRIGGER] = triggers;
+    m_rules[FUSION_FIELD_LEFT_STICK] = parseRule(configManager->getStringValue("fusion_rule_left_stick"), m_rules[FUSION_FIELD_LEFT_STICK]);
+    m_rules[FUSION_FIELD_RIGHT_STICK] = parseRule(configManager->getStringValue("fusion_rule_right_stick"), m_rules[FUSION_FIELD_RIGHT_STICK]);
+}
+
+FusionRule InputFusion::parseRule(const std::string& name, FusionRule defaultRule) {
+    if (name == "priority") return FUSION_PRIORITY;
+    if (name == "max") return FUSION_MAX;
+    if (name == "sum") return FUSION_SUM_CLAMP;
+    return defaultRule;
+}
+
+namespace {
+
+SHORT clampAxis(int value) {
+    return static_cast<SHORT>(std::max(-32768, std::min(32767, value)));
+}
+
+BYTE fuseTrigger(FusionRule rule, const BYTE* values, const int* priorities, size_t count) {
+    int result = 0;
+    int bestPriority = 0;
+    bool found = false;
+
+    for (size_t i = 0; i < count; i++) {
+        switch (rule) {
+            case FUSION_PRIORITY:
+                if (values[i] != 0 && (!found || priorities[i] > bestPriority)) {
+                    result = values[i];
+                    bestPriority = priorities[i];
+                    found = true;
+                }
+                break;
+            case FUSION_MAX:
+                result = std::max<int>(result, values[i]);
+                break;
+            case FUSION_SUM_CLAMP:
+                result = std::min(255, result + values[i]);
+                break;
+        }
+    }
+
+    return static_cast<BYTE>(result);
+}
+
+void fuseStick(FusionRule rule, const SHORT* xs, const SHORT* ys, const int* priorities, size_t count,
+               SHORT& outX, SHORT& outY) {
+    int x = 0, y = 0;
+    long long bestMagnitude = 0;
+    int bestPriority = 0;
+    bool found = false;
+
+    for (size_t i = 0; i < count; i++) {
+        const bool active = xs[i] != 0 || ys[i] != 0;
+
+        switch (rule) {
+            case FUSION_PRIORITY:
+                if (active && (!found || priorities[i] > bestPriority)) {
+                    x = xs[i];
+                    y = ys[i];
+                    bestPriority = priorities[i];
+                    found = true;
+                }
+                break;
+            case FUSION_MAX: {
+                // O analógico é tratado como vetor para não misturar eixos de fontes diferentes
+                const long long magnitude = static_cast<long long>(xs[i]) * xs[i] + static_cast<long long>(ys[i]) * ys[i];
+                if (magnitude > bestMagnitude) {
+                    x = xs[i];
+                    y = ys[i];
+                    bestMagnitude = magnitude;
+                }
+                break;
+            }
+            case FUSION_SUM_CLAMP:
+                x += xs[i];
+                y += ys[i];
+                break;
+        }
+    }
+
+    outX = clampAxis(x);
+    outY = clampAxis(y);
+}
+
+} // namespace
+
+XUSB_REPORT InputFusion::fuse(const XUSB_REPORT& primary) {
+    if (m_sources.empty()) {
+        return primary;
+    }
+
+    // Coletar estados: índice 0 é o relatório do teclado/mouse
+    size_t count = 0;
+    m_states[count] = primary;
+    m_priorities[count] = m_primaryPriority;
+    count++;
+
+    for (const auto& entry : m_sources) {
+        if (entry.source->poll(m_states[count])) {
+            m_priorities[count] = entry.priority;
+            count++;
+        }
+    }
+
+    XUSB_REPORT result;
+    ZeroMemory(&result, sizeof(XUSB_REPORT));
+
+    // Botões
+    bool found = false;
+    int bestPriority = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (m_rules[FUSION_FIELD_BUTTONS] == FUSION_PRIORITY) {
+            if (m_states[i].wButtons != 0 && (!found || m_priorities[i] > bestPriority)) {
+                result.wButtons = m_states[i].wButtons;
+                bestPriority = m_priorities[i];
+                found = true;
+            }
+        } else {
+            result.wButtons |= m_states[i].wButtons;
+        }
+    }
+
+    // Gatilhos e analógicos
+    BYTE leftTriggers[MAX_SOURCES + 1], rightTriggers[MAX_SOURCES + 1];
+    SHORT lxs[MAX_SOURCES + 1], lys[MAX_SOURCES + 1], rxs[MAX_SOURCES + 1], rys[MAX_SOURCES + 1];
+    for (size_t i = 0; i < count; i++) {
+        leftTriggers[i] = m_states[i].bLeftTrigger;
+        rightTriggers[i] = m_states[i].bRightTrigger;
+        lxs[i] = m_states[i].sThumbLX;
+        lys[i] = m_states[i].sThumbLY;
+        rxs[i] = m_states[i].sThumbRX;
+        rys[i] = m_states[i].sThumbRY;
+    }
+
+    result.bLeftTrigger = fuseTrigger(m_rules[FUSION_FIELD_LEFT_TRIGGER], leftTriggers, m_priorities, count);
+    result.bRightTrigger = fuseTrigger(m_rules[FUSION_FIELD_RIGHT_TRIGGER], rightTriggers, m_priorities, count);
+    fuseStick(m_rules[FUSION_FIELD_LEFT_STICK], lxs, lys, m_priorities, count, result.sThumbLX, result.sThumbLY);
+    fuseStick(m_rules[FUSION_FIELD_RIGHT_STICK], rxs, rys, m_priorities, count, result.sThumbRX, result.sThumbRY);
+
+    return result;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file input_fusion.h
+ * @brief Fusão de fontes secundárias de estado de controle no relatório virtual
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include "../lib/ViGEm/Client.h"
+#include "../utils/config_manager.h"
+#include "../utils/clock.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @enum FusionRule
+ * @brief Regra usada para combinar um campo do relatório entre as fontes
+ */
+enum FusionRule {
+    FUSION_PRIORITY,   // A fonte de maior prioridade com o campo ativo vence
+    FUSION_MAX,        // Maior valor (botões são combinados com OU)
+    FUSION_SUM_CLAMP   // Soma limitada ao intervalo do campo
+};
+
+/**
+ * @enum FusionField
+ * @brief Campos do relatório com regra de fusão independente
+ */
+enum FusionField {
+    FUSION_FIELD_BUTTONS,
+    FUSION_FIELD_LEFT_TRIGGER,
+    FUSION_FIELD_RIGHT_TRIGGER,
+    FUSION_FIELD_LEFT_STICK,
+    FUSION_FIELD_RIGHT_STICK,
+    FUSION_FIELD_COUNT
+};
+
+/**
+ * @class GamepadSource
+ * @brief Fonte de estado de controle a ser combinada com o teclado/mouse
+ */
+class GamepadSource {
+public:
+    virtual ~GamepadSource() {}
+
+    /**
+     * @brief Obtém o estado atual da fonte sem bloquear
+     * @param report Recebe o estado atual
+     * @return true se a fonte tem estado disponível, false caso contrário
+     */
+    virtual bool poll(XUSB_REPORT& report) = 0;
+
+    /**
+     * @brief Obtém o nome da fonte para log
+     * @return Nome da fonte
+     */
+    virtual std::string getName() const = 0;
+};
+
+/**
+ * @class ReplayGamepadSource
+ * @brief Fonte que reproduz estados de controle gravados em arquivo
+ *
+ * Formato: uma amostra por linha, "tempo_us botoes lt rt lx ly rx ry", com
+ * botões em hexadecimal e tempo relativo ao início da gravação. Linhas vazias
+ * ou iniciadas por '#' são ignoradas.
+ */
+class ReplayGamepadSource : public GamepadSource {
+public:
+    /**
+     * @brief Construtor
+     * @param loop Se true, reinicia a reprodução ao chegar ao fim
+     * @param clock Relógio que conduz a reprodução (nullptr = relógio real)
+     */
+    explicit ReplayGamepadSource(bool loop = true, Clock* clock = nullptr);
+
+    /**
+     * @brief Carrega uma gravação de arquivo
+     * @param filename Caminho do arquivo
+     * @return true se carregado com sucesso, false caso contrário
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * @brief Adiciona uma amostra diretamente (sem arquivo)
+     * @param timeMicros Instante da amostra relativo ao início, em microssegundos
+     * @param report Estado do controle
+     */
+    void addFrame(int64_t timeMicros, const XUSB_REPORT& report);
+
+    /**
+     * @brief Reinicia a reprodução a partir do início
+     */
+    void restart();
+
+    bool poll(XUSB_REPORT& report) override;
+    std::string getName() const override;
+
+private:
+    struct Frame {
+        int64_t timeMicros;
+        XUSB_REPORT report;
+    };
+
+    std::vector<Frame> m_frames;
+    std::string m_name;
+    bool m_loop;
+    size_t m_position;
+    Clock* m_clock;
+    int64_t m_startMicros;
+};
+
+/**
+ * @class InputFusion
+ * @brief Combina o relatório do teclado/mouse com fontes secundárias
+ *
+ * A fusão é feita campo a campo, uma vez por envio de relatório, sem alocação.
+ */
+class InputFusion {
+public:
+    /**
+     * @brief Construtor
+     * @param primaryPriority Prioridade do relatório gerado pelo teclado/mouse
+     */
+    explicit InputFusion(int primaryPriority = 0);
+
+    /**
+     * @brief Adiciona uma fonte secundária (não assume a posse do ponteiro)
+     * @param source Fonte de estado
+     * @param priority Prioridade usada pela regra FUSION_PRIORITY
+     */
+    void addSource(GamepadSource* source, int priority);
+
+    /**
+     * @brief Define a regra de fusão de um campo
+     * @param field Campo do relatório
+     * @param rule Regra a ser usada
+     */
+    void setRule(FusionField field, FusionRule rule);
+
+    /**
+     * @brief Obtém a regra de fusão de um campo
+     * @param field Campo do relatório
+     * @return Regra configurada
+     */
+    FusionRule getRule(FusionField field) const;
+
+    /**
+     * @brief Carrega prioridade primária e regras do gerenciador de configurações
+     * @param configManager Gerenciador de configurações
+     */
+    void loadRulesFromConfig(const ConfigManager* configManager);
+
+    /**
+     * @brief Indica se há fontes secundárias registradas
+     * @return true se houver ao menos uma fonte
+     */
+    bool hasSources() const;
+
+    /**
+     * @brief Combina o relatório primário com o estado atual das fontes
+     * @param primary Relatório gerado pelo teclado/mouse
+     * @return Relatório combinado
+     */
+    XUSB_REPORT fuse(const XUSB_REPORT& primary);
+
+    /**
+     * @brief Converte o nome de uma regra ("priority", "max", "sum")
+     * @param name Nome da regra
+     * @param defaultRule Regra usada se o nome for desconhecido
+     * @return Regra correspondente
+     */
+    static FusionRule parseRule(const std::string& name, FusionRule defaultRule);
+
+private:
+    struct SourceEntry {
+        GamepadSource* source;
+        int priority;
+    };
+
+    static const size_t MAX_SOURCES = 8;
+
+    std::vector<SourceEntry> m_sources;
+    FusionRule m_rules[FUSION_FIELD_COUNT];
+    int m_primaryPriority;
+
+    // Estados coletados a cada fusão (tamanho fixo, sem alocação)
+    XUSB_REPORT m_states[MAX_SOURCES + 1];
+    int m_priorities[MAX_SOURCES + 1];
+};
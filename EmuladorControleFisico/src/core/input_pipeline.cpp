@@ -0,0 +1,337 @@
+/**
+ * @file input_pipeline.cpp
+ * @brief Implementação do pipeline de entrada em estágios
+ */
+
+#include "input_pipeline.h"
+#include "event_mapper.h"
+#include "../utils/latency_histogram.h"
+#include "../utils/logger.h"
+#include "../utils/pipeline_counters.h"
+#include "../utils/trace_recorder.h"
+#include <cctype>
+#include <sstream>
+
+// FilterStage
+
+std::string FilterStage::getName() const {
+    return "filter";
+}
+
+bool FilterStage::process(PipelineItem& item) {
+    if (item.event.type == InputEvent::TYPE_NONE) {
+        PipelineCounters::increment(COUNTER_FILTERED_STROKES);
+        return false;
+    }
+
+    // Movimento relativo nulo, sem botão nem roda: nada a mapear nem a repassar
+    if (item.event.type == InputEvent::TYPE_MOUSE) {
+        const InterceptionMouseStroke& mouse = item.event.data.mouse;
+        if (!(mouse.flags & INTERCEPTION_MOUSE_MOVE_ABSOLUTE) && mouse.x == 0 && mouse.y == 0 &&
+            mouse.state == 0 && mouse.rolling == 0) {
+            PipelineCounters::increment(COUNTER_FILTERED_STROKES);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// MapStage
+
+MapStage::MapStage(EventMapper* mapper)
+    : m_mapper(mapper) {
+}
+
+std::string MapStage::getName() const {
+    return "map";
+}
+
+bool MapStage::process(PipelineItem& item) {
+    m_mapper->mapEvent(item.event, item.actions);
+    item.passThrough = m_mapper->shouldPassThrough(item.event, item.actions);
+    
+    if (item.actions.count > 0) {
+        TRACE_INSTANT("action", item.actions.actions[0].type);
+        // Mesmo relógio que marcou o evento (simulado na reprodução)
+        LatencyRegistry::recordMicros(LATENCY_CAPTURE_TO_MAPPED, item.event.timestamp, m_mapper->getClock()->nowMicros());
+    }
+    return true;
+}
+
+// ApplyStage
+
+ApplyStage::ApplyStage(VirtualController* controller)
+    : m_controller(controller) {
+}
+
+std::string ApplyStage::getName() const {
+    return "apply";
+}
+
+bool ApplyStage::process(PipelineItem& item) {
+    for (size_t i = 0; i < item.actions.count; ++i) {
+        const ControllerAction& action = item.actions.actions[i];
+        switch (action.type) {
+            case ControllerAction::TYPE_BUTTON:
+                PipelineCounters::increment(COUNTER_BUTTON_ACTIONS);
+                break;
+            case ControllerAction::TYPE_AXIS:
+                PipelineCounters::increment(COUNTER_AXIS_ACTIONS);
+                break;
+            case ControllerAction::TYPE_TRIGGER:
+                PipelineCounters::increment(COUNTER_TRIGGER_ACTIONS);
+                break;
+            default:
+                continue;
+        }
+
+        m_controller->applyAction(action);
+    }
+    return true;
+}
+
+// PassThroughStage
+
+PassThroughStage::PassThroughStage(InterceptionManager* interceptManager)
+    : m_interceptManager(interceptManager) {
+}
+
+std::string PassThroughStage::getName() const {
+    return "passthrough";
+}
+
+bool PassThroughStage::process(PipelineItem& item) {
+    if (item.passThrough) {
+        m_interceptManager->passEventThrough(item.event);
+        TRACE_INSTANT("passthrough", item.event.deviceId);
+        LatencyRegistry::recordMicros(LATENCY_PASS_THROUGH, item.event.timestamp,
+                                      m_interceptManager->getClock()->nowMicros());
+        PipelineCounters::increment(COUNTER_PASSED_THROUGH);
+    } else {
+        PipelineCounters::increment(COUNTER_BLOCKED);
+    }
+    return true;
+}
+
+// InputPipeline
+
+const char* InputPipeline::DEFAULT_SPEC = "map,apply,passthrough";
+
+InputPipeline::InputPipeline()
+    : m_workerTuning("pipeline"), m_running(false) {
+}
+
+InputPipeline::~InputPipeline() {
+    stop();
+
+    for (auto& segment : m_segments) {
+        if (segment->wakeEvent) {
+            CloseHandle(segment->wakeEvent);
+        }
+    }
+}
+
+void InputPipeline::registerStage(PipelineStage* stage) {
+    if (stage) {
+        m_registry[stage->getName()].reset(stage);
+    }
+}
+
+bool InputPipeline::configure(const std::string& spec) {
+    if (m_running) {
+        Logger::warning("Pipeline de entrada já iniciado; configuração ignorada");
+        return false;
+    }
+
+    std::vector<std::unique_ptr<Segment>> segments;
+    segments.emplace_back(new Segment());
+
+    std::string name;
+    for (size_t i = 0; i <= spec.size(); ++i) {
+        const char c = i < spec.size() ? spec[i] : ',';
+        if (c != ',' && c != '|') {
+            if (!isspace(static_cast<unsigned char>(c))) {
+                name += c;
+            }
+            continue;
+        }
+
+        if (!name.empty()) {
+            auto it = m_registry.find(name);
+            if (it == m_registry.end()) {
+                Logger::error("Estágio desconhecido no pipeline de entrada: " + name);
+                return false;
+            }
+            segments.back()->stages.emplace_back(new TimedStage(it->second.get()));
+            name.clear();
+        }
+
+        if (c == '|' && !segments.back()->stages.empty()) {
+            segments.emplace_back(new Segment());
+        }
+    }
+
+    if (segments.back()->stages.empty()) {
+        segments.pop_back();
+    }
+    if (segments.empty()) {
+        Logger::error("Pipeline de entrada sem estágios: " + spec);
+        return false;
+    }
+
+    m_segments.swap(segments);
+    m_spec = spec;
+    Logger::info("Pipeline de entrada: " + spec + " (" + std::to_string(m_segments.size()) + " threads)");
+    return true;
+}
+
+void InputPipeline::setWorkerTuning(const ThreadTuning& tuning) {
+    m_workerTuning = tuning;
+}
+
+bool InputPipeline::start() {
+    if (m_running) {
+        return true;
+    }
+
+    m_running = true;
+
+    for (size_t i = 1; i < m_segments.size(); ++i) {
+        Segment& segment = *m_segments[i];
+        segment.wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!segment.wakeEvent) {
+            Logger::error("Falha ao criar evento do pipeline de entrada: " + std::to_string(GetLastError()));
+            stop();
+            return false;
+        }
+        segment.thread = std::thread(&InputPipeline::segmentLoop, this, i);
+    }
+
+    return true;
+}
+
+void InputPipeline::stop() {
+    m_running = false;
+
+    for (size_t i = 1; i < m_segments.size(); ++i) {
+        Segment& segment = *m_segments[i];
+        if (segment.thread.joinable()) {
+            SetEvent(segment.wakeEvent);
+            segment.thread.join();
+        }
+    }
+}
+
+void InputPipeline::push(const InputEvent& event) {
+    if (m_segments.empty()) {
+        return;
+    }
+
+    PipelineItem item;
+    item.event = event;
+    runSegment(0, item);
+}
+
+void InputPipeline::runSegment(size_t index, PipelineItem& item) {
+    TRACE_SCOPE("pipeline");
+    Segment& segment = *m_segments[index];
+
+    // Estágios do mesmo segmento: chamadas diretas, sem fila
+    for (auto& timed : segment.stages) {
+        const uint64_t start = LatencyRegistry::nowNanos();
+        const bool keep = timed->stage->process(item);
+        const uint64_t elapsed = LatencyRegistry::nowNanos() - start;
+
+        timed->calls.fetch_add(1, std::memory_order_relaxed);
+        timed->totalNanos.fetch_add(elapsed, std::memory_order_relaxed);
+        if (elapsed > timed->maxNanos.load(std::memory_order_relaxed)) {
+            timed->maxNanos.store(elapsed, std::memory_order_relaxed);
+        }
+
+        if (!keep) {
+            timed->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    if (index + 1 >= m_segments.size()) {
+        return;
+    }
+
+    // Entregar ao próximo segmento; com a fila cheia, esperar em vez de perder o evento
+    Segment& next = *m_segments[index + 1];
+    if (!next.input.tryPush(item)) {
+        next.backpressureWaits.fetch_add(1, std::memory_order_relaxed);
+        PipelineCounters::increment(COUNTER_QUEUE_OVERFLOWS);
+        while (!next.input.tryPush(item)) {
+            if (!m_running) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+    SetEvent(next.wakeEvent);
+}
+
+void InputPipeline::segmentLoop(size_t index) {
+    // Cópia por thread: o registro MMCSS pertence à thread que o fez
+    ThreadTuning tuning = m_workerTuning;
+    tuning.apply();
+
+    Segment& segment = *m_segments[index];
+    PipelineItem item;
+
+    while (m_running) {
+        while (segment.input.tryPop(item)) {
+            runSegment(index, item);
+        }
+        WaitForSingleObject(segment.wakeEvent, INFINITE);
+    }
+
+    tuning.revert();
+}
+
+std::vector<PipelineStageStats> InputPipeline::getStageStats() const {
+    std::vector<PipelineStageStats> result;
+
+    for (size_t i = 0; i < m_segments.size(); ++i) {
+        for (const auto& timed : m_segments[i]->stages) {
+            PipelineStageStats stats;
+            stats.name = timed->stage->getName();
+            stats.segment = static_cast<int>(i);
+            stats.calls = timed->calls.load(std::memory_order_relaxed);
+            stats.dropped = timed->dropped.load(std::memory_order_relaxed);
+            stats.meanNanos = stats.calls ? static_cast<double>(timed->totalNanos.load(std::memory_order_relaxed)) / stats.calls : 0.0;
+            stats.maxNanos = timed->maxNanos.load(std::memory_order_relaxed);
+            result.push_back(stats);
+        }
+    }
+
+    return result;
+}
+
+size_t InputPipeline::getQueueDepth() const {
+    size_t depth = 0;
+    for (size_t i = 1; i < m_segments.size(); ++i) {
+        depth += m_segments[i]->input.size();
+    }
+    return depth;
+}
+
+void InputPipeline::logStageStats() const {
+    for (const PipelineStageStats& stats : getStageStats()) {
+        std::ostringstream line;
+        line << "Estágio " << stats.name << " (thread " << stats.segment << "): " << stats.calls
+             << " itens, " << stats.dropped << " descartados, médio " << static_cast<uint64_t>(stats.meanNanos)
+             << " ns, máximo " << stats.maxNanos << " ns";
+        Logger::info(line.str());
+    }
+
+    for (size_t i = 1; i < m_segments.size(); ++i) {
+        const uint64_t waits = m_segments[i]->backpressureWaits.load(std::memory_order_relaxed);
+        if (waits > 0) {
+            Logger::warning("Fila do segmento " + std::to_string(i) + " cheia " + std::to_string(waits) + " vezes");
+        }
+    }
+}
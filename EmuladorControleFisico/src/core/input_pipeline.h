@@ -0,0 +1,265 @@
+/**
+ * @file input_pipeline.h
+ * @brief Pipeline de entrada composto por estágios declarados na configuração
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include "interception_manager.h"
+#include "virtual_controller.h"
+#include "../utils/spsc_queue.h"
+#include "../utils/thread_tuning.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class EventMapper;
+
+/**
+ * @struct PipelineItem
+ * @brief Evento em trânsito pelo pipeline, com o resultado dos estágios anteriores
+ */
+struct PipelineItem {
+    InputEvent event;          // Evento capturado
+    MappedActions actions;     // Ações produzidas pelo mapeamento
+    bool passThrough;          // Se o evento original deve seguir para o sistema
+
+    PipelineItem() : passThrough(true) {}
+};
+
+/**
+ * @class PipelineStage
+ * @brief Estágio do pipeline de entrada
+ *
+ * Cada estágio é chamado por uma única thread: a de captura ou a do
+ * segmento em que foi colocado.
+ */
+class PipelineStage {
+public:
+    virtual ~PipelineStage() {}
+
+    /**
+     * @brief Obtém o nome usado na configuração e no log
+     * @return Nome do estágio
+     */
+    virtual std::string getName() const = 0;
+
+    /**
+     * @brief Processa um item
+     * @param item Item a processar (pode ser alterado)
+     * @return true para seguir aos próximos estágios, false para descartar o item
+     */
+    virtual bool process(PipelineItem& item) = 0;
+};
+
+/**
+ * @class FilterStage
+ * @brief Descarta eventos vazios e movimentos de mouse sem deslocamento nem botão
+ */
+class FilterStage : public PipelineStage {
+public:
+    std::string getName() const override;
+    bool process(PipelineItem& item) override;
+};
+
+/**
+ * @class MapStage
+ * @brief Mapeia o evento para ações e decide se o original segue para o sistema
+ */
+class MapStage : public PipelineStage {
+public:
+    /**
+     * @brief Construtor
+     * @param mapper Mapeador de eventos (não assume a posse)
+     */
+    explicit MapStage(EventMapper* mapper);
+
+    std::string getName() const override;
+    bool process(PipelineItem& item) override;
+
+private:
+    EventMapper* m_mapper;
+};
+
+/**
+ * @class ApplyStage
+ * @brief Aplica as ações mapeadas ao controle virtual, na ordem
+ */
+class ApplyStage : public PipelineStage {
+public:
+    /**
+     * @brief Construtor
+     * @param controller Controle virtual (não assume a posse)
+     */
+    explicit ApplyStage(VirtualController* controller);
+
+    std::string getName() const override;
+    bool process(PipelineItem& item) override;
+
+private:
+    VirtualController* m_controller;
+};
+
+/**
+ * @class PassThroughStage
+ * @brief Devolve ao sistema os eventos que não foram consumidos pelo mapeamento
+ */
+class PassThroughStage : public PipelineStage {
+public:
+    /**
+     * @brief Construtor
+     * @param interceptManager Gerenciador de interceptação (não assume a posse)
+     */
+    explicit PassThroughStage(InterceptionManager* interceptManager);
+
+    std::string getName() const override;
+    bool process(PipelineItem& item) override;
+
+private:
+    InterceptionManager* m_interceptManager;
+};
+
+/**
+ * @struct PipelineStageStats
+ * @brief Tempo e contagem de um estágio
+ */
+struct PipelineStageStats {
+    std::string name;
+    int segment;           // Segmento (thread) em que o estágio roda
+    uint64_t calls;        // Itens processados
+    uint64_t dropped;      // Itens descartados pelo estágio
+    double meanNanos;      // Tempo médio por item
+    uint64_t maxNanos;     // Maior tempo por item
+};
+
+/**
+ * @class InputPipeline
+ * @brief Encadeia estágios nomeados em segmentos, cada um em sua thread
+ *
+ * A especificação lista os estágios na ordem, por exemplo
+ * "filter,map|apply,passthrough". Estágios separados por vírgula formam um
+ * segmento e são chamados diretamente, sem fila. Uma barra vertical inicia
+ * um novo segmento, alimentado por uma fila SPSC limitada e executado por uma
+ * thread própria. O primeiro segmento roda na thread que chama push.
+ */
+class InputPipeline {
+public:
+    /** Especificação equivalente ao laço original de processamento */
+    static const char* DEFAULT_SPEC;
+
+    InputPipeline();
+
+    /**
+     * @brief Destrutor (encerra as threads dos segmentos)
+     */
+    ~InputPipeline();
+
+    /**
+     * @brief Registra um estágio disponível para a especificação
+     * @param stage Estágio (o pipeline assume a posse)
+     */
+    void registerStage(PipelineStage* stage);
+
+    /**
+     * @brief Monta os segmentos a partir de uma especificação
+     * @param spec Nomes dos estágios separados por ',' (mesma thread) ou '|' (nova thread)
+     * @return true se todos os estágios existem, false caso contrário
+     */
+    bool configure(const std::string& spec);
+
+    /**
+     * @brief Define prioridade e afinidade das threads dos segmentos
+     * @param tuning Configuração aplicada a cada thread de segmento
+     */
+    void setWorkerTuning(const ThreadTuning& tuning);
+
+    /**
+     * @brief Inicia as threads dos segmentos após o primeiro
+     * @return true se iniciado com sucesso, false caso contrário
+     */
+    bool start();
+
+    /**
+     * @brief Encerra as threads dos segmentos
+     */
+    void stop();
+
+    /**
+     * @brief Processa um evento capturado (apenas na thread de captura)
+     * @param event Evento de entrada
+     */
+    void push(const InputEvent& event);
+
+    /**
+     * @brief Obtém as estatísticas de cada estágio, na ordem da especificação
+     * @return Estatísticas por estágio
+     */
+    std::vector<PipelineStageStats> getStageStats() const;
+
+    /**
+     * @brief Registra as estatísticas de cada estágio no log
+     */
+    void logStageStats() const;
+
+    /**
+     * @brief Obtém o total de itens aguardando nas filas entre segmentos
+     * @return Itens nas filas (0 com um único segmento)
+     */
+    size_t getQueueDepth() const;
+
+private:
+    static const size_t QUEUE_CAPACITY = 1024;
+
+    /**
+     * @struct TimedStage
+     * @brief Estágio com seus contadores de tempo
+     */
+    struct TimedStage {
+        PipelineStage* stage;
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> dropped;
+        std::atomic<uint64_t> totalNanos;
+        std::atomic<uint64_t> maxNanos;
+
+        explicit TimedStage(PipelineStage* s)
+            : stage(s), calls(0), dropped(0), totalNanos(0), maxNanos(0) {}
+    };
+
+    /**
+     * @struct Segment
+     * @brief Estágios chamados em sequência por uma mesma thread
+     */
+    struct Segment {
+        std::vector<std::unique_ptr<TimedStage>> stages;
+        SpscQueue<PipelineItem, QUEUE_CAPACITY> input;  // Não usada pelo primeiro segmento
+        HANDLE wakeEvent;
+        std::thread thread;
+        std::atomic<uint64_t> backpressureWaits;
+
+        Segment() : wakeEvent(nullptr), backpressureWaits(0) {}
+    };
+
+    std::map<std::string, std::unique_ptr<PipelineStage>> m_registry;
+    std::vector<std::unique_ptr<Segment>> m_segments;
+    std::string m_spec;
+    ThreadTuning m_workerTuning;
+    std::atomic<bool> m_running;
+
+    /**
+     * @brief Executa os estágios de um segmento e entrega o item ao próximo
+     * @param index Índice do segmento
+     * @param item Item a processar
+     */
+    void runSegment(size_t index, PipelineItem& item);
+
+    /**
+     * @brief Laço da thread de um segmento
+     * @param index Índice do segmento
+     */
+    void segmentLoop(size_t index);
+};
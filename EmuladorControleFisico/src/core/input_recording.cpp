@@ -0,0 +1,572 @@
+/**
+ * @file input_recording.cpp
+ * @brief Implementação da gravação compacta de eventos de entrada
+ */
+
+#include "input_recording.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char FILE_MAGIC[4] = { 'E', 'C', 'F', 'I' };
+const char FOOTER_MAGIC[4] = { 'E', 'C', 'F', 'X' };
+
+// Byte de tipo: bits 0-1 = InputEvent::EventType, bit 2 = mesmo dispositivo do evento anterior
+const uint8_t TAG_TYPE_MASK = 0x03;
+const uint8_t TAG_SAME_DEVICE = 0x04;
+
+void putU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint32_t getU32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+void putU64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t getU64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        const uint8_t byte = *cursor++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+// InputRecorder
+
+InputRecorder::InputRecorder()
+    : m_eventCount(0), m_chunkEvents(0), m_chunkFirstTimestamp(0), m_lastTimestamp(0), m_lastDevice(0),
+      m_offset(0), m_wakeEvent(nullptr), m_writerRunning(false) {
+}
+
+InputRecorder::~InputRecorder() {
+    close();
+
+    if (m_wakeEvent) {
+        CloseHandle(m_wakeEvent);
+    }
+}
+
+bool InputRecorder::open(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_writerThread.joinable()) {
+        Logger::warning("Gravação de entrada já aberta: " + m_filename);
+        return false;
+    }
+
+    if (!m_wakeEvent) {
+        m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!m_wakeEvent) {
+            Logger::error("Falha ao criar evento da gravação de entrada: " + std::to_string(GetLastError()));
+            return false;
+        }
+    }
+
+    m_file.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        Logger::error("Não foi possível criar a gravação de entrada: " + filename);
+        return false;
+    }
+
+    uint8_t header[HEADER_SIZE] = {};
+    memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header[4] = static_cast<uint8_t>(FORMAT_VERSION);
+    header[5] = static_cast<uint8_t>(FORMAT_VERSION >> 8);
+    m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    m_filename = filename;
+    m_chunk.clear();
+    m_chunk.reserve(CHUNK_EVENTS * MAX_EVENT_SIZE);
+    m_index.clear();
+    m_offset = HEADER_SIZE;
+    m_eventCount = 0;
+    m_chunkEvents = 0;
+
+    // Segundo buffer: o bloco cheio é trocado por ele sem alocação na captura
+    m_pending.clear();
+    m_pending.reserve(2);
+    m_spareChunks.clear();
+    m_spareChunks.emplace_back();
+    m_spareChunks.back().reserve(CHUNK_EVENTS * MAX_EVENT_SIZE);
+
+    m_writerRunning = true;
+    m_writerThread = std::thread(&InputRecorder::writerLoop, this);
+
+    Logger::info("Gravando eventos de entrada em " + filename);
+    return true;
+}
+
+bool InputRecorder::append(const InputEvent& event) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // O arquivo é da thread de gravação; a captura só consulta a thread
+    if (!m_writerThread.joinable()) {
+        return false;
+    }
+    if (event.type == InputEvent::TYPE_NONE) {
+        return true;
+    }
+
+    // Cada bloco recomeça do seu primeiro evento para ser decodificável sozinho
+    if (m_chunkEvents == 0) {
+        m_chunkFirstTimestamp = event.timestamp;
+        m_lastTimestamp = event.timestamp;
+        m_lastDevice = 0;
+    }
+
+    const bool sameDevice = event.deviceId == m_lastDevice;
+    m_chunk.push_back(static_cast<uint8_t>(event.type | (sameDevice ? TAG_SAME_DEVICE : 0)));
+    putVarint(m_chunk, zigzag(event.timestamp - m_lastTimestamp));
+    if (!sameDevice) {
+        putVarint(m_chunk, static_cast<uint64_t>(event.deviceId));
+    }
+
+    if (event.type == InputEvent::TYPE_KEYBOARD) {
+        putVarint(m_chunk, event.data.keyboard.code);
+        putVarint(m_chunk, event.data.keyboard.state);
+    } else {
+        putVarint(m_chunk, event.data.mouse.state);
+        putVarint(m_chunk, event.data.mouse.flags);
+        putVarint(m_chunk, zigzag(event.data.mouse.rolling));
+        putVarint(m_chunk, zigzag(event.data.mouse.x));
+        putVarint(m_chunk, zigzag(event.data.mouse.y));
+    }
+
+    m_lastTimestamp = event.timestamp;
+    m_lastDevice = event.deviceId;
+    ++m_eventCount;
+
+    if (++m_chunkEvents == CHUNK_EVENTS) {
+        flushChunk();
+    }
+    return true;
+}
+
+void InputRecorder::flushChunk() {
+    if (m_chunkEvents == 0) {
+        return;
+    }
+
+    PendingChunk chunk;
+    chunk.eventCount = m_chunkEvents;
+    chunk.firstTimestamp = m_chunkFirstTimestamp;
+
+    {
+        std::lock_guard<std::mutex> queueLock(m_queueMutex);
+        chunk.data.swap(m_chunk);
+        if (!m_spareChunks.empty()) {
+            m_chunk.swap(m_spareChunks.back());
+            m_spareChunks.pop_back();
+        }
+        m_pending.push_back(std::move(chunk));
+    }
+
+    // Sem buffer livre (disco mais lento que a captura): alocar outro
+    if (m_chunk.capacity() == 0) {
+        m_chunk.reserve(CHUNK_EVENTS * MAX_EVENT_SIZE);
+    }
+    m_chunkEvents = 0;
+    SetEvent(m_wakeEvent);
+}
+
+void InputRecorder::writerLoop() {
+    for (;;) {
+        WaitForSingleObject(m_wakeEvent, INFINITE);
+
+        // Lido antes de gravar: ao parar, todos os blocos já foram entregues
+        const bool stopping = !m_writerRunning;
+        writePendingChunks();
+        if (stopping) {
+            break;
+        }
+    }
+}
+
+void InputRecorder::writePendingChunks() {
+    std::vector<PendingChunk> chunks;
+    {
+        std::lock_guard<std::mutex> queueLock(m_queueMutex);
+        chunks.swap(m_pending);
+        m_pending.reserve(2);
+    }
+
+    for (PendingChunk& chunk : chunks) {
+        uint8_t header[CHUNK_HEADER_SIZE];
+        putU32(header, chunk.eventCount);
+        putU32(header + 4, static_cast<uint32_t>(chunk.data.size()));
+        putU64(header + 8, static_cast<uint64_t>(chunk.firstTimestamp));
+        m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        m_file.write(reinterpret_cast<const char*>(chunk.data.data()), chunk.data.size());
+
+        RecordingChunkInfo info;
+        info.offset = m_offset;
+        info.firstTimestamp = chunk.firstTimestamp;
+        info.eventCount = chunk.eventCount;
+        m_index.push_back(info);
+        m_offset += CHUNK_HEADER_SIZE + chunk.data.size();
+
+        // Buffer devolvido vazio, com a capacidade preservada, para a próxima troca
+        chunk.data.clear();
+        std::lock_guard<std::mutex> queueLock(m_queueMutex);
+        m_spareChunks.push_back(std::move(chunk.data));
+    }
+}
+
+void InputRecorder::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_writerThread.joinable()) {
+        return;
+    }
+
+    // Entregar o bloco incompleto e esperar a thread gravar tudo
+    flushChunk();
+    m_writerRunning = false;
+    SetEvent(m_wakeEvent);
+    m_writerThread.join();
+
+    // Índice e rodapé no fim: a gravação continua só de acréscimos
+    const uint64_t indexOffset = m_offset;
+    for (const RecordingChunkInfo& info : m_index) {
+        uint8_t entry[INDEX_ENTRY_SIZE];
+        putU64(entry, info.offset);
+        putU64(entry + 8, static_cast<uint64_t>(info.firstTimestamp));
+        putU32(entry + 16, info.eventCount);
+        m_file.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+    }
+
+    uint8_t footer[FOOTER_SIZE];
+    putU64(footer, indexOffset);
+    putU64(footer + 8, m_eventCount);
+    putU32(footer + 16, static_cast<uint32_t>(m_index.size()));
+    memcpy(footer + 20, FOOTER_MAGIC, sizeof(FOOTER_MAGIC));
+    m_file.write(reinterpret_cast<const char*>(footer), sizeof(footer));
+
+    const bool good = m_file.good();
+    m_file.close();
+
+    if (!good) {
+        Logger::error("Falha ao gravar eventos de entrada em " + m_filename);
+        return;
+    }
+    Logger::info("Gravação de entrada finalizada: " + std::to_string(m_eventCount) + " eventos em " +
+                 std::to_string(m_index.size()) + " blocos (" + std::to_string(indexOffset) + " bytes) em " +
+                 m_filename);
+}
+
+bool InputRecorder::isOpen() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_writerThread.joinable();
+}
+
+uint64_t InputRecorder::getEventCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_eventCount;
+}
+
+// InputRecordingReader
+
+InputRecordingReader::InputRecordingReader()
+    : m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr), m_data(nullptr), m_size(0), m_eventCount(0),
+      m_chunk(0), m_cursor(nullptr), m_chunkEnd(nullptr), m_chunkRemaining(0), m_lastTimestamp(0),
+      m_lastDevice(0) {
+}
+
+InputRecordingReader::~InputRecordingReader() {
+    close();
+}
+
+bool InputRecordingReader::open(const std::string& filename) {
+    close();
+
+    m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        Logger::error("Não foi possível abrir a gravação de entrada: " + filename);
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart < static_cast<LONGLONG>(InputRecorder::HEADER_SIZE)) {
+        Logger::error("Gravação de entrada inválida: " + filename);
+        close();
+        return false;
+    }
+    m_size = static_cast<uint64_t>(size.QuadPart);
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping) {
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!m_data) {
+        Logger::error("Falha ao mapear a gravação de entrada: " + std::to_string(GetLastError()));
+        close();
+        return false;
+    }
+
+    if (memcmp(m_data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        Logger::error("Gravação de entrada inválida: " + filename);
+        close();
+        return false;
+    }
+    if ((m_data[4] | (m_data[5] << 8)) != InputRecorder::FORMAT_VERSION) {
+        Logger::error("Versão de gravação de entrada não suportada: " + filename);
+        close();
+        return false;
+    }
+
+    if (!loadIndex()) {
+        Logger::error("Índice da gravação de entrada inconsistente: " + filename);
+        close();
+        return false;
+    }
+
+    rewind();
+    Logger::info("Gravação de entrada aberta: " + std::to_string(m_eventCount) + " eventos em " +
+                 std::to_string(m_chunks.size()) + " blocos");
+    return true;
+}
+
+void InputRecordingReader::close() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+
+    m_size = 0;
+    m_chunks.clear();
+    m_eventCount = 0;
+    m_chunk = 0;
+    m_chunkRemaining = 0;
+}
+
+bool InputRecordingReader::loadIndex() {
+    m_chunks.clear();
+    m_eventCount = 0;
+
+    const uint64_t minimum = InputRecorder::HEADER_SIZE + InputRecorder::FOOTER_SIZE;
+    const uint8_t* footer = m_data + m_size - InputRecorder::FOOTER_SIZE;
+
+    if (m_size >= minimum && memcmp(footer + 20, FOOTER_MAGIC, sizeof(FOOTER_MAGIC)) == 0) {
+        const uint64_t indexOffset = getU64(footer);
+        const uint64_t eventCount = getU64(footer + 8);
+        const uint64_t chunkCount = getU32(footer + 16);
+
+        if (indexOffset < InputRecorder::HEADER_SIZE ||
+            indexOffset + chunkCount * InputRecorder::INDEX_ENTRY_SIZE + InputRecorder::FOOTER_SIZE != m_size) {
+            return false;
+        }
+
+        const uint8_t* entry = m_data + indexOffset;
+        for (uint64_t i = 0; i < chunkCount; ++i, entry += InputRecorder::INDEX_ENTRY_SIZE) {
+            RecordingChunkInfo info;
+            info.offset = getU64(entry);
+            info.firstTimestamp = static_cast<int64_t>(getU64(entry + 8));
+            info.eventCount = getU32(entry + 16);
+
+            if (info.offset + InputRecorder::CHUNK_HEADER_SIZE > indexOffset) {
+                return false;
+            }
+            m_chunks.push_back(info);
+            m_eventCount += info.eventCount;
+        }
+        return m_eventCount == eventCount;
+    }
+
+    // Sem rodapé: gravação interrompida, aproveitar os blocos completos
+    Logger::warning("Gravação de entrada sem índice; percorrendo os blocos");
+    uint64_t offset = InputRecorder::HEADER_SIZE;
+    while (offset + InputRecorder::CHUNK_HEADER_SIZE <= m_size) {
+        const uint8_t* header = m_data + offset;
+        const uint64_t end = offset + InputRecorder::CHUNK_HEADER_SIZE + getU32(header + 4);
+        if (end > m_size) {
+            Logger::warning("Bloco final incompleto ignorado");
+            break;
+        }
+
+        RecordingChunkInfo info;
+        info.offset = offset;
+        info.firstTimestamp = static_cast<int64_t>(getU64(header + 8));
+        info.eventCount = getU32(header);
+        m_chunks.push_back(info);
+        m_eventCount += info.eventCount;
+        offset = end;
+    }
+    return true;
+}
+
+bool InputRecordingReader::enterChunk(size_t chunk) {
+    if (chunk >= m_chunks.size()) {
+        return false;
+    }
+
+    const RecordingChunkInfo& info = m_chunks[chunk];
+    const uint8_t* header = m_data + info.offset;
+    const uint64_t end = info.offset + InputRecorder::CHUNK_HEADER_SIZE + getU32(header + 4);
+    if (end > m_size) {
+        return false;
+    }
+
+    m_chunk = chunk;
+    m_cursor = header + InputRecorder::CHUNK_HEADER_SIZE;
+    m_chunkEnd = m_data + end;
+    m_chunkRemaining = getU32(header);
+    m_lastTimestamp = info.firstTimestamp;
+    m_lastDevice = 0;
+    return true;
+}
+
+bool InputRecordingReader::next(InputEvent& event) {
+    while (m_chunkRemaining == 0) {
+        if (!enterChunk(m_chunk + 1)) {
+            m_chunk = m_chunks.size();
+            return false;
+        }
+    }
+
+    const uint8_t* cursor = m_cursor;
+    uint64_t delta = 0;
+    uint64_t device = m_lastDevice;
+    uint64_t fields[5] = {};
+    bool valid = cursor < m_chunkEnd;
+
+    uint8_t tag = 0;
+    if (valid) {
+        tag = *cursor++;
+        valid = getVarint(cursor, m_chunkEnd, delta) &&
+                ((tag & TAG_SAME_DEVICE) || getVarint(cursor, m_chunkEnd, device));
+    }
+
+    const int type = tag & TAG_TYPE_MASK;
+    const int fieldCount = type == InputEvent::TYPE_KEYBOARD ? 2 : 5;
+    valid = valid && (type == InputEvent::TYPE_KEYBOARD || type == InputEvent::TYPE_MOUSE);
+    for (int i = 0; valid && i < fieldCount; ++i) {
+        valid = getVarint(cursor, m_chunkEnd, fields[i]);
+    }
+
+    if (!valid) {
+        Logger::warning("Evento inválido no bloco " + std::to_string(m_chunk) +
+                        " da gravação de entrada; leitura interrompida");
+        m_chunkRemaining = 0;
+        m_chunk = m_chunks.size();
+        return false;
+    }
+
+    event = InputEvent();
+    event.type = static_cast<InputEvent::EventType>(type);
+    event.deviceId = static_cast<InterceptionDevice>(device);
+    event.timestamp = m_lastTimestamp + unzigzag(delta);
+
+    if (event.type == InputEvent::TYPE_KEYBOARD) {
+        event.data.keyboard.code = static_cast<unsigned short>(fields[0]);
+        event.data.keyboard.state = static_cast<unsigned short>(fields[1]);
+    } else {
+        event.data.mouse.state = static_cast<unsigned short>(fields[0]);
+        event.data.mouse.flags = static_cast<unsigned short>(fields[1]);
+        event.data.mouse.rolling = static_cast<short>(unzigzag(fields[2]));
+        event.data.mouse.x = static_cast<int>(unzigzag(fields[3]));
+        event.data.mouse.y = static_cast<int>(unzigzag(fields[4]));
+    }
+
+    m_cursor = cursor;
+    m_lastTimestamp = event.timestamp;
+    m_lastDevice = event.deviceId;
+    --m_chunkRemaining;
+    return true;
+}
+
+void InputRecordingReader::rewind() {
+    if (!enterChunk(0)) {
+        m_chunk = m_chunks.size();
+        m_chunkRemaining = 0;
+    }
+}
+
+void InputRecordingReader::seek(int64_t timestamp) {
+    // Último bloco que começa até o instante
+    auto it = std::upper_bound(m_chunks.begin(), m_chunks.end(), timestamp,
+                               [](int64_t value, const RecordingChunkInfo& info) {
+                                   return value < info.firstTimestamp;
+                               });
+    if (it == m_chunks.begin() || !enterChunk(static_cast<size_t>(it - m_chunks.begin()) - 1)) {
+        rewind();
+        return;
+    }
+
+    // Descartar os eventos do bloco anteriores ao instante
+    while (m_chunkRemaining > 0) {
+        const uint8_t* cursor = m_cursor;
+        const uint32_t remaining = m_chunkRemaining;
+        const int64_t lastTimestamp = m_lastTimestamp;
+        const InterceptionDevice lastDevice = m_lastDevice;
+
+        InputEvent event;
+        if (!next(event)) {
+            return;
+        }
+        if (event.timestamp >= timestamp) {
+            m_cursor = cursor;
+            m_chunkRemaining = remaining;
+            m_lastTimestamp = lastTimestamp;
+            m_lastDevice = lastDevice;
+            return;
+        }
+    }
+}
+
+uint64_t InputRecordingReader::getEventCount() const {
+    return m_eventCount;
+}
+
+const std::vector<RecordingChunkInfo>& InputRecordingReader::getChunks() const {
+    return m_chunks;
+}
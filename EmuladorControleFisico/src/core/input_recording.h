@@ -0,0 +1,247 @@
+/**
+ * @file input_recording.h
+ * @brief Gravação compacta dos eventos de entrada capturados e leitura por mapeamento em memória
+ */
+
+#pragma once
+
+#include "interception_manager.h"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct RecordingChunkInfo
+ * @brief Entrada do índice de blocos de uma gravação
+ */
+struct RecordingChunkInfo {
+    uint64_t offset;          // Posição do cabeçalho do bloco no arquivo
+    int64_t firstTimestamp;   // Instante de captura do primeiro evento
+    uint32_t eventCount;
+};
+
+/**
+ * @class InputRecorder
+ * @brief Acrescenta os eventos capturados a um arquivo binário compacto
+ *
+ * Formato (little-endian):
+ * - cabeçalho de 16 bytes: "ECFI", versão (16 bits) e bytes reservados (zero);
+ * - blocos de até CHUNK_EVENTS eventos, cada um com cabeçalho de 16 bytes
+ *   (eventos, bytes de dados e instante do primeiro evento) seguido dos eventos;
+ * - ao fechar, o índice dos blocos (20 bytes por bloco) e um rodapé de 24 bytes
+ *   (posição do índice, total de eventos, número de blocos e "ECFX").
+ *
+ * Cada evento ocupa um byte de tipo seguido de varints: diferença de instante
+ * para o evento anterior do bloco, dispositivo (omitido quando repete o
+ * anterior) e os campos do traço; deslocamentos e roda usam zigzag. O campo
+ * information do Interception não é gravado. Como cada bloco começa do seu
+ * próprio instante, ele pode ser decodificado sem os anteriores.
+ *
+ * Os blocos são gravados ao encher, então uma gravação interrompida preserva
+ * os blocos completos e pode ser lida sem índice. A gravação em disco é feita
+ * por uma thread própria: a captura troca o bloco cheio por um vazio (dois
+ * buffers alternados) e continua sem esperar pelo arquivo.
+ */
+class InputRecorder {
+public:
+    static const uint16_t FORMAT_VERSION = 1;
+    static const uint32_t CHUNK_EVENTS = 4096;
+    static const size_t HEADER_SIZE = 16;
+    static const size_t CHUNK_HEADER_SIZE = 16;
+    static const size_t INDEX_ENTRY_SIZE = 20;
+    static const size_t FOOTER_SIZE = 24;
+    static const size_t MAX_EVENT_SIZE = 48;  // Pior caso de um evento codificado
+
+    InputRecorder();
+
+    /**
+     * @brief Destrutor (fecha a gravação)
+     */
+    ~InputRecorder();
+
+    /**
+     * @brief Cria o arquivo de gravação
+     * @param filename Arquivo (sobrescrito)
+     * @return true se criado com sucesso, false caso contrário
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Acrescenta um evento capturado
+     *
+     * Chamado pela thread de captura; nunca acessa o disco. Ao completar um
+     * bloco, entrega-o à thread de gravação.
+     *
+     * @param event Evento com o instante de captura
+     * @return true se gravado (ou guardado no bloco atual), false se a gravação não está aberta
+     */
+    bool append(const InputEvent& event);
+
+    /**
+     * @brief Grava os blocos pendentes, o índice e o rodapé e fecha o arquivo
+     */
+    void close();
+
+    /**
+     * @brief Verifica se a gravação está aberta
+     * @return true se aberta
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Obtém o número de eventos gravados
+     * @return Total de eventos
+     */
+    uint64_t getEventCount() const;
+
+private:
+    /**
+     * @struct PendingChunk
+     * @brief Bloco completo aguardando a thread de gravação
+     */
+    struct PendingChunk {
+        std::vector<uint8_t> data;
+        uint32_t eventCount;
+        int64_t firstTimestamp;
+    };
+
+    std::string m_filename;
+    mutable std::mutex m_mutex;  // Sem disputa na captura; protege o fechamento na saída
+    std::vector<uint8_t> m_chunk;
+    uint64_t m_eventCount;
+    uint32_t m_chunkEvents;
+    int64_t m_chunkFirstTimestamp;
+    int64_t m_lastTimestamp;
+    InterceptionDevice m_lastDevice;
+
+    // Entrega à thread de gravação: trava mantida só para trocar os vetores
+    std::mutex m_queueMutex;
+    std::vector<PendingChunk> m_pending;
+    std::vector<std::vector<uint8_t>> m_spareChunks;
+
+    // Usados apenas pela thread de gravação enquanto aberta
+    std::ofstream m_file;
+    std::vector<RecordingChunkInfo> m_index;
+    uint64_t m_offset;
+
+    HANDLE m_wakeEvent;
+    std::atomic<bool> m_writerRunning;
+    std::thread m_writerThread;
+
+    /**
+     * @brief Entrega o bloco atual à thread de gravação e passa a preencher um buffer vazio
+     */
+    void flushChunk();
+
+    /**
+     * @brief Loop da thread de gravação
+     */
+    void writerLoop();
+
+    /**
+     * @brief Grava os blocos entregues e registra-os no índice
+     */
+    void writePendingChunks();
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+};
+
+/**
+ * @class InputRecordingReader
+ * @brief Lê uma gravação de InputRecorder diretamente de um mapeamento do arquivo
+ *
+ * Os eventos são decodificados do mapeamento sem cópia intermediária do
+ * arquivo. Sem rodapé (gravação interrompida), os blocos são localizados
+ * percorrendo o arquivo e o último bloco incompleto é ignorado.
+ */
+class InputRecordingReader {
+public:
+    InputRecordingReader();
+
+    /**
+     * @brief Destrutor (desfaz o mapeamento)
+     */
+    ~InputRecordingReader();
+
+    /**
+     * @brief Mapeia uma gravação e carrega o índice de blocos
+     * @param filename Arquivo gravado
+     * @return true se aberto com sucesso, false caso contrário
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Desfaz o mapeamento e fecha o arquivo
+     */
+    void close();
+
+    /**
+     * @brief Decodifica o próximo evento
+     * @param event Recebe o evento
+     * @return true se havia um evento, false no fim ou em dados inválidos
+     */
+    bool next(InputEvent& event);
+
+    /**
+     * @brief Volta ao primeiro evento
+     */
+    void rewind();
+
+    /**
+     * @brief Posiciona a leitura no bloco que contém o instante, pelo índice
+     *
+     * Eventos do bloco anteriores ao instante são descartados.
+     *
+     * @param timestamp Instante de captura
+     */
+    void seek(int64_t timestamp);
+
+    /**
+     * @brief Obtém o número total de eventos
+     * @return Total de eventos nos blocos completos
+     */
+    uint64_t getEventCount() const;
+
+    /**
+     * @brief Obtém o índice de blocos
+     * @return Blocos em ordem
+     */
+    const std::vector<RecordingChunkInfo>& getChunks() const;
+
+private:
+    HANDLE m_file;
+    HANDLE m_mapping;
+    const uint8_t* m_data;
+    uint64_t m_size;
+    std::vector<RecordingChunkInfo> m_chunks;
+    uint64_t m_eventCount;
+
+    // Posição de leitura
+    size_t m_chunk;
+    const uint8_t* m_cursor;
+    const uint8_t* m_chunkEnd;
+    uint32_t m_chunkRemaining;
+    int64_t m_lastTimestamp;
+    InterceptionDevice m_lastDevice;
+
+    /**
+     * @brief Lê o índice do rodapé ou, sem rodapé, percorre os blocos
+     * @return true se o índice é consistente com o arquivo
+     */
+    bool loadIndex();
+
+    /**
+     * @brief Posiciona a leitura no início de um bloco
+     * @param chunk Posição no índice
+     * @return true se o bloco existe
+     */
+    bool enterChunk(size_t chunk);
+
+    InputRecordingReader(const InputRecordingReader&) = delete;
+    InputRecordingReader& operator=(const InputRecordingReader&) = delete;
+};
@@ -7,8 +7,9 @@
 #include "interception_manager.h"
 #include "../utils/logger.h"
 
-InterceptionManager::InterceptionManager() 
-    : m_context(nullptr), m_initialized(false) {
+InterceptionManager::InterceptionManager(Clock* clock) 
+    : m_context(nullptr), m_initialized(false),
+      m_clock(clock ? clock : Clock::getDefault()) {
 }
 
 InterceptionManager::~InterceptionManager() {
@@ -18,6 +19,10 @@ InterceptionManager::~InterceptionManager() {
     }
 }
 
+Clock* InterceptionManager::getClock() const {
+    return m_clock;
+}
+
 bool InterceptionManager::initialize() {
     // Criar contexto de interceptação
     m_context = interception_create_context();
@@ -76,6 +81,7 @@ InputEvent InterceptionManager::waitForEvent(int timeout) {
     }
     
     event.deviceId = device;
+    event.timestamp = m_clock->nowMicros();
     
     // Determinar o tipo de dispositivo e ler o evento
     if (interception_is_keyboard(device)) {
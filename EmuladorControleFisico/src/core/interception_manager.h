@@ -8,6 +8,8 @@
 
 #include <Windows.h>
 #include "../lib/interception/interception.h"
+#include "../utils/clock.h"
+#include <cstdint>
 #include <vector>
 
 /**
@@ -23,12 +25,13 @@ struct InputEvent {
     
     EventType type;
     InterceptionDevice deviceId;
+    int64_t timestamp;  // Instante da captura em microssegundos (relógio do InterceptionManager)
     union {
         InterceptionKeyStroke keyboard;
         InterceptionMouseStroke mouse;
     } data;
     
-    InputEvent() : type(TYPE_NONE), deviceId(0) { 
+    InputEvent() : type(TYPE_NONE), deviceId(0), timestamp(0) { 
         memset(&data, 0, sizeof(data)); 
     }
 };
@@ -41,8 +44,15 @@ class InterceptionManager {
 public:
     /**
      * @brief Construtor
+     * @param clock Relógio usado para marcar o instante de captura (nullptr = relógio real)
      */
-    InterceptionManager();
+    InterceptionManager(Clock* clock = nullptr);
+    
+    /**
+     * @brief Obtém o relógio que marca o instante de captura dos eventos
+     * @return Relógio usado
+     */
+    Clock* getClock() const;
     
     /**
      * @brief Destrutor
@@ -95,4 +105,5 @@ public:
 private:
     InterceptionContext m_context;
     bool m_initialized;
+    Clock* m_clock;
 };
@@ -0,0 +1,535 @@
+/**
+ * @file mapping_rules.cpp
+ * @brief Compilador e interpretador das regras condicionais de mapeamento
+ */
+
+#include "mapping_rules.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+struct ButtonName {
+    const char* name;
+    WORD mask;
+};
+
+const ButtonName BUTTON_NAMES[] = {
+    { "A", XUSB_GAMEPAD_A },
+    { "B", XUSB_GAMEPAD_B },
+    { "X", XUSB_GAMEPAD_X },
+    { "Y", XUSB_GAMEPAD_Y },
+    { "LB", XUSB_GAMEPAD_LEFT_SHOULDER },
+    { "RB", XUSB_GAMEPAD_RIGHT_SHOULDER },
+    { "LS", XUSB_GAMEPAD_LEFT_THUMB },
+    { "RS", XUSB_GAMEPAD_RIGHT_THUMB },
+    { "BACK", XUSB_GAMEPAD_BACK },
+    { "START", XUSB_GAMEPAD_START },
+    { "GUIDE", XUSB_GAMEPAD_GUIDE },
+    { "UP", XUSB_GAMEPAD_DPAD_UP },
+    { "DOWN", XUSB_GAMEPAD_DPAD_DOWN },
+    { "LEFT", XUSB_GAMEPAD_DPAD_LEFT },
+    { "RIGHT", XUSB_GAMEPAD_DPAD_RIGHT }
+};
+
+const char* const AXIS_NAMES[] = { "LX", "LY", "RX", "RY" };
+
+int buttonBitIndex(WORD mask) {
+    for (int bit = 0; bit < 16; bit++) {
+        if (mask & (1 << bit)) return bit;
+    }
+    return -1;
+}
+
+/**
+ * Compilador de descida recursiva. Cada expressão deixa seu resultado no
+ * registrador do topo da pilha de registradores.
+ */
+class RuleCompiler {
+public:
+    RuleCompiler(const std::string& text, std::vector<RuleInstruction>& code)
+        : m_text(text), m_pos(0), m_code(code), m_nextRegister(0) {}
+
+    bool compileCondition(int& resultRegister, size_t end) {
+        m_end = end;
+        if (!parseOr(resultRegister)) return false;
+        if (m_pos != m_end) return fail("texto inesperado na condição");
+        return true;
+    }
+
+    const std::string& getError() const { return m_error; }
+
+    bool fail(const std::string& message) {
+        if (m_error.empty()) {
+            m_error = message + " (posição " + std::to_string(m_pos) + ")";
+        }
+        return false;
+    }
+
+private:
+    enum OperandKind { OPERAND_BOOL, OPERAND_TRIGGER, OPERAND_AXIS };
+
+    const std::string& m_text;
+    size_t m_pos;
+    size_t m_end;
+    std::vector<RuleInstruction>& m_code;
+    int m_nextRegister;
+    std::string m_error;
+
+    bool match(const char* token) {
+        const size_t length = strlen(token);
+        if (m_pos + length <= m_end && m_text.compare(m_pos, length, token) == 0) {
+            m_pos += length;
+            return true;
+        }
+        return false;
+    }
+
+    std::string readName() {
+        const size_t start = m_pos;
+        while (m_pos < m_end && (std::isalnum(static_cast<unsigned char>(m_text[m_pos])) || m_text[m_pos] == '_')) {
+            m_pos++;
+        }
+        std::string name = m_text.substr(start, m_pos - start);
+        std::transform(name.begin(), name.end(), name.begin(),
+            [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        return name;
+    }
+
+    bool allocate(int& reg) {
+        if (m_nextRegister >= MappingRules::MAX_REGISTERS) {
+            return fail("expressão muito profunda");
+        }
+        reg = m_nextRegister++;
+        return true;
+    }
+
+    bool emit(RuleOpcode op, int a, int b, int c, int32_t imm) {
+        if (m_code.size() >= MappingRules::MAX_RULE_INSTRUCTIONS) {
+            return fail("regra muito longa");
+        }
+        RuleInstruction instruction;
+        instruction.op = op;
+        instruction.a = static_cast<uint8_t>(a);
+        instruction.b = static_cast<uint8_t>(b);
+        instruction.c = static_cast<uint8_t>(c);
+        instruction.imm = imm;
+        m_code.push_back(instruction);
+        return true;
+    }
+
+    bool binary(RuleOpcode op, int left, int right) {
+        // O resultado fica no registrador da esquerda; o da direita é liberado
+        if (!emit(op, left, left, right, 0)) return false;
+        m_nextRegister = right;
+        return true;
+    }
+
+    bool parseOr(int& reg) {
+        if (!parseAnd(reg)) return false;
+        while (match("|")) {
+            int right;
+            if (!parseAnd(right) || !binary(RULE_OP_OR, reg, right)) return false;
+        }
+        return true;
+    }
+
+    bool parseAnd(int& reg) {
+        if (!parseUnary(reg)) return false;
+        while (match("&")) {
+            int right;
+            if (!parseUnary(right) || !binary(RULE_OP_AND, reg, right)) return false;
+        }
+        return true;
+    }
+
+    bool parseUnary(int& reg) {
+        if (match("!")) {
+            if (!parseUnary(reg)) return false;
+            return emit(RULE_OP_NOT, reg, reg, 0, 0);
+        }
+        if (match("(")) {
+            if (!parseOr(reg)) return false;
+            if (!match(")")) return fail("')' esperado");
+            return true;
+        }
+        return parseComparison(reg);
+    }
+
+    bool parseComparison(int& reg) {
+        OperandKind kind;
+        if (!parseOperand(reg, kind)) return false;
+
+        RuleOpcode op;
+        if (match(">=")) op = RULE_OP_CMP_GE;
+        else if (match("<=")) op = RULE_OP_CMP_LE;
+        else if (match("==")) op = RULE_OP_CMP_EQ;
+        else if (match("!=")) op = RULE_OP_CMP_NE;
+        else if (match(">")) op = RULE_OP_CMP_GT;
+        else if (match("<")) op = RULE_OP_CMP_LT;
+        else return true; // Operando sozinho: verdadeiro se diferente de zero
+
+        int32_t value;
+        if (!parseNumber(kind, value)) return false;
+
+        int right;
+        if (!allocate(right) || !emit(RULE_OP_LOAD_CONST, right, 0, 0, value)) return false;
+        return binary(op, reg, right);
+    }
+
+    bool parseNumber(OperandKind kind, int32_t& value) {
+        const size_t start = m_pos;
+        if (m_pos < m_end && (m_text[m_pos] == '-' || m_text[m_pos] == '+')) m_pos++;
+        while (m_pos < m_end && std::isdigit(static_cast<unsigned char>(m_text[m_pos]))) m_pos++;
+        if (m_pos == start || !std::isdigit(static_cast<unsigned char>(m_text[m_pos - 1]))) {
+            return fail("número esperado");
+        }
+
+        long number = std::strtol(m_text.substr(start, m_pos - start).c_str(), nullptr, 10);
+
+        // Percentual relativo ao intervalo do operando
+        if (match("%")) {
+            const long range = (kind == OPERAND_TRIGGER) ? 255 : (kind == OPERAND_AXIS) ? 32767 : 100;
+            number = number * range / 100;
+        }
+
+        value = static_cast<int32_t>(std::max(-100000L, std::min(100000L, number)));
+        return true;
+    }
+
+    bool parseOperand(int& reg, OperandKind& kind) {
+        kind = OPERAND_BOOL;
+        RuleOpcode op;
+        int32_t imm = 0;
+
+        if (match("key.")) {
+            const bool hex = match("0x") || match("0X");
+            const size_t start = m_pos;
+            while (m_pos < m_end && (hex ? std::isxdigit(static_cast<unsigned char>(m_text[m_pos]))
+                                         : std::isdigit(static_cast<unsigned char>(m_text[m_pos])))) {
+                m_pos++;
+            }
+            if (m_pos == start) return fail("código de tecla esperado");
+            imm = static_cast<int32_t>(std::strtol(m_text.substr(start, m_pos - start).c_str(), nullptr, hex ? 16 : 10));
+            if (imm < 0 || imm >= RuleState::MAX_SCANCODE) return fail("código de tecla inválido");
+            op = RULE_OP_LOAD_KEY;
+        } else if (match("mouse.")) {
+            const std::string name = readName();
+            if (name == "LEFT") imm = 1;
+            else if (name == "RIGHT") imm = 2;
+            else if (name == "MIDDLE") imm = 4;
+            else return fail("botão do mouse desconhecido: " + name);
+            op = RULE_OP_LOAD_MOUSE;
+        } else if (match("button.")) {
+            const std::string name = readName();
+            imm = -1;
+            for (const auto& button : BUTTON_NAMES) {
+                if (name == button.name) imm = button.mask;
+            }
+            if (imm < 0) return fail("botão desconhecido: " + name);
+            op = RULE_OP_LOAD_BUTTON;
+        } else if (match("trigger.")) {
+            const std::string name = readName();
+            if (name == "L") imm = 0;
+            else if (name == "R") imm = 1;
+            else return fail("gatilho desconhecido: " + name);
+            op = RULE_OP_LOAD_TRIGGER;
+            kind = OPERAND_TRIGGER;
+        } else if (match("axis.")) {
+            const std::string name = readName();
+            imm = -1;
+            for (int i = 0; i < 4; i++) {
+                if (name == AXIS_NAMES[i]) imm = i;
+            }
+            if (imm < 0) return fail("eixo desconhecido: " + name);
+            op = RULE_OP_LOAD_AXIS;
+            kind = OPERAND_AXIS;
+        } else {
+            return fail("operando esperado");
+        }
+
+        return allocate(reg) && emit(op, reg, 0, 0, imm);
+    }
+};
+
+bool parseButtonName(const std::string& name, WORD& mask) {
+    for (const auto& button : BUTTON_NAMES) {
+        if (name == button.name) {
+            mask = button.mask;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string toUpper(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+        [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return text;
+}
+
+SHORT clampAxis(int64_t value) {
+    return static_cast<SHORT>(std::max<int64_t>(-32768, std::min<int64_t>(32767, value)));
+}
+
+} // namespace
+
+void RuleState::applyAction(const ControllerAction& action) {
+    switch (action.type) {
+        case ControllerAction::TYPE_BUTTON:
+            if (action.data.buttonData.pressed) buttons |= action.data.buttonData.button;
+            else buttons &= ~action.data.buttonData.button;
+            break;
+        case ControllerAction::TYPE_AXIS:
+            if (action.data.axisData.axis >= 0 && action.data.axisData.axis < 4) {
+                axes[action.data.axisData.axis] = action.data.axisData.value;
+            }
+            break;
+        case ControllerAction::TYPE_TRIGGER:
+            if (action.data.triggerData.trigger >= 0 && action.data.triggerData.trigger < 2) {
+                triggers[action.data.triggerData.trigger] = action.data.triggerData.value;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+bool MappingRules::addRule(const std::string& ruleText, std::string& error) {
+    // Remover espaços para aceitar regras escritas à mão
+    std::string text;
+    for (char c : ruleText) {
+        if (!std::isspace(static_cast<unsigned char>(c))) text += c;
+    }
+
+    const size_t arrow = text.find("->");
+    if (arrow == std::string::npos) {
+        error = "'->' esperado entre condição e efeito";
+        return false;
+    }
+
+    if (m_rules.size() >= 0xFFFF) {
+        error = "limite de regras atingido";
+        return false;
+    }
+
+    // Compilar a condição em um buffer próprio para não corromper o código em caso de erro
+    std::vector<RuleInstruction> code;
+    RuleCompiler compiler(text, code);
+    int resultRegister = 0;
+    if (!compiler.compileCondition(resultRegister, arrow)) {
+        error = compiler.getError();
+        return false;
+    }
+
+    // Efeito
+    const std::string effectText = text.substr(arrow + 2);
+    const size_t dot = effectText.find('.');
+    const size_t equals = effectText.find('=');
+    if (dot == std::string::npos) {
+        error = "efeito inválido: " + effectText;
+        return false;
+    }
+
+    const std::string effectName = effectText.substr(0, dot);
+    const std::string target = toUpper(effectText.substr(dot + 1, equals == std::string::npos ? std::string::npos : equals - dot - 1));
+    const std::string argument = equals == std::string::npos ? "" : effectText.substr(equals + 1);
+
+    CompiledRule rule;
+    rule.codeStart = static_cast<uint32_t>(m_code.size());
+    rule.codeLength = static_cast<uint16_t>(code.size());
+    rule.resultRegister = static_cast<uint8_t>(resultRegister);
+    rule.param = 0;
+
+    std::vector<std::vector<uint16_t>*> tables;
+    WORD buttonMask = 0;
+
+    if (effectName == "allow" || effectName == "block" || effectName == "remap") {
+        if (!parseButtonName(target, buttonMask)) {
+            error = "botão desconhecido: " + target;
+            return false;
+        }
+        tables.push_back(&m_buttonRules[buttonBitIndex(buttonMask)]);
+
+        if (effectName == "remap") {
+            WORD remapMask;
+            if (!parseButtonName(toUpper(argument), remapMask)) {
+                error = "botão de destino desconhecido: " + argument;
+                return false;
+            }
+            rule.effect = RULE_EFFECT_REMAP;
+            rule.param = remapMask;
+        } else {
+            rule.effect = (effectName == "allow") ? RULE_EFFECT_ALLOW : RULE_EFFECT_BLOCK;
+        }
+    } else if (effectName == "scale") {
+        char* end = nullptr;
+        const double factor = std::strtod(argument.c_str(), &end);
+        if (argument.empty() || *end != '\0' || factor < 0.0 || factor > 16.0) {
+            error = "fator de escala inválido: " + argument;
+            return false;
+        }
+
+        rule.effect = RULE_EFFECT_SCALE;
+        rule.param = static_cast<int32_t>(std::lround(factor * 65536.0));
+
+        if (target == "L" || target == "R") {
+            const int base = (target == "L") ? 0 : 2;
+            tables.push_back(&m_axisRules[base]);
+            tables.push_back(&m_axisRules[base + 1]);
+        } else if (target == "LT" || target == "RT") {
+            tables.push_back(&m_triggerRules[target == "LT" ? 0 : 1]);
+        } else {
+            for (int i = 0; i < 4; i++) {
+                if (target == AXIS_NAMES[i]) tables.push_back(&m_axisRules[i]);
+            }
+        }
+
+        if (tables.empty()) {
+            error = "alvo de escala desconhecido: " + target;
+            return false;
+        }
+    } else {
+        error = "efeito desconhecido: " + effectName;
+        return false;
+    }
+
+    const uint16_t ruleIndex = static_cast<uint16_t>(m_rules.size());
+    m_code.insert(m_code.end(), code.begin(), code.end());
+    m_rules.push_back(rule);
+    for (auto* table : tables) {
+        table->push_back(ruleIndex);
+    }
+
+    return true;
+}
+
+void MappingRules::clear() {
+    m_code.clear();
+    m_rules.clear();
+    for (auto& table : m_buttonRules) table.clear();
+    for (auto& table : m_axisRules) table.clear();
+    for (auto& table : m_triggerRules) table.clear();
+}
+
+size_t MappingRules::size() const {
+    return m_rules.size();
+}
+
+bool MappingRules::empty() const {
+    return m_rules.empty();
+}
+
+bool MappingRules::evaluate(const CompiledRule& rule, const RuleState& state) const {
+    int32_t r[MAX_REGISTERS];
+    const RuleInstruction* pc = m_code.data() + rule.codeStart;
+    const RuleInstruction* const end = pc + rule.codeLength;
+
+    // Execução linear: sem saltos, o custo é limitado pelo tamanho do programa
+    for (; pc != end; ++pc) {
+        switch (pc->op) {
+            case RULE_OP_LOAD_CONST:   r[pc->a] = pc->imm; break;
+            case RULE_OP_LOAD_KEY:     r[pc->a] = state.isKeyDown(pc->imm) ? 1 : 0; break;
+            case RULE_OP_LOAD_MOUSE:   r[pc->a] = (state.mouseButtons & pc->imm) ? 1 : 0; break;
+            case RULE_OP_LOAD_BUTTON:  r[pc->a] = (state.buttons & pc->imm) ? 1 : 0; break;
+            case RULE_OP_LOAD_TRIGGER: r[pc->a] = state.triggers[pc->imm]; break;
+            case RULE_OP_LOAD_AXIS:    r[pc->a] = state.axes[pc->imm]; break;
+            case RULE_OP_CMP_GT:       r[pc->a] = r[pc->b] > r[pc->c]; break;
+            case RULE_OP_CMP_GE:       r[pc->a] = r[pc->b] >= r[pc->c]; break;
+            case RULE_OP_CMP_LT:       r[pc->a] = r[pc->b] < r[pc->c]; break;
+            case RULE_OP_CMP_LE:       r[pc->a] = r[pc->b] <= r[pc->c]; break;
+            case RULE_OP_CMP_EQ:       r[pc->a] = r[pc->b] == r[pc->c]; break;
+            case RULE_OP_CMP_NE:       r[pc->a] = r[pc->b] != r[pc->c]; break;
+            case RULE_OP_AND:          r[pc->a] = r[pc->b] && r[pc->c]; break;
+            case RULE_OP_OR:           r[pc->a] = r[pc->b] || r[pc->c]; break;
+            case RULE_OP_NOT:          r[pc->a] = !r[pc->b]; break;
+            default:                   return false;
+        }
+    }
+
+    return r[rule.resultRegister] != 0;
+}
+
+bool MappingRules::apply(ControllerAction& action, const RuleState& state) const {
+    if (m_rules.empty()) {
+        return false;
+    }
+
+    switch (action.type) {
+        case ControllerAction::TYPE_BUTTON: {
+            const WORD button = static_cast<WORD>(action.data.buttonData.button);
+            const int bit = buttonBitIndex(button);
+            if (bit < 0) return false;
+
+            const bool pressed = action.data.buttonData.pressed;
+
+            for (uint16_t index : m_buttonRules[bit]) {
+                const CompiledRule& rule = m_rules[index];
+
+                if (rule.effect == RULE_EFFECT_REMAP) {
+                    // A soltura acompanha o botão que foi efetivamente pressionado,
+                    // mesmo que a condição tenha mudado nesse meio tempo
+                    const bool remap = pressed
+                        ? evaluate(rule, state)
+                        : (state.buttons & rule.param) && !(state.buttons & button);
+                    if (remap) {
+                        action.data.buttonData.button = static_cast<XUSB_BUTTON>(rule.param);
+                        return true;
+                    }
+                    continue;
+                }
+
+                // Soltar sempre passa, para não deixar botões presos
+                if (!pressed) continue;
+
+                const bool condition = evaluate(rule, state);
+                if ((rule.effect == RULE_EFFECT_ALLOW && !condition) ||
+                    (rule.effect == RULE_EFFECT_BLOCK && condition)) {
+                    action = ControllerAction();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        case ControllerAction::TYPE_AXIS: {
+            const int axis = action.data.axisData.axis;
+            if (axis < 0 || axis >= 4) return false;
+
+            bool changed = false;
+            int64_t value = action.data.axisData.value;
+            for (uint16_t index : m_axisRules[axis]) {
+                const CompiledRule& rule = m_rules[index];
+                if (evaluate(rule, state)) {
+                    value = value * rule.param / 65536;
+                    changed = true;
+                }
+            }
+            action.data.axisData.value = clampAxis(value);
+            return changed;
+        }
+
+        case ControllerAction::TYPE_TRIGGER: {
+            const int trigger = action.data.triggerData.trigger;
+            if (trigger < 0 || trigger >= 2) return false;
+
+            bool changed = false;
+            int64_t value = action.data.triggerData.value;
+            for (uint16_t index : m_triggerRules[trigger]) {
+                const CompiledRule& rule = m_rules[index];
+                if (evaluate(rule, state)) {
+                    value = value * rule.param / 65536;
+                    changed = true;
+                }
+            }
+            action.data.triggerData.value = static_cast<BYTE>(std::min<int64_t>(255, value));
+            return changed;
+        }
+
+        default:
+            return false;
+    }
+}
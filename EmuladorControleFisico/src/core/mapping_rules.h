@@ -0,0 +1,184 @@
+/**
+ * @file mapping_rules.h
+ * @brief Regras condicionais de mapeamento compiladas para bytecode de registradores
+ */
+
+#pragma once
+
+#include "virtual_controller.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct RuleState
+ * @brief Estado de entrada e do controle consultado pelas regras
+ */
+struct RuleState {
+    static const int MAX_SCANCODE = 512;
+
+    uint8_t keys[MAX_SCANCODE / 8];  // Bitmap de teclas pressionadas
+    uint8_t mouseButtons;            // Bits: 0=esquerdo, 1=direito, 2=meio
+    WORD buttons;                    // Botões do controle atualmente pressionados
+    BYTE triggers[2];                // Gatilhos (0=L, 1=R)
+    SHORT axes[4];                   // Eixos (0=LX, 1=LY, 2=RX, 3=RY)
+
+    RuleState() {
+        memset(this, 0, sizeof(RuleState));
+    }
+
+    /**
+     * @brief Atualiza o estado de uma tecla
+     * @param scanCode Código da tecla
+     * @param pressed true se pressionada
+     */
+    void setKey(WORD scanCode, bool pressed) {
+        if (scanCode >= MAX_SCANCODE) return;
+        if (pressed) keys[scanCode >> 3] |= static_cast<uint8_t>(1 << (scanCode & 7));
+        else keys[scanCode >> 3] &= static_cast<uint8_t>(~(1 << (scanCode & 7)));
+    }
+
+    /**
+     * @brief Verifica se uma tecla está pressionada
+     * @param scanCode Código da tecla
+     * @return true se pressionada
+     */
+    bool isKeyDown(int scanCode) const {
+        return scanCode >= 0 && scanCode < MAX_SCANCODE &&
+               (keys[scanCode >> 3] & (1 << (scanCode & 7))) != 0;
+    }
+
+    /**
+     * @brief Registra no estado o efeito de uma ação aplicada ao controle
+     * @param action Ação aplicada
+     */
+    void applyAction(const ControllerAction& action);
+};
+
+/**
+ * @enum RuleOpcode
+ * @brief Instruções da máquina de regras
+ */
+enum RuleOpcode : uint8_t {
+    RULE_OP_LOAD_CONST,    // r[a] = imm
+    RULE_OP_LOAD_KEY,      // r[a] = tecla imm pressionada
+    RULE_OP_LOAD_MOUSE,    // r[a] = botão do mouse (máscara imm) pressionado
+    RULE_OP_LOAD_BUTTON,   // r[a] = botão do controle (máscara imm) pressionado
+    RULE_OP_LOAD_TRIGGER,  // r[a] = gatilho imm
+    RULE_OP_LOAD_AXIS,     // r[a] = eixo imm
+    RULE_OP_CMP_GT,        // r[a] = r[b] >  r[c]
+    RULE_OP_CMP_GE,        // r[a] = r[b] >= r[c]
+    RULE_OP_CMP_LT,        // r[a] = r[b] <  r[c]
+    RULE_OP_CMP_LE,        // r[a] = r[b] <= r[c]
+    RULE_OP_CMP_EQ,        // r[a] = r[b] == r[c]
+    RULE_OP_CMP_NE,        // r[a] = r[b] != r[c]
+    RULE_OP_AND,           // r[a] = r[b] && r[c]
+    RULE_OP_OR,            // r[a] = r[b] || r[c]
+    RULE_OP_NOT            // r[a] = !r[b]
+};
+
+/**
+ * @struct RuleInstruction
+ * @brief Instrução de 8 bytes: opcode, três registradores e um imediato
+ */
+struct RuleInstruction {
+    uint8_t op;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+    int32_t imm;
+};
+
+/**
+ * @enum RuleEffect
+ * @brief Efeito de uma regra sobre a ação mapeada
+ */
+enum RuleEffect : uint8_t {
+    RULE_EFFECT_ALLOW,   // O botão só é pressionado enquanto a condição for verdadeira
+    RULE_EFFECT_BLOCK,   // O botão não é pressionado enquanto a condição for verdadeira
+    RULE_EFFECT_REMAP,   // O botão é trocado por outro enquanto a condição for verdadeira
+    RULE_EFFECT_SCALE    // O eixo/gatilho é escalado enquanto a condição for verdadeira
+};
+
+/**
+ * @class MappingRules
+ * @brief Conjunto de regras condicionais aplicadas a cada ação mapeada
+ *
+ * Sintaxe (espaços são ignorados): "condição->efeito".
+ *
+ * Condição: operandos combinados com '&', '|', '!' e parênteses. Operandos:
+ * key.<scancode>, mouse.left|right|middle, button.<nome>, trigger.L|R e
+ * axis.LX|LY|RX|RY, opcionalmente comparados com um número (>, >=, <, <=,
+ * ==, !=). Números com '%' são relativos ao intervalo do operando.
+ *
+ * Efeitos: allow.<botão>, block.<botão>, remap.<botão>=<botão>,
+ * scale.<LX|LY|RX|RY|L|R|LT|RT>=<fator>. L e R escalam os dois eixos do analógico.
+ *
+ * Exemplos: "mouse.right->allow.X", "trigger.L>50%->scale.R=0.5".
+ *
+ * As regras são compiladas no carregamento do perfil. A avaliação percorre só
+ * as regras do alvo da ação, sem saltos para trás nem alocação.
+ */
+class MappingRules {
+public:
+    static const int MAX_REGISTERS = 16;
+    static const size_t MAX_RULE_INSTRUCTIONS = 64;
+
+    /**
+     * @brief Compila e adiciona uma regra
+     * @param text Texto da regra
+     * @param error Recebe a descrição do erro em caso de falha
+     * @return true se compilada com sucesso, false caso contrário
+     */
+    bool addRule(const std::string& text, std::string& error);
+
+    /**
+     * @brief Remove todas as regras
+     */
+    void clear();
+
+    /**
+     * @brief Obtém o número de regras compiladas
+     * @return Número de regras
+     */
+    size_t size() const;
+
+    /**
+     * @brief Verifica se não há regras
+     * @return true se vazio
+     */
+    bool empty() const;
+
+    /**
+     * @brief Aplica as regras a uma ação mapeada
+     * @param action Ação a ser modificada (pode virar TYPE_NONE)
+     * @param state Estado atual de entrada e do controle
+     * @return true se a ação foi modificada, false caso contrário
+     */
+    bool apply(ControllerAction& action, const RuleState& state) const;
+
+private:
+    struct CompiledRule {
+        uint32_t codeStart;
+        uint16_t codeLength;
+        uint8_t resultRegister;
+        RuleEffect effect;
+        int32_t param;     // Máscara do botão de destino (remap) ou fator Q16 (scale)
+    };
+
+    std::vector<RuleInstruction> m_code;
+    std::vector<CompiledRule> m_rules;
+
+    // Tabelas de despacho: índices das regras por alvo
+    std::vector<uint16_t> m_buttonRules[16];
+    std::vector<uint16_t> m_axisRules[4];
+    std::vector<uint16_t> m_triggerRules[2];
+
+    /**
+     * @brief Executa o programa de condição de uma regra
+     * @param rule Regra compilada
+     * @param state Estado consultado
+     * @return true se a condição for verdadeira
+     */
+    bool evaluate(const CompiledRule& rule, const RuleState& state) const;
+};
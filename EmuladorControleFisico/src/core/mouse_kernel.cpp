@@ -0,0 +1,227 @@
+/**
+ * @file mouse_kernel.cpp
+ * @brief Implementações escalar, SSE2 e AVX2 do kernel de movimento do mouse
+ */
+
+#include "mouse_kernel.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MOUSE_KERNEL_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// GCC/Clang exigem que funções com AVX2 sejam marcadas explicitamente;
+// o MSVC permite intrínsecos AVX2 sem /arch, então a marcação é vazia
+#if defined(MOUSE_KERNEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MOUSE_KERNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MOUSE_KERNEL_TARGET_AVX2
+#endif
+
+namespace {
+
+typedef void (*MouseKernelFn)(const int*, const float*, size_t, const MouseAxisParams&, short*);
+
+void mapBatchScalar(const int* deltas, const float* deltaTimes, size_t count,
+                    const MouseAxisParams& params, short* out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = mapMouseAxisValue(deltas[i], deltaTimes[i], params);
+    }
+}
+
+#ifdef MOUSE_KERNEL_X86
+
+void cpuid(int info[4], int leaf, int subleaf) {
+#ifdef _MSC_VER
+    __cpuidex(info, leaf, subleaf);
+#else
+    __cpuid_count(leaf, subleaf, info[0], info[1], info[2], info[3]);
+#endif
+}
+
+unsigned long long readXcr0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+
+bool cpuHasAvx2() {
+    int info[4];
+    cpuid(info, 0, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+
+    // AVX e OSXSAVE (o sistema operacional salva os registradores YMM)
+    cpuid(info, 1, 0);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (readXcr0() & 0x6) != 0x6) {
+        return false;
+    }
+
+    cpuid(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+}
+
+// As operações seguem exatamente a ordem de mapMouseAxisValue. A ordem dos
+// operandos em min/max reproduz o comportamento escalar inclusive com NaN.
+void mapBatchSse2(const int* deltas, const float* deltaTimes, size_t count,
+                  const MouseAxisParams& params, short* out) {
+    const __m128 minDt = _mm_set1_ps(0.001f);
+    const __m128 maxValue = _mm_set1_ps(32767.0f);
+    const __m128 minValue = _mm_set1_ps(-32767.0f);
+    const __m128 sensitivity = _mm_set1_ps(params.sensitivity);
+    const __m128 globalSensitivity = _mm_set1_ps(params.globalSensitivity);
+    const __m128i deadZone = _mm_set1_epi32(params.deadZone);
+    const __m128i negDeadZone = _mm_set1_epi32(-params.deadZone);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 delta = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + i)));
+        __m128 dt = _mm_max_ps(minDt, _mm_loadu_ps(deltaTimes + i));
+
+        __m128 value = _mm_div_ps(delta, dt);
+        value = _mm_mul_ps(value, sensitivity);
+        value = _mm_mul_ps(value, globalSensitivity);
+        value = _mm_max_ps(_mm_min_ps(value, maxValue), minValue);
+
+        __m128i result = _mm_cvttps_epi32(value);
+        if (params.invert) {
+            result = _mm_sub_epi32(zero, result);
+        }
+
+        // |v| < deadZone  <=>  v < deadZone && v > -deadZone
+        __m128i inDeadZone = _mm_and_si128(_mm_cmplt_epi32(result, deadZone),
+                                           _mm_cmpgt_epi32(result, negDeadZone));
+        result = _mm_andnot_si128(inDeadZone, result);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(result, result));
+    }
+
+    mapBatchScalar(deltas + i, deltaTimes + i, count - i, params, out + i);
+}
+
+MOUSE_KERNEL_TARGET_AVX2
+void mapBatchAvx2(const int* deltas, const float* deltaTimes, size_t count,
+                  const MouseAxisParams& params, short* out) {
+    const __m256 minDt = _mm256_set1_ps(0.001f);
+    const __m256 maxValue = _mm256_set1_ps(32767.0f);
+    const __m256 minValue = _mm256_set1_ps(-32767.0f);
+    const __m256 sensitivity = _mm256_set1_ps(params.sensitivity);
+    const __m256 globalSensitivity = _mm256_set1_ps(params.globalSensitivity);
+    const __m256i deadZone = _mm256_set1_epi32(params.deadZone);
+    const __m256i negDeadZone = _mm256_set1_epi32(-params.deadZone);
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 delta = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(deltas + i)));
+        __m256 dt = _mm256_max_ps(minDt, _mm256_loadu_ps(deltaTimes + i));
+
+        __m256 value = _mm256_div_ps(delta, dt);
+        value = _mm256_mul_ps(value, sensitivity);
+        value = _mm256_mul_ps(value, globalSensitivity);
+        value = _mm256_max_ps(_mm256_min_ps(value, maxValue), minValue);
+
+        __m256i result = _mm256_cvttps_epi32(value);
+        if (params.invert) {
+            result = _mm256_sub_epi32(zero, result);
+        }
+
+        __m256i inDeadZone = _mm256_and_si256(_mm256_cmpgt_epi32(deadZone, result),
+                                              _mm256_cmpgt_epi32(result, negDeadZone));
+        result = _mm256_andnot_si256(inDeadZone, result);
+
+        // _mm256_packs_epi32 intercala as metades, então empacotamos cada metade em 128 bits
+        __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(result),
+                                         _mm256_extracti128_si256(result, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+
+    mapBatchSse2(deltas + i, deltaTimes + i, count - i, params, out + i);
+}
+
+#endif // MOUSE_KERNEL_X86
+
+MouseKernelFn getKernel(MouseKernelPath path) {
+#ifdef MOUSE_KERNEL_X86
+    if (isMouseKernelPathSupported(path)) {
+        switch (path) {
+            case MOUSE_KERNEL_AVX2:
+                return mapBatchAvx2;
+            case MOUSE_KERNEL_SSE2:
+                return mapBatchSse2;
+            default:
+                break;
+        }
+    }
+#endif
+    (void)path;
+    return mapBatchScalar;
+}
+
+} // namespace
+
+MouseKernelPath detectMouseKernelPath() {
+    if (isMouseKernelPathSupported(MOUSE_KERNEL_AVX2)) {
+        return MOUSE_KERNEL_AVX2;
+    }
+    if (isMouseKernelPathSupported(MOUSE_KERNEL_SSE2)) {
+        return MOUSE_KERNEL_SSE2;
+    }
+    return MOUSE_KERNEL_SCALAR;
+}
+
+bool isMouseKernelPathSupported(MouseKernelPath path) {
+    switch (path) {
+        case MOUSE_KERNEL_SCALAR:
+            return true;
+#ifdef MOUSE_KERNEL_X86
+        case MOUSE_KERNEL_SSE2:
+            // SSE2 faz parte da base x64 e é exigido pelo projeto em Win32
+            return true;
+        case MOUSE_KERNEL_AVX2: {
+            static const bool hasAvx2 = cpuHasAvx2();
+            return hasAvx2;
+        }
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* getMouseKernelPathName(MouseKernelPath path) {
+    switch (path) {
+        case MOUSE_KERNEL_SCALAR:
+            return "scalar";
+        case MOUSE_KERNEL_SSE2:
+            return "sse2";
+        case MOUSE_KERNEL_AVX2:
+            return "avx2";
+        default:
+            return "desconhecido";
+    }
+}
+
+void mapMouseAxisBatch(const int* deltas, const float* deltaTimes, size_t count,
+                       const MouseAxisParams& params, short* out) {
+    // Seleção feita uma única vez, na primeira chamada
+    static const MouseKernelFn kernel = getKernel(detectMouseKernelPath());
+    kernel(deltas, deltaTimes, count, params, out);
+}
+
+void mapMouseAxisBatchWith(MouseKernelPath path, const int* deltas, const float* deltaTimes,
+                           size_t count, const MouseAxisParams& params, short* out) {
+    getKernel(path)(deltas, deltaTimes, count, params, out);
+}
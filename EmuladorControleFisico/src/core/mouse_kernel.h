@@ -0,0 +1,112 @@
+/**
+ * @file mouse_kernel.h
+ * @brief Kernel em lote para mapear movimento do mouse em valores de eixo analógico
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+
+/**
+ * @enum MouseKernelPath
+ * @brief Implementações disponíveis do kernel de movimento do mouse
+ */
+enum MouseKernelPath {
+    MOUSE_KERNEL_SCALAR,
+    MOUSE_KERNEL_SSE2,
+    MOUSE_KERNEL_AVX2
+};
+
+/**
+ * @struct MouseAxisParams
+ * @brief Parâmetros de um mapeamento de eixo do mouse usados pelo kernel
+ */
+struct MouseAxisParams {
+    float sensitivity;        // Sensibilidade do mapeamento
+    float globalSensitivity;  // Sensibilidade global do mouse
+    int deadZone;             // Dead zone do analógico
+    bool invert;              // Inverter direção
+
+    MouseAxisParams(float s = 1.0f, float gs = 1.0f, int dz = 0, bool i = false)
+        : sensitivity(s), globalSensitivity(gs), deadZone(dz), invert(i) {}
+};
+
+/**
+ * @brief Implementação escalar de referência para um único movimento
+ *
+ * Todas as implementações vetoriais devem produzir exatamente o mesmo resultado
+ * desta função, inclusive na ordem das operações de ponto flutuante.
+ *
+ * @param delta Deslocamento relativo do mouse no eixo
+ * @param deltaTime Intervalo desde o movimento anterior, em segundos
+ * @param params Parâmetros do mapeamento
+ * @return Valor do eixo do controle
+ */
+inline short mapMouseAxisValue(int delta, float deltaTime, const MouseAxisParams& params) {
+    // Evitar divisão por zero
+    if (deltaTime < 0.001f) deltaTime = 0.001f;
+
+    // Velocidade (pixels por segundo) com sensibilidade aplicada
+    float value = static_cast<float>(delta) / deltaTime;
+    value = value * params.sensitivity;
+    value = value * params.globalSensitivity;
+    value = std::max(-32767.0f, std::min(32767.0f, value));
+
+    short result = params.invert ? -static_cast<short>(value) : static_cast<short>(value);
+
+    // Aplicar dead zone
+    if (std::abs(result) < params.deadZone) {
+        result = 0;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Detecta a melhor implementação suportada pela CPU e pelo sistema operacional
+ * @return Caminho do kernel selecionado
+ */
+MouseKernelPath detectMouseKernelPath();
+
+/**
+ * @brief Verifica se uma implementação é suportada na máquina atual
+ * @param path Caminho do kernel
+ * @return true se suportado, false caso contrário
+ */
+bool isMouseKernelPathSupported(MouseKernelPath path);
+
+/**
+ * @brief Obtém o nome legível de uma implementação
+ * @param path Caminho do kernel
+ * @return Nome da implementação
+ */
+const char* getMouseKernelPathName(MouseKernelPath path);
+
+/**
+ * @brief Mapeia um lote de movimentos usando a melhor implementação disponível
+ * @param deltas Deslocamentos relativos de cada movimento
+ * @param deltaTimes Intervalos de cada movimento, em segundos
+ * @param count Número de movimentos no lote
+ * @param params Parâmetros do mapeamento
+ * @param out Valores de eixo resultantes (count elementos)
+ */
+void mapMouseAxisBatch(const int* deltas, const float* deltaTimes, size_t count,
+                       const MouseAxisParams& params, short* out);
+
+/**
+ * @brief Mapeia um lote de movimentos forçando uma implementação específica
+ *
+ * Usado para comparação diferencial e benchmarks entre implementações.
+ * Caminhos não suportados pela máquina recaem na implementação escalar.
+ *
+ * @param path Implementação a ser usada
+ * @param deltas Deslocamentos relativos de cada movimento
+ * @param deltaTimes Intervalos de cada movimento, em segundos
+ * @param count Número de movimentos no lote
+ * @param params Parâmetros do mapeamento
+ * @param out Valores de eixo resultantes (count elementos)
+ */
+void mapMouseAxisBatchWith(MouseKernelPath path, const int* deltas, const float* deltaTimes,
+                           size_t count, const MouseAxisParams& params, short* out);
@@ -0,0 +1,80 @@
+/**
+ * @file one_euro_filter.cpp
+ * @brief Implementação do filtro One-Euro em ponto fixo
+ */
+
+#include "one_euro_filter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+const int64_t ONE_Q16 = 65536;
+const int64_t TWO_PI_Q16 = 411775;          // 2π em Q16
+const int64_t MAX_CUTOFF_MILLIHZ = 1000000; // 1 kHz
+const int64_t MAX_DELTA_MICROS = 1000000;   // 1 s
+const int64_t MAX_DERIVATIVE = 1000000000;  // Limite para evitar overflow no corte
+const float MAX_BETA = 10.0f;
+
+int64_t toMilliHz(float hz) {
+    return std::max<int64_t>(1, static_cast<int64_t>(std::llround(hz * 1000.0)));
+}
+
+} // namespace
+
+OneEuroFilter::OneEuroFilter(float minCutoff, float beta, float derivativeCutoff)
+    : m_hasPrevious(false), m_valueQ16(0), m_derivative(0) {
+    setParameters(minCutoff, beta, derivativeCutoff);
+}
+
+void OneEuroFilter::setParameters(float minCutoff, float beta, float derivativeCutoff) {
+    m_minCutoffMilliHz = toMilliHz(minCutoff);
+    m_derivativeCutoffMilliHz = toMilliHz(derivativeCutoff);
+    beta = std::max(0.0f, std::min(beta, MAX_BETA));
+    m_betaQ16 = static_cast<int64_t>(std::llround(beta * 1000.0 * ONE_Q16));
+}
+
+void OneEuroFilter::reset() {
+    m_hasPrevious = false;
+    m_valueQ16 = 0;
+    m_derivative = 0;
+}
+
+int64_t OneEuroFilter::smoothingFactorQ16(int64_t cutoffMilliHz, int64_t deltaMicros) {
+    // alfa = r / (r + 1), com r = 2π * fc * dt
+    const int64_t r = TWO_PI_Q16 * cutoffMilliHz * deltaMicros / 1000000000LL;
+    return (r * ONE_Q16) / (r + ONE_Q16);
+}
+
+short OneEuroFilter::filter(short value, int64_t deltaMicros) {
+    const int64_t valueQ16 = static_cast<int64_t>(value) * ONE_Q16;
+
+    if (!m_hasPrevious) {
+        m_valueQ16 = valueQ16;
+        m_derivative = 0;
+        m_hasPrevious = true;
+        return value;
+    }
+
+    const int64_t dt = std::max<int64_t>(1, std::min(deltaMicros, MAX_DELTA_MICROS));
+
+    // Derivada (unidades de eixo por segundo), suavizada com corte fixo
+    const int64_t rawDerivative = (valueQ16 - m_valueQ16) * 1000000 / dt / ONE_Q16;
+    const int64_t derivativeAlpha = smoothingFactorQ16(m_derivativeCutoffMilliHz, dt);
+    m_derivative += derivativeAlpha * (rawDerivative - m_derivative) / ONE_Q16;
+
+    // Corte adaptativo: cresce com a velocidade do sinal
+    int64_t cutoff = m_minCutoffMilliHz + m_betaQ16 * std::min(std::abs(m_derivative), MAX_DERIVATIVE) / ONE_Q16;
+    cutoff = std::min(cutoff, MAX_CUTOFF_MILLIHZ);
+
+    const int64_t alpha = smoothingFactorQ16(cutoff, dt);
+    m_valueQ16 += alpha * (valueQ16 - m_valueQ16) / ONE_Q16;
+
+    // Arredondar para o inteiro mais próximo
+    int64_t result = (m_valueQ16 >= 0) ? (m_valueQ16 + ONE_Q16 / 2) / ONE_Q16
+                                       : (m_valueQ16 - ONE_Q16 / 2) / ONE_Q16;
+    result = std::max<int64_t>(-32768, std::min<int64_t>(32767, result));
+
+    return static_cast<short>(result);
+}
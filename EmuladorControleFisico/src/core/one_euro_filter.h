@@ -0,0 +1,66 @@
+/**
+ * @file one_euro_filter.h
+ * @brief Filtro adaptativo One-Euro em ponto fixo para eixos analógicos
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @class OneEuroFilter
+ * @brief Filtro passa-baixa adaptativo de baixa latência (One-Euro)
+ *
+ * A frequência de corte sobe com a velocidade do sinal: em movimentos lentos
+ * o filtro suaviza o ruído, em movimentos rápidos praticamente não adiciona
+ * atraso. Todo o cálculo é feito em ponto fixo Q16 sobre valores de eixo
+ * (-32768 a 32767) e intervalos em microssegundos.
+ */
+class OneEuroFilter {
+public:
+    /**
+     * @brief Construtor
+     * @param minCutoff Frequência de corte mínima em Hz
+     * @param beta Ganho da frequência de corte em Hz por (unidade de eixo/s)
+     * @param derivativeCutoff Frequência de corte do filtro da derivada em Hz
+     */
+    OneEuroFilter(float minCutoff = 1.0f, float beta = 0.0f, float derivativeCutoff = 1.0f);
+
+    /**
+     * @brief Define os parâmetros do filtro
+     * @param minCutoff Frequência de corte mínima em Hz
+     * @param beta Ganho da frequência de corte em Hz por (unidade de eixo/s)
+     * @param derivativeCutoff Frequência de corte do filtro da derivada em Hz
+     */
+    void setParameters(float minCutoff, float beta, float derivativeCutoff);
+
+    /**
+     * @brief Filtra uma nova amostra
+     * @param value Valor bruto do eixo
+     * @param deltaMicros Intervalo desde a amostra anterior, em microssegundos
+     * @return Valor filtrado do eixo
+     */
+    short filter(short value, int64_t deltaMicros);
+
+    /**
+     * @brief Descarta o histórico; a próxima amostra passa sem filtragem
+     */
+    void reset();
+
+private:
+    int64_t m_minCutoffMilliHz;      // Corte mínimo em mHz
+    int64_t m_derivativeCutoffMilliHz; // Corte da derivada em mHz
+    int64_t m_betaQ16;               // Beta em mHz por (unidade/s), Q16
+
+    bool m_hasPrevious;
+    int64_t m_valueQ16;              // Último valor filtrado, Q16
+    int64_t m_derivative;            // Última derivada filtrada, unidades/s
+
+    /**
+     * @brief Calcula o fator de suavização para uma frequência de corte
+     * @param cutoffMilliHz Frequência de corte em mHz
+     * @param deltaMicros Intervalo em microssegundos
+     * @return Fator alfa em Q16 (0 a 65536)
+     */
+    static int64_t smoothingFactorQ16(int64_t cutoffMilliHz, int64_t deltaMicros);
+};
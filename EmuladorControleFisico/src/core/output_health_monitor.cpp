@@ -0,0 +1,152 @@
+/**
+ * @file output_health_monitor.cpp
+ * @brief Implementação da detecção de travamento do destino de saída
+ */
+
+#include "output_health_monitor.h"
+#include <algorithm>
+#include <cstring>
+
+OutputHealthMonitor::OutputHealthMonitor(size_t windowSize)
+    : m_window(windowSize > MIN_SAMPLES ? windowSize : MIN_SAMPLES), m_next(0), m_count(0), m_windowFailures(0),
+      m_windowSlow(0), m_windowTotalMicros(0), m_consecutiveFailures(0), m_consecutiveHealthy(0),
+      m_recoveryProbe(false), m_stallLatencyMicros(5000), m_maxErrorRate(0.25), m_maxSlowRate(0.5),
+      m_degradedIntervalMicros(20000), m_recoveryIntervalMicros(1000000),
+      m_lastDegradedSubmit(0), m_lastRecoveryAttempt(0) {
+    memset(&m_metrics, 0, sizeof(m_metrics));
+    m_published.write(m_metrics);
+}
+
+void OutputHealthMonitor::configure(int64_t stallLatencyMicros, double maxErrorRate, double maxSlowRate,
+                                    int64_t degradedIntervalMicros, int64_t recoveryIntervalMicros) {
+    m_stallLatencyMicros = std::max<int64_t>(1, stallLatencyMicros);
+    m_maxErrorRate = std::min(1.0, std::max(0.0, maxErrorRate));
+    m_maxSlowRate = std::min(1.0, std::max(0.0, maxSlowRate));
+    m_degradedIntervalMicros = std::max<int64_t>(0, degradedIntervalMicros);
+    m_recoveryIntervalMicros = std::max<int64_t>(0, recoveryIntervalMicros);
+}
+
+bool OutputHealthMonitor::recordSubmit(int64_t durationMicros, bool success, int64_t nowMicros) {
+    Sample sample;
+    sample.durationMicros = durationMicros;
+    sample.failed = !success;
+    sample.slow = durationMicros >= m_stallLatencyMicros;
+
+    // Substituir a amostra mais antiga da janela
+    if (m_count == m_window.size()) {
+        const Sample& oldest = m_window[m_next];
+        m_windowFailures -= oldest.failed ? 1 : 0;
+        m_windowSlow -= oldest.slow ? 1 : 0;
+        m_windowTotalMicros -= oldest.durationMicros;
+    } else {
+        ++m_count;
+    }
+    m_window[m_next] = sample;
+    m_next = (m_next + 1) % m_window.size();
+    m_windowFailures += sample.failed ? 1 : 0;
+    m_windowSlow += sample.slow ? 1 : 0;
+    m_windowTotalMicros += durationMicros;
+
+    ++m_metrics.submits;
+    m_metrics.failedSubmits += sample.failed ? 1 : 0;
+    m_metrics.slowSubmits += sample.slow ? 1 : 0;
+    m_metrics.maxLatencyMicros = std::max(m_metrics.maxLatencyMicros, durationMicros);
+
+    m_consecutiveFailures = sample.failed ? m_consecutiveFailures + 1 : 0;
+    m_consecutiveHealthy = (sample.failed || sample.slow) ? 0 : m_consecutiveHealthy + 1;
+
+    const bool recoveryProbe = m_recoveryProbe;
+    m_recoveryProbe = false;
+
+    bool changed = false;
+    if (!m_metrics.degraded) {
+        const bool enoughSamples = m_count >= MIN_SAMPLES;
+        const bool tooManyErrors = enoughSamples && m_windowFailures > m_maxErrorRate * m_count;
+        const bool tooSlow = enoughSamples && m_windowSlow > m_maxSlowRate * m_count;
+
+        if (tooManyErrors || tooSlow || m_consecutiveFailures >= MAX_CONSECUTIVE_FAILURES) {
+            m_metrics.degraded = true;
+            ++m_metrics.stallEvents;
+            m_lastDegradedSubmit = nowMicros;
+            m_lastRecoveryAttempt = nowMicros;
+            changed = true;
+        }
+    } else if (m_consecutiveHealthy >= HEALTHY_TO_RECOVER || (recoveryProbe && m_consecutiveHealthy > 0)) {
+        leaveDegraded();
+        changed = true;
+    }
+
+    publish();
+    return changed;
+}
+
+bool OutputHealthMonitor::shouldSubmit(int64_t nowMicros) {
+    if (!m_metrics.degraded) {
+        return true;
+    }
+
+    if (nowMicros - m_lastDegradedSubmit >= m_degradedIntervalMicros) {
+        m_lastDegradedSubmit = nowMicros;
+        return true;
+    }
+
+    ++m_metrics.rateLimitedSubmits;
+    publish();
+    return false;
+}
+
+bool OutputHealthMonitor::shouldAttemptRecovery(int64_t nowMicros) {
+    // Só reconectar se a última chamada ainda falhou ou demorou; com o destino
+    // respondendo bem, basta aguardar as chamadas saudáveis que encerram o modo
+    if (!m_metrics.degraded || m_consecutiveHealthy > 0 ||
+        nowMicros - m_lastRecoveryAttempt < m_recoveryIntervalMicros) {
+        return false;
+    }
+
+    m_lastRecoveryAttempt = nowMicros;
+    ++m_metrics.recoveryAttempts;
+    publish();
+    return true;
+}
+
+void OutputHealthMonitor::recordRecovery(int64_t nowMicros) {
+    if (!m_metrics.degraded) {
+        return;
+    }
+
+    m_recoveryProbe = true;
+    m_lastDegradedSubmit = nowMicros - m_degradedIntervalMicros;
+}
+
+int64_t OutputHealthMonitor::getDegradedIntervalMicros() const {
+    return m_degradedIntervalMicros;
+}
+
+bool OutputHealthMonitor::isDegraded() const {
+    return m_metrics.degraded;
+}
+
+OutputHealthMetrics OutputHealthMonitor::getMetrics() const {
+    OutputHealthMetrics metrics;
+    m_published.read(metrics);
+    return metrics;
+}
+
+void OutputHealthMonitor::leaveDegraded() {
+    // Recomeçar a janela para que o histórico do travamento não reative o modo
+    m_metrics.degraded = false;
+    ++m_metrics.recoveryEvents;
+    m_next = 0;
+    m_count = 0;
+    m_windowFailures = 0;
+    m_windowSlow = 0;
+    m_windowTotalMicros = 0;
+}
+
+void OutputHealthMonitor::publish() {
+    const double count = static_cast<double>(std::max<size_t>(m_count, 1));
+    m_metrics.windowErrorRate = m_windowFailures / count;
+    m_metrics.windowSlowRate = m_windowSlow / count;
+    m_metrics.windowMeanMicros = m_windowTotalMicros / count;
+    m_published.write(m_metrics);
+}
@@ -0,0 +1,156 @@
+/**
+ * @file output_health_monitor.h
+ * @brief Detecção de travamento do destino de saída e controle do modo degradado
+ */
+
+#pragma once
+
+#include "../utils/seqlock.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct OutputHealthMetrics
+ * @brief Estado e contadores de saúde do destino de saída
+ */
+struct OutputHealthMetrics {
+    bool degraded;                 // Modo degradado ativo
+    uint64_t submits;              // Chamadas ao destino
+    uint64_t failedSubmits;        // Chamadas que falharam
+    uint64_t slowSubmits;          // Chamadas acima do limite de latência
+    uint64_t rateLimitedSubmits;   // Envios adiados pelo modo degradado
+    uint64_t stallEvents;          // Entradas no modo degradado
+    uint64_t recoveryAttempts;     // Tentativas de reconectar o controle
+    uint64_t recoveryEvents;       // Saídas do modo degradado
+    double windowErrorRate;        // Fração de falhas na janela
+    double windowSlowRate;         // Fração de chamadas lentas na janela
+    double windowMeanMicros;       // Latência média na janela
+    int64_t maxLatencyMicros;      // Maior latência já observada
+};
+
+/**
+ * @class OutputHealthMonitor
+ * @brief Mantém uma janela deslizante de latência e erros das chamadas ao destino
+ *
+ * Quando a taxa de erros ou de chamadas lentas na janela passa dos limites,
+ * entra em modo degradado: os envios são limitados a uma taxa baixa e
+ * tentativas periódicas de reconectar o controle são autorizadas. Uma
+ * sequência de chamadas saudáveis, ou o primeiro envio bem-sucedido após uma
+ * reconexão, encerra o modo degradado.
+ *
+ * Usado apenas pela thread de saída; as métricas podem ser lidas de
+ * qualquer thread sem bloqueio.
+ */
+class OutputHealthMonitor {
+public:
+    /**
+     * @brief Construtor
+     * @param windowSize Número de chamadas na janela deslizante
+     */
+    explicit OutputHealthMonitor(size_t windowSize = 256);
+
+    /**
+     * @brief Configura os limites
+     * @param stallLatencyMicros Latência a partir da qual uma chamada é lenta
+     * @param maxErrorRate Fração de falhas na janela que ativa o modo degradado
+     * @param maxSlowRate Fração de chamadas lentas na janela que ativa o modo degradado
+     * @param degradedIntervalMicros Intervalo mínimo entre envios no modo degradado
+     * @param recoveryIntervalMicros Intervalo entre tentativas de reconexão
+     */
+    void configure(int64_t stallLatencyMicros, double maxErrorRate, double maxSlowRate,
+                   int64_t degradedIntervalMicros, int64_t recoveryIntervalMicros);
+
+    /**
+     * @brief Registra o resultado de uma chamada ao destino
+     * @param durationMicros Duração da chamada
+     * @param success true se a chamada teve sucesso
+     * @param nowMicros Instante do fim da chamada
+     * @return true se o modo degradado foi ativado ou desativado por esta chamada
+     */
+    bool recordSubmit(int64_t durationMicros, bool success, int64_t nowMicros);
+
+    /**
+     * @brief Verifica se um envio pode ser feito agora (limite do modo degradado)
+     * @param nowMicros Instante atual
+     * @return true se o envio pode ser feito
+     */
+    bool shouldSubmit(int64_t nowMicros);
+
+    /**
+     * @brief Verifica se é hora de tentar reconectar o controle
+     * @param nowMicros Instante atual
+     * @return true se uma tentativa deve ser feita
+     */
+    bool shouldAttemptRecovery(int64_t nowMicros);
+
+    /**
+     * @brief Registra uma reconexão bem-sucedida do controle
+     *
+     * O próximo envio não espera o intervalo degradado e, se for saudável,
+     * encerra o modo degradado (um controle parado não gera as chamadas que
+     * o encerrariam de outra forma).
+     *
+     * @param nowMicros Instante da reconexão
+     */
+    void recordRecovery(int64_t nowMicros);
+
+    /**
+     * @brief Obtém o intervalo entre envios no modo degradado
+     * @return Intervalo em microssegundos
+     */
+    int64_t getDegradedIntervalMicros() const;
+
+    /**
+     * @brief Indica se o modo degradado está ativo
+     * @return true se degradado
+     */
+    bool isDegraded() const;
+
+    /**
+     * @brief Obtém uma cópia consistente das métricas (qualquer thread)
+     * @return Métricas atuais
+     */
+    OutputHealthMetrics getMetrics() const;
+
+private:
+    struct Sample {
+        int64_t durationMicros;
+        bool failed;
+        bool slow;
+    };
+
+    static const size_t MIN_SAMPLES = 16;
+    static const int MAX_CONSECUTIVE_FAILURES = 5;
+    static const int HEALTHY_TO_RECOVER = 16;
+
+    std::vector<Sample> m_window;
+    size_t m_next;
+    size_t m_count;
+    size_t m_windowFailures;
+    size_t m_windowSlow;
+    int64_t m_windowTotalMicros;
+    int m_consecutiveFailures;
+    int m_consecutiveHealthy;
+    bool m_recoveryProbe;       // Próximo envio testa a reconexão
+
+    int64_t m_stallLatencyMicros;
+    double m_maxErrorRate;
+    double m_maxSlowRate;
+    int64_t m_degradedIntervalMicros;
+    int64_t m_recoveryIntervalMicros;
+    int64_t m_lastDegradedSubmit;
+    int64_t m_lastRecoveryAttempt;
+
+    OutputHealthMetrics m_metrics;
+    SeqLock<OutputHealthMetrics> m_published;
+
+    /**
+     * @brief Recalcula as taxas da janela e publica as métricas
+     */
+    void publish();
+
+    /**
+     * @brief Encerra o modo degradado e recomeça a janela
+     */
+    void leaveDegraded();
+};
@@ -0,0 +1,191 @@
+/**
+ * @file output_sink.cpp
+ * @brief Implementação dos destinos dos relatórios do controle virtual
+ */
+
+#include "output_sink.h"
+#include "../utils/logger.h"
+
+namespace {
+
+const char RECORDING_MAGIC[4] = { 'E', 'C', 'F', 'O' };
+
+void putU16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+uint16_t getU16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+void putI64(uint8_t* out, int64_t value) {
+    const uint64_t bits = static_cast<uint64_t>(value);
+    for (int i = 0; i < 8; ++i) {
+        out[i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+}
+
+int64_t getI64(const uint8_t* in) {
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) {
+        bits |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return static_cast<int64_t>(bits);
+}
+
+} // namespace
+
+// NullOutputSink
+
+NullOutputSink::NullOutputSink()
+    : m_submitCount(0) {
+}
+
+bool NullOutputSink::open() {
+    return true;
+}
+
+void NullOutputSink::close() {
+}
+
+bool NullOutputSink::submit(const XUSB_REPORT& report, int64_t timestampMicros) {
+    ++m_submitCount;
+    return true;
+}
+
+std::string NullOutputSink::getName() const {
+    return "Nulo";
+}
+
+uint64_t NullOutputSink::getSubmitCount() const {
+    return m_submitCount;
+}
+
+// RecordingOutputSink
+
+RecordingOutputSink::RecordingOutputSink(const std::string& filename, OutputSink* forward)
+    : m_filename(filename), m_forward(forward), m_recordCount(0) {
+}
+
+RecordingOutputSink::~RecordingOutputSink() {
+    close();
+}
+
+bool RecordingOutputSink::open() {
+    m_file.open(m_filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        Logger::error("Não foi possível criar o arquivo de gravação: " + m_filename);
+        return false;
+    }
+
+    uint8_t header[8];
+    memcpy(header, RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    putU16(header + 4, FORMAT_VERSION);
+    putU16(header + 6, RECORD_SIZE);
+    m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    if (m_forward && !m_forward->open()) {
+        m_file.close();
+        return false;
+    }
+
+    m_recordCount = 0;
+    Logger::info("Gravando relatórios em " + m_filename);
+    return true;
+}
+
+void RecordingOutputSink::close() {
+    if (m_forward) {
+        m_forward->close();
+    }
+
+    if (m_file.is_open()) {
+        m_file.close();
+        Logger::info("Gravação finalizada: " + std::to_string(m_recordCount) + " relatórios em " + m_filename);
+    }
+}
+
+bool RecordingOutputSink::submit(const XUSB_REPORT& report, int64_t timestampMicros) {
+    // O destino encadeado decide o sucesso; só o que ele aceitou é gravado
+    if (m_forward && !m_forward->submit(report, timestampMicros)) {
+        return false;
+    }
+
+    uint8_t record[RECORD_SIZE];
+    putI64(record, timestampMicros);
+    putU16(record + 8, report.wButtons);
+    record[10] = report.bLeftTrigger;
+    record[11] = report.bRightTrigger;
+    putU16(record + 12, static_cast<uint16_t>(report.sThumbLX));
+    putU16(record + 14, static_cast<uint16_t>(report.sThumbLY));
+    putU16(record + 16, static_cast<uint16_t>(report.sThumbRX));
+    putU16(record + 18, static_cast<uint16_t>(report.sThumbRY));
+
+    m_file.write(reinterpret_cast<const char*>(record), sizeof(record));
+    ++m_recordCount;
+    return m_file.good();
+}
+
+std::string RecordingOutputSink::getName() const {
+    return m_forward ? "Gravação + " + m_forward->getName() : "Gravação";
+}
+
+OutputTargetType RecordingOutputSink::getTargetType() const {
+    return m_forward ? m_forward->getTargetType() : OUTPUT_TARGET_X360;
+}
+
+bool RecordingOutputSink::recover() {
+    // A gravação continua no mesmo arquivo; só o destino encadeado é restabelecido
+    return m_forward ? m_forward->recover() : true;
+}
+
+bool RecordingOutputSink::attachFeedback(FeedbackChannel* feedbackChannel) {
+    return m_forward ? m_forward->attachFeedback(feedbackChannel) : false;
+}
+
+uint64_t RecordingOutputSink::getRecordCount() const {
+    return m_recordCount;
+}
+
+bool RecordingOutputSink::load(const std::string& filename, std::vector<RecordedReport>& reports) {
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        Logger::error("Não foi possível abrir a gravação: " + filename);
+        return false;
+    }
+
+    uint8_t header[8];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        memcmp(header, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0) {
+        Logger::error("Arquivo de gravação inválido: " + filename);
+        return false;
+    }
+
+    if (getU16(header + 4) != FORMAT_VERSION || getU16(header + 6) != RECORD_SIZE) {
+        Logger::error("Versão de gravação não suportada: " + filename);
+        return false;
+    }
+
+    reports.clear();
+    uint8_t record[RECORD_SIZE];
+    while (file.read(reinterpret_cast<char*>(record), sizeof(record))) {
+        RecordedReport entry;
+        entry.timestamp = getI64(record);
+        entry.report.wButtons = getU16(record + 8);
+        entry.report.bLeftTrigger = record[10];
+        entry.report.bRightTrigger = record[11];
+        entry.report.sThumbLX = static_cast<SHORT>(getU16(record + 12));
+        entry.report.sThumbLY = static_cast<SHORT>(getU16(record + 14));
+        entry.report.sThumbRX = static_cast<SHORT>(getU16(record + 16));
+        entry.report.sThumbRY = static_cast<SHORT>(getU16(record + 18));
+        reports.push_back(entry);
+    }
+
+    // Registro final incompleto indica gravação interrompida
+    if (file.gcount() != 0) {
+        Logger::warning("Gravação truncada, último registro ignorado: " + filename);
+    }
+
+    return true;
+}
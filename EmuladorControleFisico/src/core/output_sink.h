@@ -0,0 +1,161 @@
+/**
+ * @file output_sink.h
+ * @brief Destinos dos relatórios do controle virtual (driver, nulo, gravação)
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include "../lib/ViGEm/Client.h"
+#include "output_target.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class FeedbackChannel;
+
+/**
+ * @class OutputSink
+ * @brief Destino para o qual o controle virtual envia cada relatório
+ *
+ * Chamado apenas pela thread de saída do VirtualController.
+ */
+class OutputSink {
+public:
+    virtual ~OutputSink() {}
+
+    /**
+     * @brief Prepara o destino para receber relatórios
+     * @return true se aberto com sucesso, false caso contrário
+     */
+    virtual bool open() = 0;
+
+    /**
+     * @brief Libera o destino
+     */
+    virtual void close() = 0;
+
+    /**
+     * @brief Envia um relatório
+     * @param report Estado interno do controle
+     * @param timestampMicros Instante do envio em microssegundos
+     * @return true se enviado com sucesso, false caso contrário
+     */
+    virtual bool submit(const XUSB_REPORT& report, int64_t timestampMicros) = 0;
+
+    /**
+     * @brief Obtém o nome do destino para log
+     * @return Nome do destino
+     */
+    virtual std::string getName() const = 0;
+
+    /**
+     * @brief Obtém o tipo de controle apresentado ao sistema
+     * @return Tipo de controle (Xbox 360 para destinos sem driver)
+     */
+    virtual OutputTargetType getTargetType() const {
+        return OUTPUT_TARGET_X360;
+    }
+
+    /**
+     * @brief Tenta restabelecer o destino após falhas (ex.: reconectar o controle)
+     * @return true se restabelecido, false caso contrário
+     */
+    virtual bool recover() {
+        close();
+        return open();
+    }
+
+    /**
+     * @brief Registra um canal de retorno de vibração/LED, se o destino suportar
+     * @param feedbackChannel Canal de retorno (não assume a posse)
+     * @return true se registrado, false se não suportado ou em caso de falha
+     */
+    virtual bool attachFeedback(FeedbackChannel* feedbackChannel) {
+        return false;
+    }
+};
+
+/**
+ * @class NullOutputSink
+ * @brief Descarta os relatórios; mede o custo do mapeamento sem o driver
+ */
+class NullOutputSink : public OutputSink {
+public:
+    NullOutputSink();
+
+    bool open() override;
+    void close() override;
+    bool submit(const XUSB_REPORT& report, int64_t timestampMicros) override;
+    std::string getName() const override;
+
+    /**
+     * @brief Obtém o número de relatórios recebidos
+     * @return Total de relatórios
+     */
+    uint64_t getSubmitCount() const;
+
+private:
+    uint64_t m_submitCount;
+};
+
+/**
+ * @struct RecordedReport
+ * @brief Relatório gravado com o instante do envio
+ */
+struct RecordedReport {
+    int64_t timestamp;
+    XUSB_REPORT report;
+};
+
+/**
+ * @class RecordingOutputSink
+ * @brief Acrescenta os relatórios com instante a um arquivo binário compacto
+ *
+ * Formato: cabeçalho de 8 bytes ("ECFO", versão de 16 bits, tamanho do
+ * registro de 16 bits) seguido de registros de 20 bytes em little-endian:
+ * instante (64 bits), botões (16), gatilhos L e R (8 cada) e eixos LX, LY,
+ * RX, RY (16 cada). Arquivos de duas execuções podem ser comparados byte a byte.
+ */
+class RecordingOutputSink : public OutputSink {
+public:
+    static const uint16_t FORMAT_VERSION = 1;
+    static const uint16_t RECORD_SIZE = 20;
+
+    /**
+     * @brief Construtor
+     * @param filename Arquivo de saída (sobrescrito na abertura)
+     * @param forward Destino que também recebe os relatórios (nullptr = nenhum; não assume a posse)
+     */
+    explicit RecordingOutputSink(const std::string& filename, OutputSink* forward = nullptr);
+    ~RecordingOutputSink();
+
+    bool open() override;
+    void close() override;
+    bool submit(const XUSB_REPORT& report, int64_t timestampMicros) override;
+    std::string getName() const override;
+    OutputTargetType getTargetType() const override;
+    bool recover() override;
+    bool attachFeedback(FeedbackChannel* feedbackChannel) override;
+
+    /**
+     * @brief Obtém o número de relatórios gravados
+     * @return Total de registros
+     */
+    uint64_t getRecordCount() const;
+
+    /**
+     * @brief Lê uma gravação inteira
+     * @param filename Arquivo gravado
+     * @param reports Recebe os relatórios em ordem
+     * @return true se lido com sucesso, false caso contrário
+     */
+    static bool load(const std::string& filename, std::vector<RecordedReport>& reports);
+
+private:
+    std::string m_filename;
+    OutputSink* m_forward;
+    std::ofstream m_file;
+    uint64_t m_recordCount;
+};
@@ -0,0 +1,23 @@
+/**
+ * @file output_target.cpp
+ * @brief Implementação das funções auxiliares dos tipos de controle de saída
+ */
+
+#include "output_target.h"
+#include "../utils/logger.h"
+#include <algorithm>
+
+OutputTargetType parseOutputTargetType(const std::string& name, OutputTargetType defaultType) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower == "x360" || lower == "xbox360" || lower == "xbox") {
+        return OUTPUT_TARGET_X360;
+    }
+    if (lower == "ds4" || lower == "dualshock4") {
+        return OUTPUT_TARGET_DS4;
+    }
+
+    Logger::warning("Tipo de controle de saída desconhecido: " + name);
+    return defaultType;
+}
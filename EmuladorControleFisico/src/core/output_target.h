@@ -0,0 +1,164 @@
+/**
+ * @file output_target.h
+ * @brief Tipos de controle virtual de saída e tradução do estado interno para cada um
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include "../lib/ViGEm/Client.h"
+#include <string>
+
+/**
+ * @enum OutputTargetType
+ * @brief Tipo de controle virtual apresentado ao sistema
+ */
+enum OutputTargetType {
+    OUTPUT_TARGET_X360,   // Xbox 360 (XUSB)
+    OUTPUT_TARGET_DS4     // DualShock 4
+};
+
+/**
+ * @brief Converte o nome de um tipo de controle ("x360", "ds4")
+ * @param name Nome do tipo
+ * @param defaultType Tipo usado se o nome for desconhecido
+ * @return Tipo correspondente
+ */
+OutputTargetType parseOutputTargetType(const std::string& name, OutputTargetType defaultType);
+
+/**
+ * @struct OutputTarget
+ * @brief Características de cada tipo de controle, especializadas em tempo de compilação
+ *
+ * O estado interno do controle é sempre um XUSB_REPORT; cada especialização
+ * define o relatório nativo, a tradução e as chamadas ViGEm correspondentes.
+ */
+template <OutputTargetType Type>
+struct OutputTarget;
+
+/**
+ * @brief Xbox 360: o relatório nativo é o próprio estado interno
+ */
+template <>
+struct OutputTarget<OUTPUT_TARGET_X360> {
+    typedef XUSB_REPORT Report;
+
+    static const char* getName() {
+        return "Xbox 360";
+    }
+
+    static PVIGEM_TARGET alloc() {
+        return vigem_target_x360_alloc();
+    }
+
+    static void translate(const XUSB_REPORT& state, Report& report) {
+        report = state;
+    }
+
+    static VIGEM_ERROR update(PVIGEM_CLIENT client, PVIGEM_TARGET target, const Report& report) {
+        return vigem_target_x360_update(client, target, report);
+    }
+};
+
+/**
+ * @brief DualShock 4: botões remapeados, direcional como chapéu e eixos de 8 bits
+ */
+template <>
+struct OutputTarget<OUTPUT_TARGET_DS4> {
+    typedef DS4_REPORT Report;
+
+    static const char* getName() {
+        return "DualShock 4";
+    }
+
+    static PVIGEM_TARGET alloc() {
+        return vigem_target_ds4_alloc();
+    }
+
+    /**
+     * @brief Converte um eixo de 16 bits com sinal para 0-255 (centro 128)
+     * @param value Valor do eixo
+     * @param invert true para inverter o sentido (eixos Y do DS4 crescem para baixo)
+     * @return Valor do eixo no DS4
+     */
+    static BYTE convertAxis(SHORT value, bool invert) {
+        const int shifted = invert ? (32768 - value) : (value + 32768);
+        return static_cast<BYTE>(shifted > 65535 ? 255 : (shifted >> 8));
+    }
+
+    /**
+     * @brief Converte o direcional do Xbox em direção de chapéu do DS4
+     * @param buttons Botões do estado interno
+     * @return Direção do chapéu (DS4_BUTTON_DPAD_NONE se solto)
+     */
+    static WORD convertDpad(WORD buttons) {
+        // Direções opostas se anulam
+        const int vertical = ((buttons & XUSB_GAMEPAD_DPAD_DOWN) ? 1 : 0) - ((buttons & XUSB_GAMEPAD_DPAD_UP) ? 1 : 0);
+        const int horizontal = ((buttons & XUSB_GAMEPAD_DPAD_RIGHT) ? 1 : 0) - ((buttons & XUSB_GAMEPAD_DPAD_LEFT) ? 1 : 0);
+
+        // Tabela indexada por [vertical + 1][horizontal + 1]
+        static const WORD hat[3][3] = {
+            { DS4_BUTTON_DPAD_NORTHWEST, DS4_BUTTON_DPAD_NORTH, DS4_BUTTON_DPAD_NORTHEAST },
+            { DS4_BUTTON_DPAD_WEST,      DS4_BUTTON_DPAD_NONE,  DS4_BUTTON_DPAD_EAST },
+            { DS4_BUTTON_DPAD_SOUTHWEST, DS4_BUTTON_DPAD_SOUTH, DS4_BUTTON_DPAD_SOUTHEAST }
+        };
+        return hat[vertical + 1][horizontal + 1];
+    }
+
+    static void translate(const XUSB_REPORT& state, Report& report) {
+        static const struct {
+            WORD xusb;
+            WORD ds4;
+        } buttonMap[] = {
+            { XUSB_GAMEPAD_A,              DS4_BUTTON_CROSS },
+            { XUSB_GAMEPAD_B,              DS4_BUTTON_CIRCLE },
+            { XUSB_GAMEPAD_X,              DS4_BUTTON_SQUARE },
+            { XUSB_GAMEPAD_Y,              DS4_BUTTON_TRIANGLE },
+            { XUSB_GAMEPAD_LEFT_SHOULDER,  DS4_BUTTON_SHOULDER_LEFT },
+            { XUSB_GAMEPAD_RIGHT_SHOULDER, DS4_BUTTON_SHOULDER_RIGHT },
+            { XUSB_GAMEPAD_BACK,           DS4_BUTTON_SHARE },
+            { XUSB_GAMEPAD_START,          DS4_BUTTON_OPTIONS },
+            { XUSB_GAMEPAD_LEFT_THUMB,     DS4_BUTTON_THUMB_LEFT },
+            { XUSB_GAMEPAD_RIGHT_THUMB,    DS4_BUTTON_THUMB_RIGHT }
+        };
+
+        WORD buttons = convertDpad(state.wButtons);
+        for (size_t i = 0; i < sizeof(buttonMap) / sizeof(buttonMap[0]); ++i) {
+            if (state.wButtons & buttonMap[i].xusb) {
+                buttons |= buttonMap[i].ds4;
+            }
+        }
+
+        // L2/R2 também têm bit digital, ativo com qualquer pressão
+        if (state.bLeftTrigger > 0) buttons |= DS4_BUTTON_TRIGGER_LEFT;
+        if (state.bRightTrigger > 0) buttons |= DS4_BUTTON_TRIGGER_RIGHT;
+
+        ZeroMemory(&report, sizeof(Report));
+        report.wButtons = buttons;
+        report.bSpecial = static_cast<BYTE>((state.wButtons & XUSB_GAMEPAD_GUIDE) ? DS4_SPECIAL_BUTTON_PS : 0);
+        report.bTriggerL = state.bLeftTrigger;
+        report.bTriggerR = state.bRightTrigger;
+        report.bThumbLX = convertAxis(state.sThumbLX, false);
+        report.bThumbLY = convertAxis(state.sThumbLY, true);
+        report.bThumbRX = convertAxis(state.sThumbRX, false);
+        report.bThumbRY = convertAxis(state.sThumbRY, true);
+    }
+
+    static VIGEM_ERROR update(PVIGEM_CLIENT client, PVIGEM_TARGET target, const Report& report) {
+        return vigem_target_ds4_update(client, target, report);
+    }
+};
+
+/**
+ * @brief Traduz o estado interno e o envia a um controle do tipo informado
+ * @param client Cliente ViGEm
+ * @param target Controle alocado com OutputTarget<Type>::alloc()
+ * @param state Estado interno do controle
+ * @return Resultado da chamada ViGEm
+ */
+template <OutputTargetType Type>
+inline VIGEM_ERROR submitToTarget(PVIGEM_CLIENT client, PVIGEM_TARGET target, const XUSB_REPORT& state) {
+    typename OutputTarget<Type>::Report report;
+    OutputTarget<Type>::translate(state, report);
+    return OutputTarget<Type>::update(client, target, report);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file poll_phase_scheduler.cpp
+ * @brief Implementação do alinhamento de fase do envio de relatórios
+ */
+
+#include "poll_phase_scheduler.h"
+#include <algorithm>
+#include <cmath>
+
+PollPhaseScheduler::PollPhaseScheduler(Clock* clock)
+    : m_clock(clock ? clock : Clock::getDefault()), m_active(false), m_hasObservation(false),
+      m_nominalPeriod(0.0), m_minPeriod(1000.0), m_maxPeriod(100000.0), m_leadMicros(1000),
+      m_phaseGain(0.25), m_periodGain(0.05), m_goodCount(0), m_activationEvent(nullptr) {
+    m_work.anchorMicros = 0;
+    m_work.periodMicros = 0.0;
+    m_work.phaseError = 0.0;
+    m_work.locked = false;
+}
+
+void PollPhaseScheduler::configure(double frameRateHz, int64_t leadMicros, double phaseGain, double periodGain) {
+    m_leadMicros = std::max<int64_t>(0, leadMicros);
+    m_phaseGain = std::min(1.0, std::max(0.0, phaseGain));
+    m_periodGain = std::min(1.0, std::max(0.0, periodGain));
+
+    if (frameRateHz > 0.0) {
+        // Com taxa conhecida, o período só pode variar até a metade ou o dobro
+        m_nominalPeriod = 1000000.0 / frameRateHz;
+        m_minPeriod = m_nominalPeriod * 0.5;
+        m_maxPeriod = m_nominalPeriod * 2.0;
+
+        m_work.anchorMicros = m_clock->nowMicros();
+        m_work.periodMicros = m_nominalPeriod;
+        m_state.write(m_work);
+        activate();
+    }
+}
+
+void PollPhaseScheduler::setActivationEvent(HANDLE event) {
+    m_activationEvent = event;
+    if (event && isActive()) {
+        SetEvent(event);
+    }
+}
+
+void PollPhaseScheduler::activate() {
+    m_active.store(true, std::memory_order_release);
+
+    const HANDLE event = m_activationEvent;
+    if (event) {
+        SetEvent(event);
+    }
+}
+
+void PollPhaseScheduler::onFeedback(const FeedbackEvent& event) {
+    observePoll(event.timestamp);
+}
+
+void PollPhaseScheduler::observePoll(int64_t timestampMicros) {
+    if (!m_hasObservation) {
+        m_hasObservation = true;
+        m_work.anchorMicros = timestampMicros;
+        m_state.write(m_work);
+        return;
+    }
+
+    // Sem taxa configurada, a segunda observação define o período inicial
+    if (m_work.periodMicros <= 0.0) {
+        const double interval = static_cast<double>(timestampMicros - m_work.anchorMicros);
+        m_work.anchorMicros = timestampMicros;
+        if (interval >= m_minPeriod && interval <= m_maxPeriod) {
+            m_work.periodMicros = interval;
+            m_state.write(m_work);
+            activate();
+        }
+        return;
+    }
+
+    // Leitura prevista mais próxima; observações perdidas apenas pulam períodos
+    const double elapsed = static_cast<double>(timestampMicros - m_work.anchorMicros);
+    const double cycles = std::max(1.0, std::floor(elapsed / m_work.periodMicros + 0.5));
+    const double predicted = static_cast<double>(m_work.anchorMicros) + cycles * m_work.periodMicros;
+    const double error = static_cast<double>(timestampMicros) - predicted;
+
+    // Fase: reancorar perto da observação; período: corrigir o erro acumulado por ciclo
+    m_work.anchorMicros = static_cast<int64_t>(predicted + m_phaseGain * error);
+    m_work.periodMicros = std::min(m_maxPeriod, std::max(m_minPeriod,
+                                   m_work.periodMicros + m_periodGain * error / cycles));
+    m_work.phaseError = error;
+
+    if (std::fabs(error) < m_work.periodMicros * 0.1) {
+        m_goodCount = std::min(m_goodCount + 1, LOCK_COUNT);
+    } else {
+        m_goodCount = 0;
+    }
+    m_work.locked = (m_goodCount >= LOCK_COUNT);
+
+    m_state.write(m_work);
+}
+
+bool PollPhaseScheduler::isActive() const {
+    return m_active.load(std::memory_order_acquire);
+}
+
+bool PollPhaseScheduler::isLocked() const {
+    State state;
+    m_state.read(state);
+    return state.locked;
+}
+
+int64_t PollPhaseScheduler::nextSubmitMicros(int64_t nowMicros) const {
+    State state;
+    m_state.read(state);
+
+    if (state.periodMicros <= 0.0) {
+        return nowMicros + 1000;
+    }
+
+    // Primeira leitura prevista a mais de meio período depois de agora + antecedência;
+    // a folga evita mirar de novo a leitura que acabou de receber um envio
+    // quando a reancoragem a desloca um pouco para frente
+    const double target = static_cast<double>(nowMicros + m_leadMicros - state.anchorMicros) +
+                          state.periodMicros * 0.5;
+    const double cycles = std::floor(target / state.periodMicros) + 1.0;
+    const int64_t nextPoll = state.anchorMicros + static_cast<int64_t>(cycles * state.periodMicros);
+    return std::max(nowMicros + 1, nextPoll - m_leadMicros);
+}
+
+double PollPhaseScheduler::getPeriodMicros() const {
+    State state;
+    m_state.read(state);
+    return state.periodMicros;
+}
+
+double PollPhaseScheduler::getPhaseErrorMicros() const {
+    State state;
+    m_state.read(state);
+    return state.phaseError;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file poll_phase_scheduler.h
+ * @brief Alinhamento do envio de relatórios à cadência de leitura do jogo
+ */
+
+#pragma once
+
+#include "feedback_channel.h"
+#include "../utils/clock.h"
+#include "../utils/seqlock.h"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class PollPhaseScheduler
+ * @brief Estima período e fase da leitura do jogo e agenda o envio logo antes dela
+ *
+ * Um laço de captura de fase (PLL) de segunda ordem ajusta a fase e o
+ * período a cada observação. As observações vêm do instante das notificações
+ * do driver (o jogo costuma chamar XInputSetState no mesmo quadro em que lê
+ * o controle); sem elas, a taxa de quadros configurada define só o período.
+ *
+ * Observações chegam por uma única thread (a de despacho do canal de
+ * retorno); a thread de saída consulta o próximo envio sem bloqueio.
+ */
+class PollPhaseScheduler : public FeedbackListener {
+public:
+    /**
+     * @brief Construtor
+     * @param clock Relógio das observações e do agendamento (nullptr = relógio real)
+     */
+    explicit PollPhaseScheduler(Clock* clock = nullptr);
+
+    /**
+     * @brief Configura o agendador (antes de receber observações)
+     * @param frameRateHz Taxa de quadros esperada do jogo (0 = desconhecida)
+     * @param leadMicros Antecedência do envio em relação à leitura prevista
+     * @param phaseGain Ganho de fase do PLL (0 a 1)
+     * @param periodGain Ganho de período do PLL (0 a 1)
+     */
+    void configure(double frameRateHz, int64_t leadMicros, double phaseGain = 0.25, double periodGain = 0.05);
+
+    /**
+     * @brief Define o evento sinalizado quando o agendador fica ativo
+     *
+     * A thread de saída em modo imediato dorme sem prazo; ao ficar ativo o
+     * agendador passa a decidir os envios e precisa acordá-la.
+     *
+     * @param event Evento a sinalizar (nullptr = nenhum; não assume a posse)
+     */
+    void setActivationEvent(HANDLE event);
+
+    /**
+     * @brief Registra o instante de uma leitura observada do jogo
+     * @param timestampMicros Instante da observação
+     */
+    void observePoll(int64_t timestampMicros);
+
+    /**
+     * @brief Usa o instante das notificações do driver como observação
+     * @param event Notificação recebida
+     */
+    void onFeedback(const FeedbackEvent& event) override;
+
+    /**
+     * @brief Indica se há estimativa de período para agendar envios
+     * @return true se o agendador está ativo
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Indica se a fase está travada (erros recentes pequenos)
+     * @return true se travado
+     */
+    bool isLocked() const;
+
+    /**
+     * @brief Calcula o instante do próximo envio
+     * @param nowMicros Instante atual
+     * @return Instante do próximo envio (sempre depois de nowMicros)
+     */
+    int64_t nextSubmitMicros(int64_t nowMicros) const;
+
+    /**
+     * @brief Obtém o período estimado da leitura do jogo
+     * @return Período em microssegundos (0 se inativo)
+     */
+    double getPeriodMicros() const;
+
+    /**
+     * @brief Obtém o último erro de fase observado
+     * @return Erro em microssegundos (positivo = leitura depois do previsto)
+     */
+    double getPhaseErrorMicros() const;
+
+private:
+    struct State {
+        int64_t anchorMicros;   // Instante de uma leitura prevista
+        double periodMicros;    // Período estimado
+        double phaseError;      // Último erro de fase
+        bool locked;
+    };
+
+    static const int LOCK_COUNT = 8;
+
+    Clock* m_clock;
+    SeqLock<State> m_state;
+    std::atomic<bool> m_active;
+
+    // Estado do PLL (apenas na thread de observação)
+    State m_work;
+    bool m_hasObservation;
+    double m_nominalPeriod;
+    double m_minPeriod;
+    double m_maxPeriod;
+    int64_t m_leadMicros;
+    double m_phaseGain;
+    double m_periodGain;
+    int m_goodCount;
+    std::atomic<HANDLE> m_activationEvent;
+
+    /**
+     * @brief Marca o agendador como ativo e sinaliza o evento de ativação
+     */
+    void activate();
+};
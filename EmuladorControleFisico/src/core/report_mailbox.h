@@ -0,0 +1,72 @@
+/**
+ * @file report_mailbox.h
+ * @brief Caixa de mensagens de valor mais recente, sem bloqueio (buffer triplo)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class LatestValueMailbox
+ * @brief Entrega sempre o valor mais recente de um produtor para um consumidor
+ *
+ * Implementada como buffer triplo: o produtor escreve no seu buffer e troca-o
+ * atomicamente pelo do meio; o consumidor troca o seu pelo do meio quando há
+ * valor novo. Nenhum dos lados espera pelo outro e valores intermediários são
+ * descartados. Uso restrito a um único produtor e um único consumidor.
+ */
+template <typename T>
+class LatestValueMailbox {
+public:
+    LatestValueMailbox()
+        : m_middle(1), m_back(0), m_front(2) {
+    }
+
+    /**
+     * @brief Publica um novo valor (apenas na thread produtora; nunca bloqueia)
+     * @param value Valor a publicar
+     */
+    void publish(const T& value) {
+        m_slots[m_back] = value;
+        const uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_back | FRESH_BIT), std::memory_order_acq_rel);
+        m_back = previous & INDEX_MASK;
+    }
+
+    /**
+     * @brief Obtém o valor mais recente, se houver um novo (apenas na thread consumidora)
+     * @param value Recebe o valor
+     * @return true se havia valor novo desde o último consumo, false caso contrário
+     */
+    bool consume(T& value) {
+        if (!hasPending()) {
+            return false;
+        }
+        const uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & INDEX_MASK;
+        value = m_slots[m_front];
+        return true;
+    }
+
+    /**
+     * @brief Verifica se há valor novo não consumido
+     * @return true se houver valor pendente
+     */
+    bool hasPending() const {
+        return (m_middle.load(std::memory_order_acquire) & FRESH_BIT) != 0;
+    }
+
+private:
+    enum : uint8_t {
+        INDEX_MASK = 0x3,
+        FRESH_BIT = 0x4
+    };
+
+    T m_slots[3];
+
+    // Separados em linhas de cache distintas para evitar falso compartilhamento
+    alignas(64) std::atomic<uint8_t> m_middle;
+    alignas(64) uint8_t m_back;   // Usado apenas pelo produtor
+    alignas(64) uint8_t m_front;  // Usado apenas pelo consumidor
+};
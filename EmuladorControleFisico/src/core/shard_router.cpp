@@ -0,0 +1,196 @@
+/**
+ * @file shard_router.cpp
+ * @brief Implementação da distribuição de dispositivos entre shards
+ */
+
+#include "shard_router.h"
+#include "../utils/config_manager.h"
+#include "../utils/logger.h"
+#include "../utils/pipeline_counters.h"
+#include "../utils/trace_recorder.h"
+#include <sstream>
+
+ShardRouter::ShardRouter(InterceptionManager* interceptManager)
+    : m_interceptManager(interceptManager), m_defaultShard(0), m_workerTuning("shard"),
+      m_running(false), m_threaded(false) {
+    for (int device = 0; device < DEVICE_COUNT; ++device) {
+        m_routes[device] = NO_SHARD;
+    }
+}
+
+ShardRouter::~ShardRouter() {
+    stop();
+
+    for (auto& shard : m_shards) {
+        if (shard->wakeEvent) {
+            CloseHandle(shard->wakeEvent);
+        }
+    }
+}
+
+int ShardRouter::addShard(InputPipeline* pipeline) {
+    if (!pipeline || m_running || static_cast<int>(m_shards.size()) >= MAX_SHARDS) {
+        return NO_SHARD;
+    }
+
+    m_shards.emplace_back(new Shard(pipeline));
+    return static_cast<int>(m_shards.size()) - 1;
+}
+
+bool ShardRouter::assignDevice(InterceptionDevice device, int shard) {
+    if (device < 1 || device >= DEVICE_COUNT) {
+        Logger::warning("Dispositivo inválido no roteamento: " + std::to_string(device));
+        return false;
+    }
+    if (shard != NO_SHARD && (shard < 0 || shard >= static_cast<int>(m_shards.size()))) {
+        Logger::warning("Shard inválido no roteamento: " + std::to_string(shard));
+        return false;
+    }
+
+    m_routes[device] = shard;
+    return true;
+}
+
+void ShardRouter::setDefaultShard(int shard) {
+    m_defaultShard = (shard >= 0 && shard < static_cast<int>(m_shards.size())) ? shard : NO_SHARD;
+}
+
+void ShardRouter::loadRoutesFromConfig(const ConfigManager* config) {
+    for (int shard = 0; shard < static_cast<int>(m_shards.size()); ++shard) {
+        std::stringstream devices(config->getStringValue("shard_" + std::to_string(shard) + "_devices"));
+        std::string item;
+        while (std::getline(devices, item, ',')) {
+            if (item.empty()) {
+                continue;
+            }
+            try {
+                assignDevice(std::stoi(item), shard);
+            } catch (...) {
+                Logger::warning("Dispositivo inválido no roteamento: " + item);
+            }
+        }
+    }
+}
+
+void ShardRouter::setWorkerTuning(const ThreadTuning& tuning) {
+    m_workerTuning = tuning;
+}
+
+bool ShardRouter::start() {
+    if (m_running) {
+        return true;
+    }
+
+    m_running = true;
+    m_threaded = m_shards.size() > 1;
+    if (!m_threaded) {
+        return true;
+    }
+
+    for (size_t i = 0; i < m_shards.size(); ++i) {
+        Shard& shard = *m_shards[i];
+        shard.wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!shard.wakeEvent) {
+            Logger::error("Falha ao criar evento do shard: " + std::to_string(GetLastError()));
+            stop();
+            return false;
+        }
+        shard.thread = std::thread(&ShardRouter::shardLoop, this, static_cast<int>(i));
+    }
+
+    Logger::info("Processamento dividido em " + std::to_string(m_shards.size()) + " shards");
+    return true;
+}
+
+void ShardRouter::stop() {
+    m_running = false;
+
+    for (auto& shard : m_shards) {
+        if (shard->thread.joinable()) {
+            SetEvent(shard->wakeEvent);
+            shard->thread.join();
+        }
+    }
+}
+
+void ShardRouter::dispatch(const InputEvent& event) {
+    TRACE_INSTANT("stroke", event.deviceId);
+    PipelineCounters::increment(event.type == InputEvent::TYPE_KEYBOARD ? COUNTER_KEYBOARD_STROKES : COUNTER_MOUSE_STROKES);
+
+    int index = NO_SHARD;
+    if (event.deviceId >= 1 && event.deviceId < DEVICE_COUNT) {
+        index = m_routes[event.deviceId];
+    }
+    if (index == NO_SHARD) {
+        index = m_defaultShard;
+    }
+
+    // Dispositivo que nenhum shard atende: devolver ao sistema sem mapear
+    if (index == NO_SHARD || index >= static_cast<int>(m_shards.size())) {
+        m_interceptManager->passEventThrough(event);
+        PipelineCounters::increment(COUNTER_PASSED_THROUGH);
+        return;
+    }
+
+    Shard& shard = *m_shards[index];
+    shard.events.fetch_add(1, std::memory_order_relaxed);
+
+    if (!m_threaded) {
+        shard.pipeline->push(event);
+        return;
+    }
+
+    // Com a fila cheia, esperar em vez de perder o evento
+    if (!shard.queue.tryPush(event)) {
+        shard.backpressureWaits.fetch_add(1, std::memory_order_relaxed);
+        PipelineCounters::increment(COUNTER_QUEUE_OVERFLOWS);
+        while (!shard.queue.tryPush(event)) {
+            if (!m_running) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+    SetEvent(shard.wakeEvent);
+}
+
+int ShardRouter::getShardCount() const {
+    return static_cast<int>(m_shards.size());
+}
+
+uint64_t ShardRouter::getEventCount(int shard) const {
+    if (shard < 0 || shard >= static_cast<int>(m_shards.size())) {
+        return 0;
+    }
+    return m_shards[shard]->events.load(std::memory_order_relaxed);
+}
+
+size_t ShardRouter::getQueueDepth(int shard) const {
+    if (shard < 0 || shard >= static_cast<int>(m_shards.size())) {
+        return 0;
+    }
+    return m_shards[shard]->queue.size();
+}
+
+void ShardRouter::shardLoop(int index) {
+    // Cópia por thread: o registro MMCSS pertence à thread que o fez
+    ThreadTuning tuning = m_workerTuning;
+    tuning.apply();
+
+    Shard& shard = *m_shards[index];
+    InputEvent event;
+
+    while (m_running) {
+        while (shard.queue.tryPop(event)) {
+            shard.pipeline->push(event);
+        }
+        WaitForSingleObject(shard.wakeEvent, INFINITE);
+    }
+
+    if (shard.backpressureWaits > 0) {
+        Logger::warning("Fila do shard " + std::to_string(index) + " cheia " +
+                        std::to_string(shard.backpressureWaits.load()) + " vezes");
+    }
+
+    tuning.revert();
+}
@@ -0,0 +1,153 @@
+/**
+ * @file shard_router.h
+ * @brief Distribuição dos dispositivos de entrada entre threads de processamento
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include "input_pipeline.h"
+#include "interception_manager.h"
+#include "../utils/spsc_queue.h"
+#include "../utils/thread_tuning.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ConfigManager;
+
+/**
+ * @class ShardRouter
+ * @brief Encaminha cada dispositivo ao shard (pipeline + controle virtual) que o atende
+ *
+ * A captura continua em uma única thread, que apenas consulta a tabela de
+ * roteamento e coloca o evento na fila SPSC do shard. Cada shard tem sua
+ * própria thread, que roda o pipeline de mapeamento e saída do seu controle
+ * virtual; shards não compartilham estado.
+ *
+ * Com um único shard não há threads nem filas: o evento segue direto para o
+ * pipeline na thread de captura, como antes.
+ */
+class ShardRouter {
+public:
+    static const int MAX_SHARDS = 4;
+    static const int NO_SHARD = -1;
+
+    /**
+     * @brief Construtor
+     * @param interceptManager Usado para repassar eventos de dispositivos sem shard
+     */
+    explicit ShardRouter(InterceptionManager* interceptManager);
+
+    /**
+     * @brief Destrutor (encerra as threads dos shards)
+     */
+    ~ShardRouter();
+
+    /**
+     * @brief Adiciona um shard
+     * @param pipeline Pipeline que processa os eventos do shard (não assume a posse)
+     * @return Índice do shard, ou NO_SHARD se o limite foi atingido
+     */
+    int addShard(InputPipeline* pipeline);
+
+    /**
+     * @brief Associa um dispositivo a um shard
+     * @param device Dispositivo Interception (1-10 teclados, 11-20 mouses)
+     * @param shard Índice do shard (NO_SHARD = repassar sem processar)
+     * @return true se associado, false se dispositivo ou shard inválido
+     */
+    bool assignDevice(InterceptionDevice device, int shard);
+
+    /**
+     * @brief Define o shard dos dispositivos sem associação explícita
+     * @param shard Índice do shard (NO_SHARD = repassar sem processar)
+     */
+    void setDefaultShard(int shard);
+
+    /**
+     * @brief Lê as associações "shard_<n>_devices" (ex.: "1,11") da configuração
+     * @param config Gerenciador de configuração
+     */
+    void loadRoutesFromConfig(const ConfigManager* config);
+
+    /**
+     * @brief Define prioridade e afinidade das threads dos shards
+     * @param tuning Configuração aplicada a cada thread de shard
+     */
+    void setWorkerTuning(const ThreadTuning& tuning);
+
+    /**
+     * @brief Inicia as threads dos shards (somente com mais de um shard)
+     * @return true se iniciado com sucesso, false caso contrário
+     */
+    bool start();
+
+    /**
+     * @brief Encerra as threads dos shards
+     */
+    void stop();
+
+    /**
+     * @brief Encaminha um evento capturado (apenas na thread de captura)
+     * @param event Evento de entrada
+     */
+    void dispatch(const InputEvent& event);
+
+    /**
+     * @brief Obtém o número de shards
+     * @return Total de shards
+     */
+    int getShardCount() const;
+
+    /**
+     * @brief Obtém o número de eventos encaminhados a um shard
+     * @param shard Índice do shard
+     * @return Total de eventos
+     */
+    uint64_t getEventCount(int shard) const;
+
+    /**
+     * @brief Obtém o número de eventos aguardando na fila de um shard
+     * @param shard Índice do shard
+     * @return Eventos na fila (0 com um único shard, que não usa fila)
+     */
+    size_t getQueueDepth(int shard) const;
+
+private:
+    static const size_t QUEUE_CAPACITY = 1024;
+    static const int DEVICE_COUNT = INTERCEPTION_MAX_KEYBOARD + INTERCEPTION_MAX_MOUSE + 1;
+
+    /**
+     * @struct Shard
+     * @brief Fila, thread e contadores de um shard
+     */
+    struct Shard {
+        InputPipeline* pipeline;
+        SpscQueue<InputEvent, QUEUE_CAPACITY> queue;
+        HANDLE wakeEvent;
+        std::thread thread;
+        std::atomic<uint64_t> events;
+        std::atomic<uint64_t> backpressureWaits;
+
+        explicit Shard(InputPipeline* p)
+            : pipeline(p), wakeEvent(nullptr), events(0), backpressureWaits(0) {}
+    };
+
+    InterceptionManager* m_interceptManager;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    int m_routes[DEVICE_COUNT];
+    int m_defaultShard;
+    ThreadTuning m_workerTuning;
+    std::atomic<bool> m_running;
+    bool m_threaded;
+
+    /**
+     * @brief Laço da thread de um shard
+     * @param index Índice do shard
+     */
+    void shardLoop(int index);
+};
@@ -0,0 +1,208 @@
+/**
+ * @file virtual_bus.cpp
+ * @brief Implementação do barramento ViGEm compartilhado
+ */
+
+#include "virtual_bus.h"
+#include "feedback_channel.h"
+#include "../utils/logger.h"
+
+// ViGEmBus
+
+ViGEmBus::ViGEmBus()
+    : m_client(nullptr) {
+    for (int i = 0; i < MAX_TARGETS; ++i) {
+        m_targets[i] = nullptr;
+        m_types[i] = OUTPUT_TARGET_X360;
+    }
+}
+
+ViGEmBus::~ViGEmBus() {
+    disconnect();
+}
+
+bool ViGEmBus::connect() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_client) {
+        return true;
+    }
+
+    m_client = vigem_alloc();
+    if (!m_client) {
+        Logger::error("Falha ao alocar cliente ViGEm");
+        return false;
+    }
+
+    const VIGEM_ERROR connectResult = vigem_connect(m_client);
+    if (!VIGEM_SUCCESS(connectResult)) {
+        vigem_free(m_client);
+        m_client = nullptr;
+
+        Logger::error("Falha ao conectar ao driver ViGEm: " + std::to_string(connectResult));
+        return false;
+    }
+
+    Logger::info("Conectado ao driver ViGEm (cliente compartilhado)");
+    return true;
+}
+
+void ViGEmBus::disconnect() {
+    for (int i = 0; i < MAX_TARGETS; ++i) {
+        removeTarget(i);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_client) {
+        vigem_disconnect(m_client);
+        vigem_free(m_client);
+        m_client = nullptr;
+        Logger::info("Cliente ViGEm desconectado e liberado");
+    }
+}
+
+bool ViGEmBus::addTarget(int index, OutputTargetType type) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_client || index < 0 || index >= MAX_TARGETS) {
+        return false;
+    }
+
+    if (m_targets[index]) {
+        return m_types[index] == type;
+    }
+
+    const char* typeName = (type == OUTPUT_TARGET_DS4) ? OutputTarget<OUTPUT_TARGET_DS4>::getName()
+                                                       : OutputTarget<OUTPUT_TARGET_X360>::getName();
+    PVIGEM_TARGET target = (type == OUTPUT_TARGET_DS4) ? OutputTarget<OUTPUT_TARGET_DS4>::alloc()
+                                                       : OutputTarget<OUTPUT_TARGET_X360>::alloc();
+    if (!target) {
+        Logger::error(std::string("Falha ao alocar controle virtual ") + typeName + " " + std::to_string(index));
+        return false;
+    }
+
+    const VIGEM_ERROR addResult = vigem_target_add(m_client, target);
+    if (!VIGEM_SUCCESS(addResult)) {
+        vigem_target_free(target);
+        Logger::error("Falha ao adicionar controle virtual " + std::to_string(index) + ": " +
+                      std::to_string(addResult));
+        return false;
+    }
+
+    m_targets[index] = target;
+    m_types[index] = type;
+    Logger::info(std::string("Controle virtual ") + typeName + " " + std::to_string(index) + " conectado");
+    return true;
+}
+
+void ViGEmBus::removeTarget(int index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index < 0 || index >= MAX_TARGETS || !m_targets[index]) {
+        return;
+    }
+
+    vigem_target_remove(m_client, m_targets[index]);
+    vigem_target_free(m_targets[index]);
+    m_targets[index] = nullptr;
+    Logger::info("Controle virtual " + std::to_string(index) + " desconectado");
+}
+
+bool ViGEmBus::update(int index, const XUSB_REPORT& report) {
+    // Sem trava: o índice só é alterado pela mesma thread que o atualiza
+    if (index < 0 || index >= MAX_TARGETS || !m_targets[index]) {
+        return false;
+    }
+
+    // Sem log aqui: durante um travamento cada envio falharia; o controle
+    // registra a transição para o modo degradado uma única vez
+    const VIGEM_ERROR updateResult = (m_types[index] == OUTPUT_TARGET_DS4)
+        ? submitToTarget<OUTPUT_TARGET_DS4>(m_client, m_targets[index], report)
+        : submitToTarget<OUTPUT_TARGET_X360>(m_client, m_targets[index], report);
+    return VIGEM_SUCCESS(updateResult);
+}
+
+bool ViGEmBus::attachFeedback(int index, FeedbackChannel* feedbackChannel) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!feedbackChannel || index < 0 || index >= MAX_TARGETS || !m_targets[index]) {
+        return false;
+    }
+
+    return feedbackChannel->attach(m_client, m_targets[index], m_types[index]);
+}
+
+std::string ViGEmBus::getName() const {
+    return "ViGEm";
+}
+
+// BusOutputSink
+
+BusOutputSink::BusOutputSink(VirtualBus* bus, int index, OutputTargetType type)
+    : m_bus(bus), m_index(index), m_type(type), m_open(false), m_feedback(nullptr) {
+}
+
+BusOutputSink::~BusOutputSink() {
+    close();
+}
+
+bool BusOutputSink::open() {
+    if (!m_bus->connect() || !m_bus->addTarget(m_index, m_type)) {
+        return false;
+    }
+
+    m_open = true;
+    return true;
+}
+
+void BusOutputSink::close() {
+    // Parar as notificações antes de remover o controle
+    if (m_feedback) {
+        m_feedback->detach();
+        m_feedback = nullptr;
+    }
+
+    if (m_open) {
+        m_bus->removeTarget(m_index);
+        m_open = false;
+    }
+}
+
+bool BusOutputSink::submit(const XUSB_REPORT& report, int64_t timestampMicros) {
+    return m_open && m_bus->update(m_index, report);
+}
+
+std::string BusOutputSink::getName() const {
+    const char* typeName = (m_type == OUTPUT_TARGET_DS4) ? OutputTarget<OUTPUT_TARGET_DS4>::getName()
+                                                         : OutputTarget<OUTPUT_TARGET_X360>::getName();
+    return std::string(typeName) + " " + std::to_string(m_index) + " (" + m_bus->getName() + ")";
+}
+
+OutputTargetType BusOutputSink::getTargetType() const {
+    return m_type;
+}
+
+bool BusOutputSink::recover() {
+    // Recolocar apenas este controle; os demais continuam no mesmo cliente
+    FeedbackChannel* feedback = m_feedback;
+    close();
+
+    if (!open()) {
+        return false;
+    }
+
+    if (feedback) {
+        attachFeedback(feedback);
+    }
+    return true;
+}
+
+bool BusOutputSink::attachFeedback(FeedbackChannel* feedbackChannel) {
+    if (m_feedback) {
+        m_feedback->detach();
+        m_feedback = nullptr;
+    }
+
+    if (!feedbackChannel || !m_open || !m_bus->attachFeedback(m_index, feedbackChannel)) {
+        return false;
+    }
+
+    m_feedback = feedbackChannel;
+    return true;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file virtual_bus.h
+ * @brief Barramento de controles virtuais compartilhado por vários controles
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include "../lib/ViGEm/Client.h"
+#include "output_sink.h"
+#include "output_target.h"
+#include <mutex>
+#include <string>
+
+class FeedbackChannel;
+
+/**
+ * @class VirtualBus
+ * @brief Barramento ao qual controles virtuais são conectados, um por índice
+ *
+ * Todos os controles usam a mesma conexão com o driver. Permite que vários
+ * controles sejam exercitados com um barramento simulado, sem o driver
+ * instalado.
+ *
+ * Conexão, adição e remoção podem ser chamadas de qualquer thread; cada
+ * índice é atualizado por uma única thread (a de saída do seu controle).
+ */
+class VirtualBus {
+public:
+    static const int MAX_TARGETS = 4;
+
+    virtual ~VirtualBus() {}
+
+    /**
+     * @brief Conecta ao barramento, se ainda não estiver conectado
+     * @return true se conectado com sucesso, false caso contrário
+     */
+    virtual bool connect() = 0;
+
+    /**
+     * @brief Remove todos os controles e desconecta do barramento
+     */
+    virtual void disconnect() = 0;
+
+    /**
+     * @brief Conecta um controle do tipo informado no índice
+     * @param index Índice do controle (0 a MAX_TARGETS-1)
+     * @param type Tipo de controle
+     * @return true se conectado com sucesso, false caso contrário
+     */
+    virtual bool addTarget(int index, OutputTargetType type) = 0;
+
+    /**
+     * @brief Desconecta o controle do índice informado
+     * @param index Índice do controle
+     */
+    virtual void removeTarget(int index) = 0;
+
+    /**
+     * @brief Traduz o estado para o tipo do controle e o envia ao barramento
+     * @param index Índice do controle
+     * @param report Estado interno a enviar
+     * @return true se enviado com sucesso, false caso contrário
+     */
+    virtual bool update(int index, const XUSB_REPORT& report) = 0;
+
+    /**
+     * @brief Registra um canal de retorno de vibração/LED para o controle do índice
+     * @param index Índice do controle
+     * @param feedbackChannel Canal de retorno (não assume a posse)
+     * @return true se registrado, false se não suportado ou em caso de falha
+     */
+    virtual bool attachFeedback(int index, FeedbackChannel* feedbackChannel) {
+        return false;
+    }
+
+    /**
+     * @brief Obtém o nome do barramento para log
+     * @return Nome do barramento
+     */
+    virtual std::string getName() const = 0;
+};
+
+/**
+ * @class ViGEmBus
+ * @brief Barramento ViGEm: um único cliente compartilhado por todos os controles
+ */
+class ViGEmBus : public VirtualBus {
+public:
+    ViGEmBus();
+    ~ViGEmBus();
+
+    bool connect() override;
+    void disconnect() override;
+    bool addTarget(int index, OutputTargetType type) override;
+    void removeTarget(int index) override;
+    bool update(int index, const XUSB_REPORT& report) override;
+    bool attachFeedback(int index, FeedbackChannel* feedbackChannel) override;
+    std::string getName() const override;
+
+private:
+    std::mutex m_mutex;
+    PVIGEM_CLIENT m_client;
+    PVIGEM_TARGET m_targets[MAX_TARGETS];
+    OutputTargetType m_types[MAX_TARGETS];
+};
+
+/**
+ * @class BusOutputSink
+ * @brief Destino que envia os relatórios a um índice de um barramento compartilhado
+ *
+ * Abrir conecta o barramento (uma vez para todos os controles) e adiciona o
+ * controle do índice; fechar remove apenas esse controle.
+ */
+class BusOutputSink : public OutputSink {
+public:
+    /**
+     * @brief Construtor
+     * @param bus Barramento compartilhado (não assume a posse)
+     * @param index Índice do controle no barramento
+     * @param type Tipo de controle
+     */
+    BusOutputSink(VirtualBus* bus, int index, OutputTargetType type);
+    ~BusOutputSink();
+
+    bool open() override;
+    void close() override;
+    bool submit(const XUSB_REPORT& report, int64_t timestampMicros) override;
+    std::string getName() const override;
+    OutputTargetType getTargetType() const override;
+    bool recover() override;
+    bool attachFeedback(FeedbackChannel* feedbackChannel) override;
+
+private:
+    VirtualBus* m_bus;
+    int m_index;
+    OutputTargetType m_type;
+    bool m_open;
+    FeedbackChannel* m_feedback;
+};
@@ -1,15 +1,26 @@
 
 /**
  * @file virtual_controller.cpp
- * @brief Implementação do controle virtual usando ViGEm
+ * @brief Implementação do controle virtual
  */
 
 #include "virtual_controller.h"
+#include "input_fusion.h"
+#include "poll_phase_scheduler.h"
+#include "../utils/latency_histogram.h"
 #include "../utils/logger.h"
+#include "../utils/pipeline_counters.h"
+#include "../utils/trace_recorder.h"
+#include <algorithm>
 #include <stdexcept>
 
-VirtualController::VirtualController() 
-    : m_client(nullptr), m_target(nullptr), m_initialized(false), m_connected(false) {
+VirtualController::VirtualController(Clock* clock) 
+    : m_sink(nullptr), m_targetType(OUTPUT_TARGET_X360), m_initialized(false), m_connected(false),
+      m_fusion(nullptr), m_scheduler(nullptr), m_clock(clock ? clock : Clock::getDefault()), m_lastSubmitMicros(0),
+      m_wakeEvent(nullptr), m_outputRateHz(0), m_immediateButtons(true), m_outputRunning(false),
+      m_manualOutput(false), m_outputTuning("output"),
+      m_hasSubmitted(false), m_retryPending(false), m_pendingTap(0), m_lastSubmitFailed(false),
+      m_submitCount(0), m_suppressedSubmits(0) {
     // Inicializar estrutura de relatório com valores padrão
     ZeroMemory(&m_report, sizeof(XUSB_REPORT));
     
@@ -25,76 +36,108 @@ VirtualController::VirtualController()
     
     // Nenhum botão pressionado
     m_report.wButtons = 0;
+    
+    ZeroMemory(m_pressCounts, sizeof(m_pressCounts));
+    ZeroMemory(&m_latest, sizeof(OutputFrame));
+    ZeroMemory(&m_lastSubmitted, sizeof(XUSB_REPORT));
 }
 
 VirtualController::~VirtualController() {
-    if (m_connected && m_target) {
-        vigem_target_remove(m_client, m_target);
-        Logger::info("Controle virtual desconectado");
+    stopOutputThread();
+    
+    PollPhaseScheduler* scheduler = m_scheduler;
+    if (scheduler) {
+        scheduler->setActivationEvent(nullptr);
+    }
+    
+    if (m_initialized) {
+        Logger::info("Relatórios enviados: " + std::to_string(getSubmitCount()) +
+                     ", suprimidos sem mudança: " + std::to_string(getSuppressedSubmitCount()));
+        
+        const TickStats ticks = m_ticks.getStats();
+        if (ticks.ticks > 0) {
+            Logger::info("Ticks de saída: " + std::to_string(ticks.ticks) + " a " +
+                         std::to_string(static_cast<int>(ticks.achievedRateHz)) + " Hz, atraso médio " +
+                         std::to_string(static_cast<int>(ticks.meanJitterMicros)) + " us, p99 " +
+                         std::to_string(ticks.p99JitterMicros) + " us, máximo " +
+                         std::to_string(ticks.maxJitterMicros) + " us");
+        }
+        
+        const OutputHealthMetrics health = m_health.getMetrics();
+        if (health.failedSubmits > 0 || health.stallEvents > 0) {
+            Logger::info("Saúde do destino: " + std::to_string(health.failedSubmits) + " falhas, " +
+                         std::to_string(health.slowSubmits) + " lentos, " +
+                         std::to_string(health.stallEvents) + " travamentos, " +
+                         std::to_string(health.recoveryEvents) + " recuperações, pior latência " +
+                         std::to_string(health.maxLatencyMicros) + " us");
+        }
     }
     
-    if (m_target) {
-        vigem_target_free(m_target);
+    // O destino desconecta o controle e cancela as notificações
+    if (m_sink && m_connected) {
+        m_sink->close();
     }
     
-    if (m_client) {
-        vigem_disconnect(m_client);
-        vigem_free(m_client);
-        Logger::info("Cliente ViGEm desconectado e liberado");
+    if (m_wakeEvent) {
+        CloseHandle(m_wakeEvent);
     }
 }
 
-bool VirtualController::initialize() {
-    // Criar cliente ViGEm
-    m_client = vigem_alloc();
-    if (!m_client) {
-        Logger::error("Falha ao alocar cliente ViGEm");
-        return false;
+void VirtualController::configureHealthMonitor(int64_t stallLatencyMicros, double maxErrorRate, double maxSlowRate,
+                                               int degradedRateHz, int recoveryIntervalMs) {
+    const int64_t degradedInterval = degradedRateHz > 0 ? 1000000 / degradedRateHz : 0;
+    m_health.configure(stallLatencyMicros, maxErrorRate, maxSlowRate, degradedInterval,
+                       static_cast<int64_t>(recoveryIntervalMs) * 1000);
+}
+
+void VirtualController::setOutputThreadTuning(const ThreadTuning& tuning) {
+    m_outputTuning = tuning;
+}
+
+void VirtualController::setManualOutput(bool manual) {
+    m_manualOutput = manual;
+}
+
+void VirtualController::flushOutput(bool tick) {
+    if (!m_manualOutput || !m_initialized) {
+        return;
     }
     
-    // Conectar ao driver ViGEm
-    const VIGEM_ERROR vigemConnectResult = vigem_connect(m_client);
-    if (!VIGEM_SUCCESS(vigemConnectResult)) {
-        vigem_free(m_client);
-        m_client = nullptr;
-        
-        Logger::error("Falha ao conectar ao driver ViGEm: " + std::to_string(vigemConnectResult));
+    drainMailbox(tick);
+    attemptRecovery();
+}
+
+bool VirtualController::initialize(OutputSink* sink) {
+    if (!sink) {
+        Logger::error("Destino de saída do controle virtual não informado");
         return false;
     }
     
-    Logger::info("Conectado ao driver ViGEm");
-    
-    // Alocar controle virtual Xbox 360
-    m_target = vigem_target_x360_alloc();
-    if (!m_target) {
-        vigem_disconnect(m_client);
-        vigem_free(m_client);
-        m_client = nullptr;
-        
-        Logger::error("Falha ao alocar controle virtual Xbox 360");
+    // Evento de despertar da thread de saída (reinício automático)
+    m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_wakeEvent) {
+        Logger::error("Falha ao criar evento da thread de saída: " + std::to_string(GetLastError()));
         return false;
     }
     
-    // Adicionar controle virtual ao bus
-    const VIGEM_ERROR targetAddResult = vigem_target_add(m_client, m_target);
-    if (!VIGEM_SUCCESS(targetAddResult)) {
-        vigem_target_free(m_target);
-        m_target = nullptr;
-        vigem_disconnect(m_client);
-        vigem_free(m_client);
-        m_client = nullptr;
-        
-        Logger::error("Falha ao adicionar controle virtual: " + std::to_string(targetAddResult));
+    // Conectar o destino (driver ViGEm, gravação ou nulo)
+    if (!sink->open()) {
         return false;
     }
     
+    m_sink = sink;
+    m_targetType = sink->getTargetType();
     m_connected = true;
     m_initialized = true;
     
-    Logger::info("Controle virtual Xbox 360 inicializado com sucesso");
+    Logger::info("Controle virtual " + m_sink->getName() + " inicializado com sucesso");
     
-    // Enviar estado inicial
-    submitReport();
+    // Iniciar a thread de saída e enviar o estado inicial
+    if (!m_manualOutput) {
+        m_outputRunning = true;
+        m_outputThread = std::thread(&VirtualController::outputLoop, this);
+    }
+    publishChange(0, true);
     
     return true;
 }
@@ -135,15 +178,17 @@ bool VirtualController::setButton(XUSB_BUTTON button, bool pressed) {
         return false;
     }
     
+    WORD newlyPressed = 0;
     if (pressed) {
         // Ativar bit do botão
+        newlyPressed = static_cast<WORD>(button & ~m_report.wButtons);
         m_report.wButtons |= button;
     } else {
         // Desativar bit do botão
         m_report.wButtons &= ~button;
     }
     
-    return submitReport();
+    return publishChange(newlyPressed, true);
 }
 
 bool VirtualController::setAxis(int axis, SHORT value) {
@@ -176,7 +221,7 @@ bool VirtualController::setAxis(int axis, SHORT value) {
             return false;
     }
     
-    return submitReport();
+    return publishChange(0, false);
 }
 
 bool VirtualController::setTrigger(int trigger, BYTE value) {
@@ -197,20 +242,330 @@ bool VirtualController::setTrigger(int trigger, BYTE value) {
             return false;
     }
     
-    return submitReport();
+    return publishChange(0, false);
+}
+
+void VirtualController::setInputFusion(InputFusion* fusion) {
+    m_fusion = fusion;
+}
+
+bool VirtualController::setFeedbackChannel(FeedbackChannel* feedbackChannel) {
+    if (!m_initialized || !m_connected) {
+        Logger::warning("Tentativa de registrar canal de retorno com controle não inicializado");
+        return false;
+    }
+    
+    // nullptr apenas cancela o registro atual
+    return m_sink->attachFeedback(feedbackChannel) || !feedbackChannel;
+}
+
+void VirtualController::setOutputRate(int rateHz, bool immediateButtons) {
+    m_outputRateHz = std::max(0, rateHz);
+    m_immediateButtons = immediateButtons;
+    
+    // Acordar a thread de saída para que ela adote o novo período
+    if (m_wakeEvent) {
+        SetEvent(m_wakeEvent);
+    }
+    
+    if (m_outputRateHz > 0) {
+        Logger::info("Envio de relatórios a " + std::to_string(m_outputRateHz.load()) + " Hz" +
+                     (immediateButtons ? " (botões imediatos)" : ""));
+    } else {
+        Logger::info("Envio de relatórios imediato a cada ação");
+    }
+}
+
+OutputTargetType VirtualController::getTargetType() const {
+    return m_targetType;
+}
+
+void VirtualController::setPollScheduler(PollPhaseScheduler* scheduler) {
+    PollPhaseScheduler* previous = m_scheduler.exchange(scheduler);
+    if (previous && previous != scheduler) {
+        previous->setActivationEvent(nullptr);
+    }
+
+    
+    // Sem ações novas, só a ativação do agendador tira a thread da espera sem prazo
+    if (scheduler) {
+        scheduler->setActivationEvent(m_wakeEvent);
+    }
+    
+    // Acordar a thread de saída para que ela adote o novo agendamento
+    if (m_wakeEvent) {
+        SetEvent(m_wakeEvent);
+    }
+}
+
+int VirtualController::getOutputRate() const {
+    return m_outputRateHz;
+}
+
+void VirtualController::stopOutputThread() {
+    if (m_outputThread.joinable()) {
+        m_outputRunning = false;
+        SetEvent(m_wakeEvent);
+        m_outputThread.join();
+    }
+}
+
+bool VirtualController::publishChange(WORD pressedButtons, bool buttonChange) {
+    OutputFrame frame;
+    
+    // Contar pressionamentos para que um toque curto sobreviva à coalescência
+    for (int bit = 0; pressedButtons != 0; ++bit, pressedButtons >>= 1) {
+        if (pressedButtons & 1) {
+            ++m_pressCounts[bit];
+        }
+    }
+    
+    frame.report = m_report;
+    memcpy(frame.pressCounts, m_pressCounts, sizeof(m_pressCounts));
+    frame.publishedMicros = m_clock->nowMicros();
+    m_mailbox.publish(frame);
+    
+    // Modo imediato, ou borda de botão com envio imediato habilitado;
+    // caso contrário o próximo tick (fixo ou alinhado) enviará o estado mais recente
+    PollPhaseScheduler* scheduler = m_scheduler;
+    const bool ticking = m_outputRateHz > 0 || (scheduler && scheduler->isActive());
+    if (!ticking || (buttonChange && m_immediateButtons)) {
+        SetEvent(m_wakeEvent);
+    }
+    
+    return true;
+}
+
+void VirtualController::outputLoop() {
+    m_outputTuning.apply();
+    
+    // Timer de alta resolução: prazos com precisão de microssegundos, sem timeBeginPeriod
+    m_ticks.open();
+    bool ticking = false;
+    int64_t nextTick = 0;
+    
+    while (m_outputRunning) {
+        const int rateHz = m_outputRateHz;
+        PollPhaseScheduler* scheduler = m_scheduler;
+        const bool aligned = scheduler && scheduler->isActive();
+        const int64_t now = m_ticks.nowMicros();
+        int64_t deadline = TickSource::NO_DEADLINE;
+        
+        if (rateHz > 0 || aligned) {
+            const int64_t period = 1000000 / std::max(rateHz, 1);
+            
+            if (!ticking) {
+                ticking = true;
+                if (aligned) {
+                    const int64_t clockNow = m_clock->nowMicros();
+                    nextTick = now + (scheduler->nextSubmitMicros(clockNow) - clockNow);
+                } else {
+                    nextTick = now + period;
+                }
+            }
+            
+            if (now >= nextTick) {
+                drainMailbox(true);
+                
+                if (aligned) {
+                    // Próximo envio logo antes da próxima leitura prevista do jogo
+                    const int64_t clockNow = m_clock->nowMicros();
+                    nextTick = now + (scheduler->nextSubmitMicros(clockNow) - clockNow);
+                } else {
+                    nextTick += period;
+                    
+                    // Após um atraso longo, realinhar em vez de disparar ticks em rajada
+                    if (now > nextTick + period) {
+                        nextTick = now + period;
+                    }
+                }
+                continue;
+            }
+            
+            deadline = nextTick;
+        } else {
+            ticking = false;
+        }
+        
+        // Com o destino travado, acordar no intervalo degradado para reenviar o
+        // estado recusado e tentar a reconexão mesmo sem novas ações
+        if (m_retryPending || m_health.isDegraded()) {
+            deadline = std::min(deadline, now + std::max<int64_t>(1000, m_health.getDegradedIntervalMicros()));
+        }
+        
+        // Só o prazo do tick conta no jitter; o de reenvio não é periódico
+        const bool tickDeadline = ticking && deadline == nextTick;
+        
+        // Acordado por ação (modo imediato), borda de botão, mudança de taxa ou encerramento
+        if (!m_ticks.waitUntil(deadline, m_wakeEvent, tickDeadline)) {
+            drainMailbox(false);
+        } else if (m_retryPending) {
+            submitLatest();
+        }
+        
+        attemptRecovery();
+    }
+    
+    m_ticks.close();
+    m_outputTuning.revert();
+}
+
+void VirtualController::drainMailbox(bool tick) {
+    OutputFrame frame;
+    
+    if (!m_mailbox.consume(frame)) {
+        // Fontes de fusão podem mudar sem nenhuma ação local
+        InputFusion* fusion = m_fusion;
+        if (tick && fusion && fusion->hasSources()) {
+            submitLatest();
+        }
+        return;
+    }
+    
+    // Botões pressionados e já soltos desde o último consumo: enviar o
+    // pressionamento antes do estado atual para que o toque não se perca.
+    // Toques ainda não entregues continuam pendentes, a menos que o botão
+    // esteja pressionado de novo (o estado atual já o envia)
+    WORD tapped = m_pendingTap;
+    for (int bit = 0; bit < 16; ++bit) {
+        if (frame.pressCounts[bit] != m_latest.pressCounts[bit]) {
+            tapped |= static_cast<WORD>(1 << bit);
+        }
+    }
+    m_pendingTap = tapped & ~frame.report.wButtons;
+    
+    m_latest = frame;
+    if (submitLatest()) {
+        LatencyRegistry::recordMicros(LATENCY_MAPPED_TO_SUBMITTED, frame.publishedMicros, m_clock->nowMicros());
+    }
+}
+
+void VirtualController::attemptRecovery() {
+    if (!m_health.shouldAttemptRecovery(m_clock->nowMicros())) {
+        return;
+    }
+    
+    Logger::info("Tentando reconectar o controle virtual " + m_sink->getName());
+    if (!m_sink->recover()) {
+        Logger::warning("Reconexão do controle virtual falhou; nova tentativa mais tarde");
+        return;
+    }
+    
+    // O controle recém-adicionado começa neutro: restaurar o estado atual,
+    // sem esperar o intervalo degradado; o sucesso encerra o modo degradado
+    m_health.recordRecovery(m_clock->nowMicros());
+    m_hasSubmitted = false;
+    submitLatest();
+}
+
+bool VirtualController::submitLatest() {
+    if (m_pendingTap) {
+        XUSB_REPORT pressedReport = m_latest.report;
+        pressedReport.wButtons |= m_pendingTap;
+        
+        // Pressionamento recusado (modo degradado ou falha): o toque espera o próximo reenvio
+        if (!submitReport(pressedReport)) {
+            return false;
+        }
+        m_pendingTap = 0;
+    }
+    
+    return submitReport(m_latest.report);
+}
+
+uint64_t VirtualController::getSubmitCount() const {
+    return m_submitCount.load(std::memory_order_relaxed);
 }
 
-bool VirtualController::submitReport() {
+uint64_t VirtualController::getSuppressedSubmitCount() const {
+    return m_suppressedSubmits.load(std::memory_order_relaxed);
+}
+
+bool VirtualController::getSnapshot(ControllerSnapshot& snapshot) const {
+    return m_snapshot.read(snapshot) > 0;
+}
+
+OutputHealthMetrics VirtualController::getHealthMetrics() const {
+    return m_health.getMetrics();
+}
+
+int64_t VirtualController::getLastSubmitMicros() const {
+    return m_lastSubmitMicros;
+}
+
+bool VirtualController::submitReport(const XUSB_REPORT& primary) {
     if (!m_initialized || !m_connected) {
         return false;
     }
     
-    const VIGEM_ERROR updateResult = vigem_target_x360_update(m_client, m_target, m_report);
+    XUSB_REPORT report = primary;
+    
+    // Combinar com fontes secundárias (ex.: gatilhos de um controle real)
+    InputFusion* fusion = m_fusion;
+    if (fusion) {
+        report = fusion->fuse(report);
+    }
+    
+    // Não chamar o driver se o estado é idêntico ao último enviado. Um estado
+    // recusado antes e depois desfeito também não precisa mais ser reenviado
+    if (m_hasSubmitted && memcmp(&report, &m_lastSubmitted, sizeof(XUSB_REPORT)) == 0) {
+        m_retryPending = false;
+        m_lastSubmitFailed = false;
+        m_suppressedSubmits.fetch_add(1, std::memory_order_relaxed);
+        PipelineCounters::increment(COUNTER_SUPPRESSED_REPEATS);
+        return true;
+    }
+    
+    const int64_t now = m_clock->nowMicros();
+    
+    // No modo degradado os envios são limitados; o estado fica pendente
+    if (!m_health.shouldSubmit(now)) {
+        m_retryPending = true;
+        return false;
+    }
+    
+    const uint64_t callStart = LatencyRegistry::nowNanos();
+    bool success;
+    {
+        TRACE_SCOPE("submit");
+        success = m_sink->submit(report, now);
+    }
+    LatencyRegistry::record(LATENCY_SUBMIT_CALL, LatencyRegistry::nowNanos() - callStart);
+    const int64_t end = m_clock->nowMicros();
     
-    if (!VIGEM_SUCCESS(updateResult)) {
-        Logger::error("Falha ao atualizar estado do controle: " + std::to_string(updateResult));
+    if (m_health.recordSubmit(end - now, success, end)) {
+        const OutputHealthMetrics health = m_health.getMetrics();
+        if (health.degraded) {
+            Logger::warning("Destino " + m_sink->getName() + " travado (erros " +
+                            std::to_string(static_cast<int>(health.windowErrorRate * 100)) + "%, lentos " +
+                            std::to_string(static_cast<int>(health.windowSlowRate * 100)) +
+                            "%); envios limitados até a recuperação");
+        } else {
+            Logger::info("Destino " + m_sink->getName() + " recuperado; envios normais retomados");
+        }
+    }
+    
+    m_retryPending = !success;
+    if (!success) {
+        PipelineCounters::increment(COUNTER_SUBMIT_FAILURES);
+        // Registrar apenas a primeira falha de uma sequência para não inundar o log
+        if (!m_lastSubmitFailed) {
+            Logger::error("Falha ao atualizar estado do controle virtual " + m_sink->getName());
+        }
+        m_lastSubmitFailed = true;
         return false;
     }
+    m_lastSubmitFailed = false;
+    
+    m_lastSubmitted = report;
+    m_hasSubmitted = true;
+    m_submitCount.fetch_add(1, std::memory_order_relaxed);
+    PipelineCounters::increment(COUNTER_SUBMITS);
+    m_lastSubmitMicros = now;
     
+    ControllerSnapshot snapshot;
+    snapshot.report = report;
+    snapshot.timestamp = now;
+    m_snapshot.write(snapshot);
     return true;
 }
@@ -8,7 +8,22 @@
 
 #include <Windows.h>
 #include "../lib/ViGEm/Client.h"
+#include "../utils/clock.h"
+#include "../utils/seqlock.h"
+#include "../utils/thread_tuning.h"
+#include "../utils/tick_source.h"
+#include "output_health_monitor.h"
+#include "output_sink.h"
+#include "output_target.h"
+#include "report_mailbox.h"
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <thread>
+
+class FeedbackChannel;
+class InputFusion;
+class PollPhaseScheduler;
 
 /**
  * @struct ControllerAction
@@ -46,16 +61,58 @@ struct ControllerAction {
     }
 };
 
+/**
+ * @struct MappedActions
+ * @brief Ações produzidas por um único evento de entrada
+ *
+ * Um movimento do mouse move até um eixo por mapeamento; os demais eventos
+ * produzem no máximo uma ação.
+ */
+struct MappedActions {
+    static const size_t MAX_ACTIONS = 4;   // Um por eixo do controle
+    
+    ControllerAction actions[MAX_ACTIONS];
+    size_t count;
+    
+    MappedActions() : count(0) {}
+    
+    /**
+     * @brief Acrescenta uma ação (ações vazias e excedentes são ignoradas)
+     * @param action Ação
+     */
+    void add(const ControllerAction& action) {
+        if (action.type != ControllerAction::TYPE_NONE && count < MAX_ACTIONS) {
+            actions[count++] = action;
+        }
+    }
+};
+
+/**
+ * @struct ControllerSnapshot
+ * @brief Estado do controle como aceito pelo destino, com o instante do envio
+ */
+struct ControllerSnapshot {
+    XUSB_REPORT report;  // Relatório enviado (após fusão)
+    int64_t timestamp;   // Instante do envio em microssegundos
+};
+
 /**
  * @class VirtualController
- * @brief Gerencia a emulação de um controle Xbox 360 virtual usando ViGEm
+ * @brief Gerencia a emulação de um controle virtual (Xbox 360 ou DualShock 4)
+ *
+ * As ações alteram o relatório na thread de entrada e o publicam numa caixa
+ * de valor mais recente; uma thread de saída dedicada é a única que escreve
+ * no destino (OutputSink), normalmente o driver ViGEm. Assim a latência do
+ * driver nunca bloqueia o laço de entrada.
+ * As funções de alteração devem ser chamadas por uma única thread.
  */
 class VirtualController {
 public:
     /**
      * @brief Construtor
+     * @param clock Relógio usado para marcar os envios (nullptr = relógio real)
      */
-    VirtualController();
+    VirtualController(Clock* clock = nullptr);
     
     /**
      * @brief Destrutor
@@ -63,13 +120,53 @@ public:
     ~VirtualController();
     
     /**
-     * @brief Inicializa o controle virtual
+     * @brief Configura a detecção de travamento do destino (chamar antes de initialize)
+     * @param stallLatencyMicros Latência a partir da qual um envio é considerado lento
+     * @param maxErrorRate Fração de falhas na janela que ativa o modo degradado
+     * @param maxSlowRate Fração de envios lentos na janela que ativa o modo degradado
+     * @param degradedRateHz Envios por segundo no modo degradado
+     * @param recoveryIntervalMs Intervalo entre tentativas de reconectar o controle
+     */
+    void configureHealthMonitor(int64_t stallLatencyMicros, double maxErrorRate, double maxSlowRate,
+                                int degradedRateHz, int recoveryIntervalMs);
+    
+    /**
+     * @brief Define prioridade e afinidade da thread de saída (chamar antes de initialize)
+     * @param tuning Configuração aplicada quando a thread inicia
+     */
+    void setOutputThreadTuning(const ThreadTuning& tuning);
+    
+    /**
+     * @brief Dispensa a thread de saída: os envios passam a ser feitos por flushOutput (chamar antes de initialize)
+     * 
+     * Usado na reprodução de gravações, em que a sequência de relatórios não
+     * pode depender do escalonamento das threads.
+     * 
+     * @param manual true para enviar apenas em flushOutput
+     */
+    void setManualOutput(bool manual);
+    
+    /**
+     * @brief Envia o estado publicado na thread chamadora (apenas no modo manual)
+     * @param tick true para se comportar como um tick de taxa fixa
+     */
+    void flushOutput(bool tick = false);
+    
+    /**
+     * @brief Inicializa o controle virtual com um destino de saída externo
+     * @param sink Destino dos relatórios (deve sobreviver ao controle; não assume a posse)
      * @return true se inicializado com sucesso, false caso contrário
      */
-    bool initialize();
+    bool initialize(OutputSink* sink);
     
     /**
-     * @brief Aplica uma ação ao controle virtual
+     * @brief Obtém o tipo de controle apresentado ao sistema
+     * @return Tipo de controle
+     */
+    OutputTargetType getTargetType() const;
+    
+    /**
+     * @brief Aplica uma ação ao controle virtual (não bloqueia)
      * @param action Ação a ser aplicada
      * @return true se aplicada com sucesso, false caso contrário
      */
@@ -98,17 +195,174 @@ public:
      * @return true se definido com sucesso, false caso contrário
      */
     bool setTrigger(int trigger, BYTE value);
+    
+    /**
+     * @brief Define o estágio de fusão com fontes secundárias de controle
+     * @param fusion Estágio de fusão (nullptr desativa; não assume a posse)
+     */
+    void setInputFusion(InputFusion* fusion);
+    
+    /**
+     * @brief Registra um canal para receber vibração e LED pedidos pelo jogo
+     * @param feedbackChannel Canal de retorno (deve sobreviver ao controle; não assume a posse)
+     * @return true se registrado com sucesso, false caso contrário
+     */
+    bool setFeedbackChannel(FeedbackChannel* feedbackChannel);
+    
+    /**
+     * @brief Obtém o instante do último envio bem-sucedido ao driver
+     * @return Instante em microssegundos no relógio do controle (0 se nenhum)
+     */
+    int64_t getLastSubmitMicros() const;
+    
+    /**
+     * @brief Obtém uma cópia consistente do último estado enviado
+     * 
+     * Pode ser chamado de qualquer thread, sem bloqueio e sem atrasar a
+     * thread de saída.
+     * 
+     * @param snapshot Recebe o estado e o instante do envio
+     * @return true se algum relatório já foi enviado, false caso contrário
+     */
+    bool getSnapshot(ControllerSnapshot& snapshot) const;
+    
+    /**
+     * @brief Define a taxa de envio de relatórios ao driver
+     * 
+     * Com taxa zero, a thread de saída é acordada a cada ação. Com taxa maior
+     * que zero, ela envia o estado mais recente no máximo uma vez por período,
+     * de modo que o número de chamadas ao driver não depende da taxa de entrada.
+     * 
+     * @param rateHz Envios por segundo (0 = enviar a cada ação)
+     * @param immediateButtons Se true, mudanças de botão são enviadas sem esperar o próximo tick
+     */
+    void setOutputRate(int rateHz, bool immediateButtons = true);
+    
+    /**
+     * @brief Define o agendador que alinha os envios à leitura do jogo
+     * 
+     * Enquanto o agendador estiver ativo, os envios periódicos acontecem logo
+     * antes de cada leitura prevista em vez de na taxa fixa. Chamar depois de
+     * initialize: a ativação do agendador acorda a thread de saída.
+     * 
+     * @param scheduler Agendador (nullptr desativa; não assume a posse)
+     */
+    void setPollScheduler(PollPhaseScheduler* scheduler);
+    
+    /**
+     * @brief Obtém a taxa de envio configurada
+     * @return Envios por segundo (0 = envio imediato)
+     */
+    int getOutputRate() const;
+    
+    /**
+     * @brief Obtém o número de relatórios enviados com sucesso ao driver
+     * @return Total de envios
+     */
+    uint64_t getSubmitCount() const;
+    
+    /**
+     * @brief Obtém o número de envios evitados por o relatório não ter mudado
+     * @return Total de envios suprimidos
+     */
+    uint64_t getSuppressedSubmitCount() const;
+    
+    /**
+     * @brief Obtém as métricas de saúde do destino (travamentos, recuperações, latência)
+     * @return Cópia consistente das métricas
+     */
+    OutputHealthMetrics getHealthMetrics() const;
 
 private:
-    PVIGEM_CLIENT m_client;
-    PVIGEM_TARGET m_target;
-    XUSB_REPORT m_report;
+    /**
+     * @struct OutputFrame
+     * @brief Estado publicado para a thread de saída
+     *
+     * Os contadores de pressionamento permitem à thread de saída detectar um
+     * botão pressionado e solto entre dois consumos e enviá-lo mesmo assim.
+     */
+    struct OutputFrame {
+        XUSB_REPORT report;
+        uint8_t pressCounts[16];  // Pressionamentos por bit de botão (módulo 256)
+        int64_t publishedMicros;  // Instante da alteração mais recente
+    };
+    
+    OutputSink* m_sink;
+    OutputTargetType m_targetType;
+    XUSB_REPORT m_report;  // Estado interno, traduzido para o tipo de controle no envio
     bool m_initialized;
     bool m_connected;
+    std::atomic<InputFusion*> m_fusion;
+    std::atomic<PollPhaseScheduler*> m_scheduler;
+    Clock* m_clock;
+    std::atomic<int64_t> m_lastSubmitMicros;
+    
+    // Relatório de trabalho, alterado apenas pela thread de entrada
+    // e publicado para a thread de saída sem bloqueio
+    LatestValueMailbox<OutputFrame> m_mailbox;
+    uint8_t m_pressCounts[16];
+    HANDLE m_wakeEvent;
+    std::atomic<int> m_outputRateHz;
+    std::atomic<bool> m_immediateButtons;
+    std::atomic<bool> m_outputRunning;
+    bool m_manualOutput;
+    std::thread m_outputThread;
+    ThreadTuning m_outputTuning;
+    TickSource m_ticks;
+    
+    // Estado da thread de saída
+    OutputFrame m_latest;
+    XUSB_REPORT m_lastSubmitted;
+    bool m_hasSubmitted;
+    bool m_retryPending;       // Último estado não chegou ao destino
+    WORD m_pendingTap;         // Toques cujo pressionamento ainda não chegou ao destino
+    bool m_lastSubmitFailed;   // Para registrar apenas a primeira falha de uma sequência
+    OutputHealthMonitor m_health;
+    std::atomic<uint64_t> m_submitCount;
+    std::atomic<uint64_t> m_suppressedSubmits;
+    
+    // Último estado enviado, publicado para leitores de outras threads
+    SeqLock<ControllerSnapshot> m_snapshot;
+    
+    /**
+     * @brief Publica o relatório de trabalho e acorda a thread de saída se necessário
+     * @param pressedButtons Botões que acabaram de ser pressionados
+     * @param buttonChange true se a alteração foi em um botão
+     * @return true sempre (o envio é assíncrono)
+     */
+    bool publishChange(WORD pressedButtons, bool buttonChange);
+    
+    /**
+     * @brief Laço da thread de saída
+     */
+    void outputLoop();
+    
+    /**
+     * @brief Consome o estado mais recente da caixa e o envia ao driver
+     * @param tick true se chamado no tick de taxa fixa
+     */
+    void drainMailbox(bool tick);
+    
+    /**
+     * @brief Encerra a thread de saída, se estiver rodando
+     */
+    void stopOutputThread();
+    
+    /**
+     * @brief Reconecta o destino no modo degradado, se for a hora, e restaura o estado
+     */
+    void attemptRecovery();
+    
+    /**
+     * @brief Envia os toques pendentes e depois o estado mais recente
+     * @return true se o estado mais recente foi enviado, false caso contrário
+     */
+    bool submitLatest();
     
     /**
-     * @brief Submete o relatório atual para o controle virtual
+     * @brief Submete um relatório ao controle virtual (apenas na thread de saída)
+     * @param report Relatório a enviar
      * @return true se enviado com sucesso, false caso contrário
      */
-    bool submitReport();
+    bool submitReport(const XUSB_REPORT& report);
 };
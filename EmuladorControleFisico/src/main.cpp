@@ -10,28 +10,57 @@
 #include <iostream>
 #include <thread>
 #include <atomic>
+#include <algorithm>
+#include <memory>
+#include <vector>
 #include "core/interception_manager.h"
 #include "core/virtual_controller.h"
 #include "core/event_mapper.h"
+#include "core/feedback_channel.h"
+#include "core/input_fusion.h"
+#include "core/input_pipeline.h"
+#include "core/input_recording.h"
+#include "core/output_sink.h"
+#include "core/poll_phase_scheduler.h"
+#include "core/shard_router.h"
+#include "core/virtual_bus.h"
 #include "ui/main_window.h"
+#include "tools/benchmark_suite.h"
+#include "tools/input_replay.h"
+#include "tools/self_test.h"
+#include "tools/stress_generator.h"
+#include "utils/command_line.h"
 #include "utils/config_manager.h"
+#include "utils/latency_histogram.h"
+#include "utils/pipeline_counters.h"
 #include "utils/logger.h"
+#include "utils/thread_tuning.h"
+#include "utils/tick_source.h"
+#include "utils/trace_recorder.h"
 
 // Variável global para controlar o estado de ativação
 std::atomic<bool> g_emulationActive(false);
 
+// Arquivo de log da aplicação
+const char* const LOG_FILENAME = "emulador_controle.log";
+
 /**
  * @brief Thread que processa os eventos de entrada e emula o controle virtual
  * @param interceptManager Gerenciador de interceptação de eventos
- * @param virtualController Controlador virtual
- * @param eventMapper Mapeador de eventos
+ * @param router Encaminha cada evento ao pipeline do shard do dispositivo
+ * @param recorder Gravação dos eventos capturados (nullptr = não gravar)
+ * @param tuning Prioridade e afinidade da thread
+ * @param running Continua enquanto true; verificado ao menos a cada 100 ms
  */
 void processingThread(InterceptionManager* interceptManager, 
-                      VirtualController* virtualController,
-                      EventMapper* eventMapper) {
+                      ShardRouter* router,
+                      InputRecorder* recorder,
+                      ThreadTuning tuning,
+                      const std::atomic<bool>* running) {
     Logger::info("Thread de processamento iniciada");
+    tuning.apply();
 
-    while (true) {
+    while (*running) {
         // Verificar se a emulação está ativa
         if (!g_emulationActive) {
             Sleep(100); // Reduzir uso de CPU quando inativo
@@ -41,40 +70,226 @@ void processingThread(InterceptionManager* interceptManager,
         // Obter evento de entrada do Interception
         InputEvent event = interceptManager->waitForEvent(100); // timeout de 100ms
         
+        // Filtrar, mapear, aplicar e repassar no shard do dispositivo
         if (event.type != InputEvent::TYPE_NONE) {
-            // Mapear evento para ação do controle
-            ControllerAction action = eventMapper->mapEvent(event);
-            
-            // Aplicar ação ao controle virtual
-            if (action.type != ControllerAction::TYPE_NONE) {
-                virtualController->applyAction(action);
-            }
-            
-            // Decidir se o evento original deve continuar para o sistema
-            if (eventMapper->shouldPassThrough(event)) {
-                interceptManager->passEventThrough(event);
+            if (recorder) {
+                recorder->append(event);
             }
+            router->dispatch(event);
+        }
+    }
+
+    Logger::info("Thread de processamento encerrada");
+}
+
+/**
+ * @struct ThreadStopper
+ * @brief Sinaliza a parada de uma thread e espera por ela
+ *
+ * Também age na saída por exceção: declarado depois dos objetos usados pela
+ * thread, é destruído antes deles.
+ */
+struct ThreadStopper {
+    std::atomic<bool>* running;
+    std::thread* thread;
+
+    void stop() {
+        *running = false;
+        if (thread->joinable()) {
+            thread->join();
+        }
+    }
+
+    ~ThreadStopper() {
+        stop();
+    }
+};
+
+/**
+ * @brief Registra os estágios padrão e monta o pipeline de entrada de um controle
+ * @param pipeline Pipeline a montar
+ * @param configManager Gerenciador de configurações
+ * @param eventMapper Mapeador de eventos do controle
+ * @param virtualController Controle virtual que recebe as ações
+ * @param interceptManager Gerenciador de interceptação (repasse ao sistema)
+ */
+void buildInputPipeline(InputPipeline& pipeline, ConfigManager& configManager, EventMapper* eventMapper,
+                        VirtualController* virtualController, InterceptionManager* interceptManager) {
+    pipeline.registerStage(new FilterStage());
+    pipeline.registerStage(new MapStage(eventMapper));
+    pipeline.registerStage(new ApplyStage(virtualController));
+    pipeline.registerStage(new PassThroughStage(interceptManager));
+    pipeline.setWorkerTuning(ThreadTuning::fromConfig(&configManager, "pipeline", ThreadTuning::PRIORITY_HIGHEST));
+    
+    // Ex.: "filter,map|apply,passthrough"; '|' coloca os estágios seguintes em outra thread
+    if (!pipeline.configure(configManager.getStringValue("pipeline_stages", InputPipeline::DEFAULT_SPEC))) {
+        pipeline.configure(InputPipeline::DEFAULT_SPEC);
+    }
+    pipeline.start();
+}
+
+/**
+ * @struct PadOutput
+ * @brief Destinos dos relatórios de um controle: driver (ou nulo) e gravação opcional
+ */
+struct PadOutput {
+    std::unique_ptr<OutputSink> driverSink;
+    std::unique_ptr<OutputSink> recordingSink;
+    
+    /**
+     * @brief Destino entregue ao controle: a gravação, se houver, repassa ao driver
+     */
+    OutputSink* get() const {
+        return recordingSink ? recordingSink.get() : driverSink.get();
+    }
+};
+
+/**
+ * @brief Cria os destinos de um controle: índice do barramento ViGEm compartilhado
+ *        ou nulo (output_sink), opcionalmente gravando cada relatório em arquivo
+ * @param output Destinos criados
+ * @param configManager Gerenciador de configurações
+ * @param bus Barramento compartilhado por todos os controles
+ * @param index Índice do controle (0 = principal); os demais gravam em <arquivo>.<índice>
+ * @param targetType Tipo de controle virtual
+ */
+void createPadOutput(PadOutput& output, ConfigManager& configManager, VirtualBus* bus, int index,
+                     OutputTargetType targetType) {
+    if (configManager.getStringValue("output_sink", "vigem") == "null") {
+        output.driverSink.reset(new NullOutputSink());
+    } else {
+        output.driverSink.reset(new BusOutputSink(bus, index, targetType));
+    }
+    
+    std::string recordFile = configManager.getStringValue("output_record_file");
+    if (!recordFile.empty()) {
+        if (index > 0) {
+            recordFile += "." + std::to_string(index);
         }
+        output.recordingSink.reset(new RecordingOutputSink(recordFile, output.driverSink.get()));
+    }
+}
+
+/**
+ * @brief Configura a thread de saída e a detecção de travamento de um controle,
+ *        inicializa-o com o destino e define a taxa de envio
+ * @param controller Controle virtual
+ * @param configManager Gerenciador de configurações
+ * @param sink Destino dos relatórios
+ * @return true se inicializado com sucesso, false caso contrário
+ */
+bool initializePadController(VirtualController& controller, ConfigManager& configManager, OutputSink* sink) {
+    // Prioridade e núcleos da thread de saída (chaves thread_output_priority/_cores)
+    controller.setOutputThreadTuning(
+        ThreadTuning::fromConfig(&configManager, "output", ThreadTuning::PRIORITY_HIGHEST));
+    
+    // Detecção de travamento do driver: limites da janela, taxa degradada e reconexão
+    controller.configureHealthMonitor(configManager.getIntValue("output_stall_latency_us", 5000),
+                                      configManager.getFloatValue("output_stall_error_rate", 0.25f),
+                                      configManager.getFloatValue("output_stall_slow_rate", 0.5f),
+                                      configManager.getIntValue("output_degraded_rate_hz", 50),
+                                      configManager.getIntValue("output_recovery_interval_ms", 1000));
+    
+    if (!controller.initialize(sink)) {
+        return false;
     }
+    
+    // Taxa de envio ao driver (0 = a cada ação)
+    controller.setOutputRate(configManager.getIntValue("output_rate_hz", 0),
+                             configManager.getBoolValue("output_button_bypass", true));
+    return true;
 }
 
 /**
  * @brief Função que monitora a tecla F8 para ativar/desativar a emulação
+ * @param tuning Prioridade e afinidade da thread
+ * @param traceFile Arquivo gravado ao pressionar F9 (vazio = rastreamento desligado)
  */
-void toggleHotkeyMonitor() {
+void toggleHotkeyMonitor(ThreadTuning tuning, std::string traceFile) {
     Logger::info("Monitor de hotkey iniciado");
+    tuning.apply();
+    
+    // Verificar periodicamente a 20 Hz
+    TickSource ticks(20);
+    ticks.open();
+    bool wasPressed = false;
+    bool wasTracePressed = false;
     
     while (true) {
-        // Verificar se F8 foi pressionado (código 119)
-        if ((GetAsyncKeyState(VK_F8) & 0x8000) != 0) {
+        ticks.waitNextTick();
+        
+        // Verificar se F8 foi pressionado (código 119); só a borda alterna,
+        // para evitar múltiplas ativações com a tecla segurada
+        const bool pressed = (GetAsyncKeyState(VK_F8) & 0x8000) != 0;
+        if (pressed && !wasPressed) {
             g_emulationActive = !g_emulationActive;
             Logger::info(g_emulationActive ? "Emulação ativada" : "Emulação desativada");
-            
-            // Esperar um pouco para evitar múltiplas ativações
-            Sleep(200);
         }
-        Sleep(50); // Verificar periodicamente
+        wasPressed = pressed;
+        
+        // F9 grava os últimos segundos de atividade do pipeline
+        const bool tracePressed = (GetAsyncKeyState(VK_F9) & 0x8000) != 0;
+        if (tracePressed && !wasTracePressed && !traceFile.empty()) {
+            TraceRecorder::writeChromeTrace(traceFile);
+        }
+        wasTracePressed = tracePressed;
+    }
+}
+
+/**
+ * @brief Executa os microbenchmarks (--benchmark) sem driver nem janela
+ * @param commandLine Opções: --filter=<texto>, --benchmark-out=<arquivo>,
+ *                    --baseline=<arquivo> e --tolerance=<porcentagem>
+ * @return 0 se nenhum limite absoluto foi excedido e não houve regressão, 1 caso contrário
+ */
+int runBenchmarks(const CommandLine& commandLine) {
+    BenchmarkSuite suite(LOG_FILENAME);
+    suite.run(commandLine.getValue("--filter"));
+    
+    // Limites absolutos (ex.: custo por evento com 100 regras) valem mesmo sem referência
+    const bool withinBudget = suite.checkBudgets() == 0;
+    
+    if (!suite.writeResults(commandLine.getValue("--benchmark-out", "benchmark_results.json"))) {
+        return 1;
     }
+    
+    const std::string baseline = commandLine.getValue("--baseline");
+    if (baseline.empty()) {
+        return withinBudget ? 0 : 1;
+    }
+    const bool noRegression = suite.compareWithBaseline(baseline, commandLine.getDoubleValue("--tolerance", 10.0)) == 0;
+    return withinBudget && noRegression ? 0 : 1;
+}
+
+/**
+ * @brief Executa o teste de carga sintética (--stress) sem driver nem janela
+ * @param commandLine Opções --stress-* (ver StressOptions)
+ * @return 0 se executado, 1 caso contrário
+ */
+int runStressTest(const CommandLine& commandLine) {
+    StressGenerator generator(StressOptions::fromCommandLine(commandLine));
+    return generator.run() ? 0 : 1;
+}
+
+/**
+ * @brief Reproduz uma gravação de entrada (--replay) sem driver nem janela
+ * @param commandLine Opções: --replay=<arquivo>, --replay-config=<arquivo>, --replay-out=<arquivo>,
+ *                    --replay-golden=<arquivo> e --replay-output-rate=<Hz>
+ * @return 0 se reproduzida (e igual à referência, se informada), 1 caso contrário
+ */
+int runReplay(const CommandLine& commandLine) {
+    InputReplay replay(ReplayOptions::fromCommandLine(commandLine));
+    return replay.run() ? 0 : 1;
+}
+
+/**
+ * @brief Executa as verificações automáticas (--self-test) sem driver nem janela
+ * @param commandLine Opções: --filter=<texto>
+ * @return 0 se todas passaram, 1 caso contrário
+ */
+int runSelfTest(const CommandLine& commandLine) {
+    SelfTest selfTest;
+    return selfTest.run(commandLine.getValue("--filter")) == 0 ? 0 : 1;
 }
 
 /**
@@ -87,14 +302,36 @@ void toggleHotkeyMonitor() {
  */
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
     // Inicializar sistema de log
-    Logger::init("emulador_controle.log");
+    Logger::init(LOG_FILENAME);
     Logger::info("Aplicação iniciada");
     
+    // Modos sem interface
+    const CommandLine commandLine(lpCmdLine ? lpCmdLine : "");
+    if (commandLine.hasFlag("--benchmark")) {
+        return runBenchmarks(commandLine);
+    }
+    if (commandLine.hasFlag("--stress")) {
+        return runStressTest(commandLine);
+    }
+    if (commandLine.hasFlag("--replay")) {
+        return runReplay(commandLine);
+    }
+    if (commandLine.hasFlag("--self-test")) {
+        return runSelfTest(commandLine);
+    }
+    
     try {
         // Carregar configurações
         ConfigManager configManager("config.json");
         Logger::info("Configurações carregadas");
         
+        // Rastreamento opcional do pipeline, exportado com F9 e ao sair
+        std::string traceFile;
+        if (configManager.getBoolValue("trace_enabled", false)) {
+            traceFile = configManager.getStringValue("trace_file", "pipeline_trace.json");
+            TraceRecorder::setEnabled(true);
+        }
+        
         // Inicializar gerenciador de interceptação
         InterceptionManager interceptManager;
         if (!interceptManager.initialize()) {
@@ -108,30 +345,136 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         interceptManager.setKeyboardFilter(INTERCEPTION_FILTER_KEY_ALL);
         interceptManager.setMouseFilter(INTERCEPTION_FILTER_MOUSE_ALL);
         
+        // Canal de retorno de vibração/LED (declarado antes do controle para sobreviver a ele)
+        FeedbackLogListener feedbackLog;
+        PollPhaseScheduler pollScheduler;
+        FeedbackChannel feedbackChannel;
+        
+        // Fusão com um controle real: usada pela thread de saída até o controle ser destruído
+        ReplayGamepadSource replaySource(configManager.getBoolValue("fusion_replay_loop", true));
+        InputFusion inputFusion;
+        
+        // Destino dos relatórios: driver ViGEm do tipo configurado (x360 ou ds4)
+        // ou nulo, opcionalmente gravando cada relatório em arquivo. Todos os
+        // controles compartilham um único cliente ViGEm, um índice por controle
+        const OutputTargetType targetType = parseOutputTargetType(
+            configManager.getStringValue("output_target", "x360"), OUTPUT_TARGET_X360);
+        ViGEmBus vigemBus;
+        PadOutput padOutput;
+        createPadOutput(padOutput, configManager, &vigemBus, 0, targetType);
+        
         // Inicializar controle virtual
         VirtualController virtualController;
-        if (!virtualController.initialize()) {
+        if (!initializePadController(virtualController, configManager, padOutput.get())) {
             MessageBoxA(NULL, "Falha ao inicializar o controle virtual.\nVerifique se o driver ViGEm está instalado corretamente.", 
                       "Erro de Inicialização", MB_ICONERROR);
             return 1;
         }
         Logger::info("Controle virtual inicializado com sucesso");
         
+        // Alinhar os envios à leitura do jogo, estimada pela taxa de quadros
+        // configurada e/ou pelo instante das notificações do driver
+        const bool phaseAlign = configManager.getBoolValue("output_phase_align", false);
+        if (phaseAlign) {
+            pollScheduler.configure(configManager.getFloatValue("consumer_frame_rate", 0.0f),
+                                    configManager.getIntValue("output_phase_lead_us", 1500));
+            virtualController.setPollScheduler(&pollScheduler);
+        }
+        
+        // Receber vibração e LED pedidos pelo jogo
+        if (configManager.getBoolValue("feedback_enabled", true)) {
+            feedbackChannel.addListener(&feedbackLog);
+            if (phaseAlign) {
+                feedbackChannel.addListener(&pollScheduler);
+            }
+            if (feedbackChannel.start()) {
+                virtualController.setFeedbackChannel(&feedbackChannel);
+            }
+        }
+        
+        // Fusão opcional com estados gravados de um controle real
+        const std::string replayFile = configManager.getStringValue("fusion_replay_file");
+        if (!replayFile.empty() && replaySource.load(replayFile)) {
+            inputFusion.loadRulesFromConfig(&configManager);
+            inputFusion.addSource(&replaySource, configManager.getIntValue("fusion_replay_priority", 1));
+            virtualController.setInputFusion(&inputFusion);
+        }
+        
         // Inicializar mapeador de eventos
         EventMapper eventMapper(&configManager);
         Logger::info("Mapeador de eventos inicializado");
         
-        // Iniciar thread de processamento de eventos
-        std::thread procThread(processingThread, &interceptManager, &virtualController, &eventMapper);
-        procThread.detach(); // Desacoplar thread
+        // Montar o pipeline de entrada do controle principal
+        InputPipeline inputPipeline;
+        buildInputPipeline(inputPipeline, configManager, &eventMapper, &virtualController, &interceptManager);
+        
+        // Controles adicionais (shards): cada um com mapeador, controle virtual,
+        // pipeline e thread próprios, atendendo os dispositivos de shard_<n>_devices.
+        // Destino e thread de saída montados como os do controle principal
+        const int shardCount = std::max(1, std::min(ShardRouter::MAX_SHARDS, configManager.getIntValue("shard_count", 1)));
+        std::vector<std::unique_ptr<PadOutput>> shardOutputs;
+        std::vector<std::unique_ptr<VirtualController>> shardControllers;
+        std::vector<std::unique_ptr<EventMapper>> shardMappers;
+        std::vector<std::unique_ptr<InputPipeline>> shardPipelines;
+        ShardRouter shardRouter(&interceptManager);
+        shardRouter.addShard(&inputPipeline);
+        
+        for (int shard = 1; shard < shardCount; ++shard) {
+            std::unique_ptr<PadOutput> output(new PadOutput());
+            createPadOutput(*output, configManager, &vigemBus, shard, targetType);
+            std::unique_ptr<VirtualController> controller(new VirtualController());
+            if (!initializePadController(*controller, configManager, output->get())) {
+                Logger::error("Falha ao inicializar o controle virtual do shard " + std::to_string(shard));
+                break;
+            }
+            
+            std::unique_ptr<EventMapper> mapper(new EventMapper(&configManager));
+            std::unique_ptr<InputPipeline> pipeline(new InputPipeline());
+            buildInputPipeline(*pipeline, configManager, mapper.get(), controller.get(), &interceptManager);
+            shardRouter.addShard(pipeline.get());
+            
+            shardOutputs.push_back(std::move(output));
+            shardControllers.push_back(std::move(controller));
+            shardMappers.push_back(std::move(mapper));
+            shardPipelines.push_back(std::move(pipeline));
+        }
+        
+        shardRouter.loadRoutesFromConfig(&configManager);
+        shardRouter.setWorkerTuning(ThreadTuning::fromConfig(&configManager, "shard", ThreadTuning::PRIORITY_HIGHEST));
+        shardRouter.start();
+        
+        // Gravação opcional dos eventos capturados, para reprodução com --replay
+        InputRecorder inputRecorder;
+        const std::string inputRecordFile = configManager.getStringValue("input_record_file");
+        const bool recordInput = !inputRecordFile.empty() && inputRecorder.open(inputRecordFile);
+        
+        // Iniciar thread de processamento de eventos; ela usa os shards e a
+        // gravação, então termina antes que sejam fechados e destruídos
+        std::atomic<bool> processingRunning(true);
+        std::thread procThread(processingThread, &interceptManager, &shardRouter,
+                               recordInput ? &inputRecorder : nullptr,
+                               ThreadTuning::fromConfig(&configManager, "input", ThreadTuning::PRIORITY_HIGHEST),
+                               &processingRunning);
+        ThreadStopper procStopper = { &processingRunning, &procThread };
         
         // Iniciar thread para monitorar a tecla de ativação (F8)
-        std::thread hotkeyThread(toggleHotkeyMonitor);
+        std::thread hotkeyThread(toggleHotkeyMonitor, ThreadTuning::fromConfig(&configManager, "hotkey"), traceFile);
         hotkeyThread.detach(); // Desacoplar thread
         
         // Inicializar e executar a interface gráfica
         MainWindow mainWindow(hInstance, &configManager, &g_emulationActive);
-        return mainWindow.run(nCmdShow);
+        mainWindow.setFeedbackChannel(&feedbackChannel);
+        mainWindow.setVirtualController(&virtualController);
+        const int exitCode = mainWindow.run(nCmdShow);
+        procStopper.stop();
+        inputPipeline.logStageStats();
+        LatencyRegistry::logSummary();
+        PipelineCounters::logSummary();
+        inputRecorder.close();
+        if (!traceFile.empty()) {
+            TraceRecorder::writeChromeTrace(traceFile);
+        }
+        return exitCode;
         
     } catch (const std::exception& e) {
         std::string errorMsg = "Erro inesperado: ";
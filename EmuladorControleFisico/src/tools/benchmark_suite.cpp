@@ -0,0 +1,544 @@
+/**
+ * @file benchmark_suite.cpp
+ * @brief Implementação dos microbenchmarks dos caminhos críticos
+ */
+
+#include "benchmark_suite.h"
+#include "scratch_config.h"
+#include "../core/event_mapper.h"
+#include "../core/mouse_kernel.h"
+#include "../core/output_sink.h"
+#include "../core/poll_phase_scheduler.h"
+#include "../core/virtual_controller.h"
+#include "../utils/clock.h"
+#include "../utils/config_manager.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+const double CALIBRATION_NANOS = 20e6;
+const double TARGET_NANOS = 200e6;
+const size_t KERNEL_BATCH = 256;
+const int RULE_COUNT = 100;
+
+// Custo máximo por evento com RULE_COUNT regras: 2 us por evento são ~1,6% de
+// um núcleo com mouse de 8 kHz (medido ~0,5 us; a folga cobre máquinas mais lentas)
+const double RULES_BUDGET_NANOS_PER_EVENT = 2000.0;
+
+// Consumidor simulado: jogo lendo a 60 Hz com jitter de +-100 us, durante 60 s simulados
+const int64_t CONSUMER_DURATION_MICROS = 60000000;
+const int64_t CONSUMER_POLL_PERIOD_MICROS = 16667;
+const int64_t CONSUMER_FIRST_POLL_MICROS = 5000;
+const int64_t CONSUMER_LEAD_MICROS = 1500;
+const int64_t NO_SUBMIT = INT64_MAX;
+
+// Resultados acumulados aqui para que o compilador não elimine as operações medidas
+volatile int64_t g_sink = 0;
+
+double elapsedNanos(const std::function<void(uint64_t)>& body, uint64_t iterations) {
+    const auto start = std::chrono::steady_clock::now();
+    body(iterations);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+InputEvent makeKeyEvent(WORD code, bool pressed) {
+    InputEvent event;
+    event.type = InputEvent::TYPE_KEYBOARD;
+    event.deviceId = 1;
+    event.data.keyboard.code = code;
+    event.data.keyboard.state = pressed ? INTERCEPTION_KEY_DOWN : INTERCEPTION_KEY_UP;
+    return event;
+}
+
+InputEvent makeMouseEvent(int x, int y) {
+    InputEvent event;
+    event.type = InputEvent::TYPE_MOUSE;
+    event.deviceId = 11;
+    event.data.mouse.flags = INTERCEPTION_MOUSE_MOVE_RELATIVE;
+    event.data.mouse.x = x;
+    event.data.mouse.y = y;
+    return event;
+}
+
+/**
+ * @brief Simula entradas, envios e leituras do jogo e mede a latência da entrada até a leitura
+ *
+ * As entradas chegam em intervalos pseudoaleatórios de 0,2 a 2,2 ms. Cada
+ * envio publica todas as entradas recebidas até ele; a latência de uma
+ * entrada vai da chegada até a primeira leitura posterior a um envio que a
+ * contém. Com tick fixo os envios saem a cada período, sem relação com a
+ * fase do jogo; com o PLL, as leituras são observadas (como as notificações
+ * do driver) e cada envio é agendado como na thread de saída, logo antes da
+ * próxima leitura prevista.
+ *
+ * @param fixedRateHz Taxa do tick fixo (0 = envio alinhado pelo PLL)
+ * @return Resumo da latência, em nanossegundos
+ */
+LatencySummary simulateConsumerLatency(int fixedRateHz) {
+    std::vector<int64_t> inputs;
+    uint32_t seed = 12345;
+    for (int64_t t = 0; t < CONSUMER_DURATION_MICROS; ) {
+        seed = seed * 1664525u + 1013904223u;
+        t += 200 + (seed >> 8) % 2000;
+        inputs.push_back(t);
+    }
+
+    SimulatedClock clock(1);
+    PollPhaseScheduler scheduler(&clock);
+    scheduler.configure(0.0, CONSUMER_LEAD_MICROS);
+    LatencyHistogram histogram;
+
+    const int64_t fixedPeriod = fixedRateHz > 0 ? 1000000 / fixedRateHz : 0;
+    int64_t nextSubmit = fixedPeriod > 0 ? fixedPeriod : NO_SUBMIT;
+    int64_t nextPoll = CONSUMER_FIRST_POLL_MICROS;
+    uint64_t pollIndex = 0;
+    size_t arrived = 0;
+    size_t submitted = 0;
+    size_t polled = 0;
+
+    while (nextPoll < CONSUMER_DURATION_MICROS) {
+        const int64_t nextInput = arrived < inputs.size() ? inputs[arrived] : NO_SUBMIT;
+
+        // Empates: a entrada chega antes do envio, e o envio antes da leitura
+        if (nextInput <= nextSubmit && nextInput <= nextPoll) {
+            ++arrived;
+
+            // Até o PLL ativar, a thread de saída envia cada ação imediatamente
+            if (fixedPeriod == 0 && !scheduler.isActive()) {
+                submitted = arrived;
+            }
+        } else if (nextSubmit <= nextPoll) {
+            submitted = arrived;
+            clock.setMicros(nextSubmit);
+            nextSubmit = fixedPeriod > 0 ? nextSubmit + fixedPeriod : scheduler.nextSubmitMicros(nextSubmit);
+        } else {
+            for (; polled < submitted; ++polled) {
+                histogram.record(static_cast<uint64_t>(nextPoll - inputs[polled]) * 1000);
+            }
+
+            if (fixedPeriod == 0) {
+                clock.setMicros(nextPoll);
+                scheduler.observePoll(nextPoll);
+                if (nextSubmit == NO_SUBMIT && scheduler.isActive()) {
+                    nextSubmit = scheduler.nextSubmitMicros(nextPoll);
+                }
+            }
+
+            ++pollIndex;
+            nextPoll = CONSUMER_FIRST_POLL_MICROS + static_cast<int64_t>(pollIndex) * CONSUMER_POLL_PERIOD_MICROS +
+                       static_cast<int64_t>((pollIndex * 7919) % 200) - 100;
+        }
+    }
+
+    return histogram.summarize();
+}
+
+} // namespace
+
+BenchmarkSuite::BenchmarkSuite(const std::string& logFilename)
+    : m_logFilename(logFilename) {
+}
+
+const std::vector<BenchmarkResult>& BenchmarkSuite::run(const std::string& filter) {
+    m_filter = filter;
+    m_results.clear();
+    m_consumerResults.clear();
+
+    // Mensagens informativas dos componentes medidos entrariam na medida
+    Logger::setLogLevel(LOG_WARNING);
+
+    benchEventMapper();
+    benchVirtualController();
+    benchPollScheduler();
+    benchConsumerLatency();
+    benchMouseKernel();
+    benchConfigLoad();
+    benchLogger();
+
+    Logger::setLogLevel(LOG_INFO);
+
+    char line[160];
+    for (const BenchmarkResult& result : m_results) {
+        snprintf(line, sizeof(line), "Benchmark %s: %.1f ns/op (melhor %.1f, %llu ops por repetição)",
+                 result.name.c_str(), result.nanosPerOp, result.minNanosPerOp,
+                 static_cast<unsigned long long>(result.iterations));
+        Logger::info(line);
+    }
+
+    for (const ConsumerLatencyResult& result : m_consumerResults) {
+        snprintf(line, sizeof(line), "Benchmark %s: entrada até a leitura média %.0f us, p99 %.0f us, p999 %.0f us",
+                 result.name.c_str(), result.latency.meanNanos / 1000.0, result.latency.p99Nanos / 1000.0,
+                 result.latency.p999Nanos / 1000.0);
+        Logger::info(line);
+    }
+
+    return m_results;
+}
+
+bool BenchmarkSuite::matchesFilter(const std::string& name) const {
+    return m_filter.empty() || name.find(m_filter) != std::string::npos;
+}
+
+void BenchmarkSuite::measure(const std::string& name, const std::function<void(uint64_t)>& body,
+                             double budgetNanosPerOp) {
+    if (!matchesFilter(name)) {
+        return;
+    }
+
+    // Calibrar: dobrar até a execução ser longa o bastante para medir, depois escalar ao alvo
+    uint64_t iterations = 64;
+    double nanos = elapsedNanos(body, iterations);
+    while (nanos < CALIBRATION_NANOS) {
+        iterations *= 2;
+        nanos = elapsedNanos(body, iterations);
+    }
+    iterations = std::max<uint64_t>(1, static_cast<uint64_t>(iterations * (TARGET_NANOS / nanos)));
+
+    std::vector<double> samples;
+    for (int repeat = 0; repeat < REPEATS; ++repeat) {
+        samples.push_back(elapsedNanos(body, iterations) / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nanosPerOp = samples[samples.size() / 2];
+    result.minNanosPerOp = samples.front();
+    result.budgetNanosPerOp = budgetNanosPerOp;
+    m_results.push_back(result);
+}
+
+void BenchmarkSuite::benchEventMapper() {
+    SimulatedClock clock(1);
+
+    {
+        ScratchConfig config("benchmark_mapper.tmp.json");
+        EventMapper mapper(config.get(), &clock);
+        MappedActions actions;
+
+        // Tecla de eixo (W), alternando pressionada e solta
+        measure("event_mapper.keyboard", [&](uint64_t iterations) {
+            const InputEvent events[2] = { makeKeyEvent(DIK_W, true), makeKeyEvent(DIK_W, false) };
+            for (uint64_t i = 0; i < iterations; ++i) {
+                g_sink += mapper.mapEvent(events[i & 1], actions);
+            }
+        });
+
+        // Movimento relativo a 8 kHz
+        measure("event_mapper.mouse", [&](uint64_t iterations) {
+            const InputEvent events[2] = { makeMouseEvent(5, -3), makeMouseEvent(-4, 2) };
+            for (uint64_t i = 0; i < iterations; ++i) {
+                clock.advanceMicros(125);
+                g_sink += mapper.mapEvent(events[i & 1], actions);
+            }
+        });
+    }
+
+    {
+        // Perfil com muitas regras condicionais sobre o eixo e os botões mapeados
+        ScratchConfig config("benchmark_rules.tmp.json");
+        for (int i = 0; i < RULE_COUNT; ++i) {
+            const std::string rule = (i % 2 == 0)
+                ? "key." + std::to_string(2 + i / 2) + "&!mouse.right->scale.LY=0.9"
+                : "axis.LX>" + std::to_string(i % 90) + "%->remap.A=B";
+            config.get()->setStringValue("mapping_rule_" + std::to_string(i), rule);
+        }
+        EventMapper mapper(config.get(), &clock);
+        MappedActions actions;
+
+        measure("event_mapper.keyboard_100_rules", [&](uint64_t iterations) {
+            const InputEvent events[4] = { makeKeyEvent(DIK_W, true), makeKeyEvent(DIK_SPACE, true),
+                                           makeKeyEvent(DIK_W, false), makeKeyEvent(DIK_SPACE, false) };
+            for (uint64_t i = 0; i < iterations; ++i) {
+                g_sink += mapper.mapEvent(events[i & 3], actions);
+            }
+        }, RULES_BUDGET_NANOS_PER_EVENT);
+    }
+}
+
+void BenchmarkSuite::benchVirtualController() {
+    NullOutputSink sink;
+    VirtualController controller;
+    if (!controller.initialize(&sink)) {
+        Logger::error("Benchmark do controle virtual ignorado: falha ao inicializar o destino nulo");
+        return;
+    }
+
+    measure("virtual_controller.apply_axis", [&](uint64_t iterations) {
+        ControllerAction action;
+        action.type = ControllerAction::TYPE_AXIS;
+        action.data.axisData.axis = 2;
+        for (uint64_t i = 0; i < iterations; ++i) {
+            action.data.axisData.value = static_cast<short>((i & 1) ? 12000 : -12000);
+            g_sink += controller.applyAction(action);
+        }
+    });
+
+    measure("virtual_controller.apply_button", [&](uint64_t iterations) {
+        ControllerAction action;
+        action.type = ControllerAction::TYPE_BUTTON;
+        action.data.buttonData.button = XUSB_GAMEPAD_A;
+        for (uint64_t i = 0; i < iterations; ++i) {
+            action.data.buttonData.pressed = (i & 1) != 0;
+            g_sink += controller.applyAction(action);
+        }
+    });
+}
+
+void BenchmarkSuite::benchPollScheduler() {
+    // Cenário do PLL: leituras a 60 Hz com jitter de +-100 us
+    measure("poll_scheduler.observe_60hz", [&](uint64_t iterations) {
+        SimulatedClock clock(1);
+        PollPhaseScheduler scheduler(&clock);
+        scheduler.configure(0.0, 1500);
+
+        int64_t poll = 1;
+        for (uint64_t i = 0; i < iterations; ++i) {
+            poll += 16667 + static_cast<int64_t>((i * 7919) % 200) - 100;
+            clock.setMicros(poll);
+            scheduler.observePoll(poll);
+            g_sink += scheduler.nextSubmitMicros(poll);
+        }
+    });
+}
+
+void BenchmarkSuite::benchConsumerLatency() {
+    // Mesmo número de envios do alinhado (60 Hz) e a taxa de tick usada com mouse de 1 kHz
+    const struct {
+        const char* name;
+        int fixedRateHz;
+    } cases[] = {
+        { "consumer_latency.phase_aligned", 0 },
+        { "consumer_latency.fixed_tick_60hz", 60 },
+        { "consumer_latency.fixed_tick_250hz", 250 },
+    };
+
+    for (const auto& test : cases) {
+        if (matchesFilter(test.name)) {
+            ConsumerLatencyResult result;
+            result.name = test.name;
+            result.latency = simulateConsumerLatency(test.fixedRateHz);
+            m_consumerResults.push_back(result);
+        }
+    }
+}
+
+void BenchmarkSuite::benchMouseKernel() {
+    int deltas[KERNEL_BATCH];
+    float deltaTimes[KERNEL_BATCH];
+    short out[KERNEL_BATCH];
+    for (size_t i = 0; i < KERNEL_BATCH; ++i) {
+        deltas[i] = static_cast<int>(i % 41) - 20;
+        deltaTimes[i] = 0.000125f * (1 + i % 3);
+    }
+    const MouseAxisParams params(1.5f, 1.0f, 3200, false);
+
+    // Custo por movimento, processado em lotes
+    const MouseKernelPath paths[] = { MOUSE_KERNEL_SCALAR, MOUSE_KERNEL_SSE2, MOUSE_KERNEL_AVX2 };
+    for (MouseKernelPath path : paths) {
+        if (!isMouseKernelPathSupported(path)) {
+            continue;
+        }
+        measure(std::string("mouse_kernel.") + getMouseKernelPathName(path), [&](uint64_t iterations) {
+            for (uint64_t done = 0; done < iterations; done += KERNEL_BATCH) {
+                mapMouseAxisBatchWith(path, deltas, deltaTimes, KERNEL_BATCH, params, out);
+                g_sink += out[done % KERNEL_BATCH];
+            }
+        });
+    }
+}
+
+void BenchmarkSuite::benchConfigLoad() {
+    const struct {
+        const char* name;
+        const char* filename;
+        int keys;
+    } cases[] = {
+        { "config.load_small", "benchmark_small.tmp.json", 20 },
+        { "config.load_large", "benchmark_large.tmp.json", 5000 },
+    };
+
+    for (const auto& test : cases) {
+        {
+            std::ofstream file(test.filename);
+            file << "{\n";
+            for (int i = 0; i < test.keys; ++i) {
+                file << "    \"key_" << i << "\": ";
+                switch (i % 4) {
+                    case 0: file << "\"valor_" << i << "\""; break;
+                    case 1: file << i; break;
+                    case 2: file << i << ".5"; break;
+                    default: file << ((i & 1) ? "true" : "false"); break;
+                }
+                file << (i + 1 < test.keys ? ",\n" : "\n");
+            }
+            file << "}\n";
+        }
+
+        {
+            ConfigManager config(test.filename);
+            measure(test.name, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    g_sink += config.loadConfig();
+                }
+            });
+        }
+        std::filesystem::remove(test.filename);
+    }
+}
+
+void BenchmarkSuite::benchLogger() {
+    const char* filename = "benchmark_log.tmp";
+
+    // Arquivo próprio e sem console, para não inundar o log da aplicação
+    Logger::init(filename, false);
+    Logger::setLogLevel(LOG_INFO);
+
+    measure("logger.info", [&](uint64_t iterations) {
+        const std::string message = "Benchmark do log: mensagem com tamanho típico de uma linha de diagnóstico";
+        for (uint64_t i = 0; i < iterations; ++i) {
+            Logger::info(message);
+        }
+    });
+
+    Logger::setLogLevel(LOG_WARNING);
+    Logger::init(m_logFilename);
+    std::filesystem::remove(filename);
+}
+
+bool BenchmarkSuite::writeResults(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        Logger::error("Não foi possível criar o arquivo de resultados: " + filename);
+        return false;
+    }
+
+    char line[256];
+    file << "{\n    \"benchmarks\": [\n";
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        const BenchmarkResult& result = m_results[i];
+        snprintf(line, sizeof(line),
+                 "        {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f}%s\n",
+                 result.name.c_str(), static_cast<unsigned long long>(result.iterations), result.nanosPerOp,
+                 result.minNanosPerOp, i + 1 < m_results.size() ? "," : "");
+        file << line;
+    }
+    file << "    ],\n    \"consumer_latency\": [\n";
+    for (size_t i = 0; i < m_consumerResults.size(); ++i) {
+        const ConsumerLatencyResult& result = m_consumerResults[i];
+        snprintf(line, sizeof(line),
+                 "        {\"scenario\": \"%s\", \"samples\": %llu, \"mean_us\": %.1f, \"p99_us\": %.1f, \"p999_us\": %.1f}%s\n",
+                 result.name.c_str(), static_cast<unsigned long long>(result.latency.count),
+                 result.latency.meanNanos / 1000.0, result.latency.p99Nanos / 1000.0,
+                 result.latency.p999Nanos / 1000.0, i + 1 < m_consumerResults.size() ? "," : "");
+        file << line;
+    }
+    file << "    ]\n}\n";
+
+    if (!file.good()) {
+        Logger::error("Falha ao gravar resultados em " + filename);
+        return false;
+    }
+
+    Logger::info("Resultados dos benchmarks gravados em " + filename);
+    return true;
+}
+
+bool BenchmarkSuite::loadResults(const std::string& filename, std::vector<BenchmarkResult>& results) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        Logger::error("Não foi possível abrir a referência de benchmarks: " + filename);
+        return false;
+    }
+
+    // Formato de writeResults: um benchmark por linha
+    results.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t namePos = line.find("\"name\": \"");
+        const size_t nanosPos = line.find("\"ns_per_op\": ");
+        if (namePos == std::string::npos || nanosPos == std::string::npos) {
+            continue;
+        }
+
+        const size_t nameStart = namePos + 9;
+        const size_t nameEnd = line.find('"', nameStart);
+        if (nameEnd == std::string::npos) {
+            continue;
+        }
+
+        BenchmarkResult result;
+        result.name = line.substr(nameStart, nameEnd - nameStart);
+        result.nanosPerOp = std::strtod(line.c_str() + nanosPos + 13, nullptr);
+
+        const size_t iterationsPos = line.find("\"iterations\": ");
+        result.iterations = iterationsPos != std::string::npos ? std::strtoull(line.c_str() + iterationsPos + 14, nullptr, 10) : 0;
+
+        const size_t minPos = line.find("\"min_ns_per_op\": ");
+        result.minNanosPerOp = minPos != std::string::npos ? std::strtod(line.c_str() + minPos + 17, nullptr) : result.nanosPerOp;
+        result.budgetNanosPerOp = 0.0;
+
+        results.push_back(result);
+    }
+
+    return true;
+}
+
+int BenchmarkSuite::compareWithBaseline(const std::string& baselineFilename, double tolerancePercent) const {
+    std::vector<BenchmarkResult> baseline;
+    if (!loadResults(baselineFilename, baseline)) {
+        return -1;
+    }
+
+    int regressions = 0;
+    char line[200];
+    for (const BenchmarkResult& result : m_results) {
+        auto it = std::find_if(baseline.begin(), baseline.end(),
+                               [&](const BenchmarkResult& entry) { return entry.name == result.name; });
+        if (it == baseline.end() || it->nanosPerOp <= 0.0) {
+            Logger::info("Benchmark " + result.name + ": sem referência");
+            continue;
+        }
+
+        const double changePercent = (result.nanosPerOp - it->nanosPerOp) * 100.0 / it->nanosPerOp;
+        snprintf(line, sizeof(line), "Benchmark %s: %.1f ns/op, referência %.1f ns/op (%+.1f%%)",
+                 result.name.c_str(), result.nanosPerOp, it->nanosPerOp, changePercent);
+
+        if (changePercent > tolerancePercent) {
+            Logger::warning(std::string(line) + " - regressão acima de " + std::to_string(static_cast<int>(tolerancePercent)) + "%");
+            ++regressions;
+        } else {
+            Logger::info(line);
+        }
+    }
+
+    return regressions;
+}
+
+int BenchmarkSuite::checkBudgets() const {
+    int exceeded = 0;
+    char line[200];
+    for (const BenchmarkResult& result : m_results) {
+        if (result.budgetNanosPerOp <= 0.0) {
+            continue;
+        }
+
+        snprintf(line, sizeof(line), "Benchmark %s: %.1f ns/op, limite %.1f ns/op",
+                 result.name.c_str(), result.nanosPerOp, result.budgetNanosPerOp);
+        if (result.nanosPerOp > result.budgetNanosPerOp) {
+            Logger::error(std::string(line) + " - limite excedido");
+            ++exceeded;
+        } else {
+            Logger::info(line);
+        }
+    }
+
+    return exceeded;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file benchmark_suite.h
+ * @brief Microbenchmarks dos caminhos críticos, com comparação contra uma referência
+ */
+
+#pragma once
+
+#include "../utils/latency_histogram.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @struct BenchmarkResult
+ * @brief Custo medido de uma operação
+ */
+struct BenchmarkResult {
+    std::string name;
+    uint64_t iterations;      // Operações por repetição
+    double nanosPerOp;        // Mediana das repetições
+    double minNanosPerOp;     // Melhor repetição
+    double budgetNanosPerOp;  // Limite absoluto da mediana (0 = sem limite)
+};
+
+/**
+ * @struct ConsumerLatencyResult
+ * @brief Latência da entrada até a leitura de um consumidor simulado
+ */
+struct ConsumerLatencyResult {
+    std::string name;
+    LatencySummary latency;  // Em nanossegundos, como os histogramas da aplicação
+};
+
+/**
+ * @class BenchmarkSuite
+ * @brief Executa os microbenchmarks sem driver nem janela (destino de saída nulo)
+ *
+ * Cada benchmark é calibrado para ~200 ms por repetição e repetido algumas
+ * vezes; a mediana é comparada com a referência. Os resultados são gravados
+ * em JSON, um benchmark por linha, e o mesmo arquivo serve de referência
+ * para execuções futuras. O cenário do consumidor simulado mede latência em
+ * tempo simulado, não custo: é gravado à parte e não entra na comparação.
+ */
+class BenchmarkSuite {
+public:
+    static const int REPEATS = 5;
+
+    /**
+     * @brief Construtor
+     * @param logFilename Arquivo de log restaurado após o benchmark do Logger
+     */
+    explicit BenchmarkSuite(const std::string& logFilename);
+
+    /**
+     * @brief Executa os benchmarks
+     * @param filter Executa apenas os nomes que contêm este texto (vazio = todos)
+     * @return Resultados na ordem de execução
+     */
+    const std::vector<BenchmarkResult>& run(const std::string& filter = "");
+
+    /**
+     * @brief Grava os resultados em JSON
+     * @param filename Caminho do arquivo
+     * @return true se gravado com sucesso, false caso contrário
+     */
+    bool writeResults(const std::string& filename) const;
+
+    /**
+     * @brief Compara os resultados com uma referência gravada por writeResults
+     * @param baselineFilename Arquivo de referência
+     * @param tolerancePercent Aumento de custo tolerado, em porcentagem
+     * @return Número de benchmarks mais lentos que a tolerância (-1 se a referência não pôde ser lida)
+     */
+    int compareWithBaseline(const std::string& baselineFilename, double tolerancePercent) const;
+
+    /**
+     * @brief Verifica os benchmarks que têm limite absoluto de custo
+     *
+     * Diferente da referência, o limite não depende de uma execução anterior:
+     * a regra de custo por evento vale em qualquer máquina suportada.
+     *
+     * @return Número de benchmarks cuja mediana passou do limite
+     */
+    int checkBudgets() const;
+
+    /**
+     * @brief Lê resultados gravados por writeResults
+     * @param filename Caminho do arquivo
+     * @param results Recebe os resultados
+     * @return true se lido com sucesso, false caso contrário
+     */
+    static bool loadResults(const std::string& filename, std::vector<BenchmarkResult>& results);
+
+private:
+    std::string m_logFilename;
+    std::string m_filter;
+    std::vector<BenchmarkResult> m_results;
+    std::vector<ConsumerLatencyResult> m_consumerResults;
+
+    /**
+     * @brief Calibra, mede e guarda o custo de uma operação
+     * @param name Nome do benchmark
+     * @param body Executa a operação o número de vezes pedido
+     * @param budgetNanosPerOp Limite absoluto de custo por operação (0 = sem limite)
+     */
+    void measure(const std::string& name, const std::function<void(uint64_t)>& body,
+                 double budgetNanosPerOp = 0.0);
+
+    /**
+     * @brief Indica se o nome passa pelo filtro da execução
+     * @param name Nome do benchmark
+     * @return true se o benchmark deve ser executado
+     */
+    bool matchesFilter(const std::string& name) const;
+
+    /**
+     * @brief Mapeamento de teclado e mouse, com e sem regras condicionais
+     */
+    void benchEventMapper();
+
+    /**
+     * @brief Aplicação de ações ao controle virtual com destino nulo
+     */
+    void benchVirtualController();
+
+    /**
+     * @brief Atualização do PLL de fase de leitura
+     */
+    void benchPollScheduler();
+
+    /**
+     * @brief Latência até a leitura de um jogo simulado, com envio alinhado e com tick fixo
+     */
+    void benchConsumerLatency();
+
+    /**
+     * @brief Kernel de movimento do mouse em cada implementação suportada
+     */
+    void benchMouseKernel();
+
+    /**
+     * @brief Leitura de arquivos de configuração pequeno e grande
+     */
+    void benchConfigLoad();
+
+    /**
+     * @brief Vazão do Logger gravando em arquivo
+     */
+    void benchLogger();
+};
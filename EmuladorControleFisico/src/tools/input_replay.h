@@ -0,0 +1,77 @@
+/**
+ * @file input_replay.h
+ * @brief Reprodução determinística de gravações de entrada pelo mapeamento e controle virtual
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class CommandLine;
+
+/**
+ * @struct ReplayOptions
+ * @brief Parâmetros de uma reprodução
+ */
+struct ReplayOptions {
+    std::string recordingFile;  // Gravação de InputRecorder
+    std::string configFile;     // Configuração de mapeamento (copiada, nunca alterada)
+    std::string outputFile;     // Relatórios produzidos (formato de RecordingOutputSink)
+    std::string goldenFile;     // Relatórios esperados (vazio = sem comparação)
+    int outputRateHz;           // Taxa de envio simulada (0 = a cada evento)
+
+    ReplayOptions();
+
+    /**
+     * @brief Lê as opções --replay* da linha de comando
+     * @param commandLine Linha de comando
+     * @return Opções, com padrões para as ausentes
+     */
+    static ReplayOptions fromCommandLine(const CommandLine& commandLine);
+};
+
+/**
+ * @class InputReplay
+ * @brief Passa uma gravação de entrada pelos estágios filter, map e apply e grava os relatórios
+ *
+ * O relógio simulado avança para o instante de captura de cada evento e o
+ * controle virtual envia na própria thread da reprodução (modo manual), de
+ * modo que a sequência de relatórios depende apenas da gravação e da
+ * configuração. O arquivo produzido pode servir de referência para
+ * execuções futuras e é comparado relatório a relatório.
+ *
+ * Com taxa de envio, os ticks são simulados entre os eventos e as bordas de
+ * botão aguardam o próximo tick (como output_button_bypass desligado).
+ */
+class InputReplay {
+public:
+    /**
+     * @brief Construtor
+     * @param options Parâmetros da reprodução
+     */
+    explicit InputReplay(const ReplayOptions& options);
+
+    /**
+     * @brief Reproduz a gravação e, se houver referência, compara o resultado
+     * @return true se reproduzida e igual à referência, false caso contrário
+     */
+    bool run();
+
+    /**
+     * @brief Compara duas gravações de relatórios
+     * @param actualFile Relatórios produzidos
+     * @param goldenFile Relatórios esperados
+     * @return true se idênticas, false caso contrário (a primeira diferença vai para o log)
+     */
+    static bool compareReports(const std::string& actualFile, const std::string& goldenFile);
+
+private:
+    ReplayOptions m_options;
+
+    /**
+     * @brief Reproduz os eventos e grava os relatórios em m_options.outputFile
+     * @return true se reproduzida, false se a gravação ou o destino não puderam ser abertos
+     */
+    bool replay();
+};
@@ -0,0 +1,57 @@
+/**
+ * @file scratch_config.h
+ * @brief Configuração temporária para os modos sem interface
+ */
+
+#pragma once
+
+#include "../utils/config_manager.h"
+#include <filesystem>
+#include <memory>
+#include <string>
+
+/**
+ * @class ScratchConfig
+ * @brief ConfigManager sobre um arquivo descartável, removido na destruição
+ *
+ * O ConfigManager grava o arquivo ao ser destruído, então ele é destruído
+ * antes de o arquivo ser removido. Partir de uma cópia evita que um modo sem
+ * interface reescreva a configuração original.
+ */
+class ScratchConfig {
+public:
+    /**
+     * @brief Construtor
+     * @param filename Arquivo temporário
+     * @param source Configuração copiada para o arquivo temporário (vazio = começar sem nenhum valor)
+     */
+    explicit ScratchConfig(const std::string& filename, const std::string& source = "")
+        : m_filename(filename) {
+        std::filesystem::remove(m_filename);
+        if (!source.empty()) {
+            std::error_code error;
+            std::filesystem::copy_file(source, m_filename, error);
+        }
+        m_config.reset(new ConfigManager(m_filename));
+    }
+
+    ~ScratchConfig() {
+        m_config.reset();
+        std::filesystem::remove(m_filename);
+    }
+
+    /**
+     * @brief Obtém o gerenciador de configuração
+     * @return Gerenciador (válido enquanto este objeto existir)
+     */
+    ConfigManager* get() {
+        return m_config.get();
+    }
+
+private:
+    std::string m_filename;
+    std::unique_ptr<ConfigManager> m_config;
+
+    ScratchConfig(const ScratchConfig&) = delete;
+    ScratchConfig& operator=(const ScratchConfig&) = delete;
+};
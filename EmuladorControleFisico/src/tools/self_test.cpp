@@ -0,0 +1,2045 @@
+/**
+ * @file self_test.cpp
+ * @brief Implementação das verificações automáticas dos componentes
+ */
+
+#include "self_test.h"
+#include "input_replay.h"
+#include "scratch_config.h"
+#include "../core/event_mapper.h"
+#include "../core/feedback_channel.h"
+#include "../core/input_fusion.h"
+#include "../core/input_recording.h"
+#include "../core/mapping_rules.h"
+#include "../core/one_euro_filter.h"
+#include "../core/output_sink.h"
+#include "../core/output_target.h"
+#include "../core/poll_phase_scheduler.h"
+#include "../core/virtual_bus.h"
+#include "../core/virtual_controller.h"
+#include "../utils/clock.h"
+#include "../utils/latency_histogram.h"
+#include "../utils/logger.h"
+#include "../utils/pipeline_counters.h"
+#include "../utils/seqlock.h"
+#include "../utils/tick_source.h"
+#include "../utils/trace_recorder.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+const int SETTLE_TIMEOUT_MS = 2000;
+
+/**
+ * @class FakeOutputSink
+ * @brief Destino de teste: guarda os relatórios aceitos e pode atrasar cada envio
+ */
+class FakeOutputSink : public OutputSink {
+public:
+    FakeOutputSink()
+        : m_delayMicros(0) {
+    }
+
+    bool open() override {
+        return true;
+    }
+
+    void close() override {
+    }
+
+    bool submit(const XUSB_REPORT& report, int64_t timestampMicros) override {
+        const int delayMicros = m_delayMicros;
+        if (delayMicros > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(delayMicros));
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_reports.push_back(report);
+        return true;
+    }
+
+    std::string getName() const override {
+        return "Teste";
+    }
+
+    void setDelayMicros(int delayMicros) {
+        m_delayMicros = delayMicros;
+    }
+
+    std::vector<XUSB_REPORT> getReports() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_reports;
+    }
+
+private:
+    std::atomic<int> m_delayMicros;
+    mutable std::mutex m_mutex;
+    std::vector<XUSB_REPORT> m_reports;
+};
+
+/**
+ * @class FaultInjectingSink
+ * @brief Destino de teste que pode ser desconectado: os envios falham até recover()
+ */
+class FaultInjectingSink : public FakeOutputSink {
+public:
+    FaultInjectingSink()
+        : m_connected(true), m_failedSubmits(0), m_recoveries(0) {
+    }
+
+    bool submit(const XUSB_REPORT& report, int64_t timestampMicros) override {
+        if (!m_connected) {
+            ++m_failedSubmits;
+            return false;
+        }
+        return FakeOutputSink::submit(report, timestampMicros);
+    }
+
+    bool recover() override {
+        ++m_recoveries;
+        m_connected = true;
+        return true;
+    }
+
+    void disconnect() {
+        m_connected = false;
+    }
+
+    uint64_t getFailedSubmits() const {
+        return m_failedSubmits;
+    }
+
+    uint64_t getRecoveries() const {
+        return m_recoveries;
+    }
+
+private:
+    std::atomic<bool> m_connected;
+    std::atomic<uint64_t> m_failedSubmits;
+    std::atomic<uint64_t> m_recoveries;
+};
+
+/**
+ * @class FakeVirtualBus
+ * @brief Barramento de teste: conta as conexões, guarda os relatórios por índice e pode recusar envios
+ */
+class FakeVirtualBus : public VirtualBus {
+public:
+    FakeVirtualBus()
+        : m_connected(false), m_connects(0) {
+        for (int i = 0; i < MAX_TARGETS; ++i) {
+            m_present[i] = false;
+            m_failUpdates[i] = 0;
+        }
+    }
+
+    bool connect() override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_connected) {
+            m_connected = true;
+            ++m_connects;
+        }
+        return true;
+    }
+
+    void disconnect() override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int i = 0; i < MAX_TARGETS; ++i) {
+            m_present[i] = false;
+        }
+        m_connected = false;
+    }
+
+    bool addTarget(int index, OutputTargetType type) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_connected || index < 0 || index >= MAX_TARGETS) {
+            return false;
+        }
+        m_present[index] = true;
+        return true;
+    }
+
+    void removeTarget(int index) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (index >= 0 && index < MAX_TARGETS) {
+            m_present[index] = false;
+        }
+    }
+
+    bool update(int index, const XUSB_REPORT& report) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (index < 0 || index >= MAX_TARGETS || !m_present[index]) {
+            return false;
+        }
+        if (m_failUpdates[index] > 0) {
+            --m_failUpdates[index];
+            return false;
+        }
+        m_reports[index].push_back(report);
+        return true;
+    }
+
+    std::string getName() const override {
+        return "Teste";
+    }
+
+    /**
+     * @brief Faz os próximos envios ao índice falharem, como um driver ocupado
+     */
+    void failNextUpdates(int index, int count) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failUpdates[index] = count;
+    }
+
+    int getConnects() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_connects;
+    }
+
+    bool isPresent(int index) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_present[index];
+    }
+
+    std::vector<XUSB_REPORT> getReports(int index) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_reports[index];
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    bool m_connected;
+    int m_connects;
+    bool m_present[MAX_TARGETS];
+    int m_failUpdates[MAX_TARGETS];
+    std::vector<XUSB_REPORT> m_reports[MAX_TARGETS];
+};
+
+/**
+ * @class SlowFeedbackListener
+ * @brief Consumidor de teste: demora em cada notificação e guarda a última recebida
+ */
+class SlowFeedbackListener : public FeedbackListener {
+public:
+    explicit SlowFeedbackListener(int delayMicros)
+        : m_delayMicros(delayMicros), m_delivered(0), m_lastLargeMotor(0) {
+    }
+
+    void onFeedback(const FeedbackEvent& event) override {
+        std::this_thread::sleep_for(std::chrono::microseconds(m_delayMicros));
+        m_lastLargeMotor = event.largeMotor;
+        ++m_delivered;
+    }
+
+    uint64_t getDelivered() const {
+        return m_delivered;
+    }
+
+    int getLastLargeMotor() const {
+        return m_lastLargeMotor;
+    }
+
+private:
+    int m_delayMicros;
+    std::atomic<uint64_t> m_delivered;
+    std::atomic<int> m_lastLargeMotor;
+};
+
+ControllerAction axisAction(int axis, short value) {
+    ControllerAction action;
+    action.type = ControllerAction::TYPE_AXIS;
+    action.data.axisData.axis = axis;
+    action.data.axisData.value = value;
+    return action;
+}
+
+ControllerAction buttonAction(XUSB_BUTTON button, bool pressed) {
+    ControllerAction action;
+    action.type = ControllerAction::TYPE_BUTTON;
+    action.data.buttonData.button = button;
+    action.data.buttonData.pressed = pressed;
+    return action;
+}
+
+InputEvent mouseEvent(int x, int y) {
+    InputEvent event;
+    event.type = InputEvent::TYPE_MOUSE;
+    event.deviceId = 11;
+    event.data.mouse.flags = INTERCEPTION_MOUSE_MOVE_RELATIVE;
+    event.data.mouse.x = x;
+    event.data.mouse.y = y;
+    return event;
+}
+
+InputEvent keyEvent(WORD code, bool pressed) {
+    InputEvent event;
+    event.type = InputEvent::TYPE_KEYBOARD;
+    event.deviceId = 1;
+    event.data.keyboard.code = code;
+    event.data.keyboard.state = pressed ? INTERCEPTION_KEY_DOWN : INTERCEPTION_KEY_UP;
+    return event;
+}
+
+std::string describeAction(const ControllerAction& action) {
+    return "tipo " + std::to_string(action.type) + " eixo " + std::to_string(action.data.axisData.axis) +
+           " valor " + std::to_string(action.data.axisData.value);
+}
+
+/**
+ * @struct StickSeries
+ * @brief Valores de um eixo vistos a cada tick de saída, com as medidas do filtro
+ */
+struct StickSeries {
+    std::vector<short> values;
+    double jitter;          // Desvio padrão no trecho lento estável
+    int64_t riseMicros;     // Do degrau de velocidade até 90% da variação
+
+    StickSeries() : jitter(0.0), riseMicros(0) {}
+};
+
+/**
+ * @brief Calcula o jitter e o tempo de subida de uma série amostrada nos ticks
+ * @param series Série
+ * @param tickMicros Intervalo entre ticks
+ * @param stepMicros Instante do degrau de velocidade
+ * @param slowMean Média de referência antes do degrau
+ * @param fastMean Média de referência depois do degrau
+ */
+void measureStickSeries(StickSeries& series, int64_t tickMicros, int64_t stepMicros, double slowMean,
+                        double fastMean) {
+    // Trecho lento estável: da metade do caminho até o degrau
+    const size_t slowBegin = static_cast<size_t>(stepMicros / 2 / tickMicros);
+    const size_t slowEnd = static_cast<size_t>(stepMicros / tickMicros);
+    double sum = 0.0;
+    double squares = 0.0;
+    for (size_t i = slowBegin; i < slowEnd; ++i) {
+        sum += series.values[i];
+        squares += static_cast<double>(series.values[i]) * series.values[i];
+    }
+    const double count = static_cast<double>(slowEnd - slowBegin);
+    const double mean = sum / count;
+    series.jitter = std::sqrt(std::max(0.0, squares / count - mean * mean));
+
+    const double threshold = slowMean + 0.9 * (fastMean - slowMean);
+    series.riseMicros = -1;
+    for (size_t i = slowEnd; i < series.values.size(); ++i) {
+        if (series.values[i] >= threshold) {
+            series.riseMicros = static_cast<int64_t>(i + 1) * tickMicros - stepMicros;
+            break;
+        }
+    }
+}
+
+double meanOf(const std::vector<short>& values, size_t begin, size_t end) {
+    double sum = 0.0;
+    for (size_t i = begin; i < end; ++i) {
+        sum += values[i];
+    }
+    return sum / static_cast<double>(end - begin);
+}
+
+/**
+ * @brief Serializa um relatório do DS4 na ordem dos campos, sem preenchimento
+ * @param report Relatório
+ * @param bytes Recebe os 9 bytes (eixos, botões em little-endian, especial, gatilhos)
+ */
+void packDs4Report(const DS4_REPORT& report, uint8_t bytes[9]) {
+    bytes[0] = report.bThumbLX;
+    bytes[1] = report.bThumbLY;
+    bytes[2] = report.bThumbRX;
+    bytes[3] = report.bThumbRY;
+    bytes[4] = static_cast<uint8_t>(report.wButtons);
+    bytes[5] = static_cast<uint8_t>(report.wButtons >> 8);
+    bytes[6] = report.bSpecial;
+    bytes[7] = report.bTriggerL;
+    bytes[8] = report.bTriggerR;
+}
+
+std::string toHex(const uint8_t* bytes, size_t size) {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string text;
+    for (size_t i = 0; i < size; ++i) {
+        text += digits[bytes[i] >> 4];
+        text += digits[bytes[i] & 0x0F];
+        text += ' ';
+    }
+    return text;
+}
+
+/**
+ * @class JsonChecker
+ * @brief Verificador sintático mínimo de JSON: objetos, listas, textos, números e literais
+ */
+class JsonChecker {
+public:
+    explicit JsonChecker(const std::string& text)
+        : m_text(text), m_pos(0) {
+    }
+
+    bool check() {
+        if (!value(0)) {
+            return false;
+        }
+        skipSpace();
+        return m_pos == m_text.size();
+    }
+
+private:
+    const std::string& m_text;
+    size_t m_pos;
+
+    void skipSpace() {
+        while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) {
+            ++m_pos;
+        }
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (m_pos < m_text.size() && m_text[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool value(int depth) {
+        skipSpace();
+        if (depth > 32 || m_pos >= m_text.size()) {
+            return false;
+        }
+
+        const char c = m_text[m_pos];
+        if (c == '{' || c == '[') {
+            return container(c == '{', depth);
+        }
+        if (c == '"') {
+            return string();
+        }
+        if (c == '-' || std::isdigit(static_cast<unsigned char>(c))) {
+            return number();
+        }
+        return literal("true") || literal("false") || literal("null");
+    }
+
+    bool container(bool object, int depth) {
+        const char close = object ? '}' : ']';
+        ++m_pos;
+        if (consume(close)) {
+            return true;
+        }
+        do {
+            skipSpace();
+            if (object && (!string() || !consume(':'))) {
+                return false;
+            }
+            if (!value(depth + 1)) {
+                return false;
+            }
+        } while (consume(','));
+        return consume(close);
+    }
+
+    bool string() {
+        if (m_pos >= m_text.size() || m_text[m_pos] != '"') {
+            return false;
+        }
+        for (++m_pos; m_pos < m_text.size(); ++m_pos) {
+            const char c = m_text[m_pos];
+            if (c == '\\') {
+                ++m_pos;
+            } else if (c == '"') {
+                ++m_pos;
+                return true;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool number() {
+        size_t end = m_pos + 1;
+        while (end < m_text.size() && (std::isdigit(static_cast<unsigned char>(m_text[end])) ||
+                                       strchr(".eE+-", m_text[end]) != nullptr)) {
+            ++end;
+        }
+        char* parsedEnd = nullptr;
+        const std::string token = m_text.substr(m_pos, end - m_pos);
+        strtod(token.c_str(), &parsedEnd);
+        m_pos = end;
+        return parsedEnd == token.c_str() + token.size();
+    }
+
+    bool literal(const char* word) {
+        const size_t length = strlen(word);
+        if (m_text.compare(m_pos, length, word) != 0) {
+            return false;
+        }
+        m_pos += length;
+        return true;
+    }
+};
+
+/**
+ * @brief Obtém o valor de um campo de uma linha do rastreamento exportado (um evento por linha)
+ * @param line Linha com um objeto JSON
+ * @param key Nome do campo
+ * @return Valor sem aspas, ou vazio se ausente
+ */
+std::string traceField(const std::string& line, const std::string& key) {
+    const std::string pattern = "\"" + key + "\":";
+    const size_t start = line.find(pattern);
+    if (start == std::string::npos) {
+        return "";
+    }
+
+    size_t begin = start + pattern.size();
+    if (begin < line.size() && line[begin] == '"') {
+        ++begin;
+        return line.substr(begin, line.find('"', begin) - begin);
+    }
+    return line.substr(begin, line.find_first_of(",}", begin) - begin);
+}
+
+/**
+ * @brief Confere um rastreamento exportado: JSON válido e, por thread nomeada,
+ *        instantes em ordem e intervalos aninhados corretamente
+ * @param filename Arquivo exportado
+ * @param threadNames Threads a conferir
+ * @param eventCounts Recebe o número de eventos de cada thread conferida
+ * @return Descrição do primeiro problema, ou vazio se válido
+ */
+std::string checkChromeTrace(const std::string& filename, const std::vector<std::string>& threadNames,
+                             std::vector<size_t>& eventCounts) {
+    std::ifstream file(filename);
+    std::stringstream content;
+    content << file.rdbuf();
+    const std::string text = content.str();
+    if (!JsonChecker(text).check()) {
+        return "JSON inválido em " + filename;
+    }
+
+    // Identificador de cada thread pelo nome, nos metadados
+    std::map<std::string, size_t> threadByTid;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (traceField(line, "ph") != "M") {
+            continue;
+        }
+        for (size_t i = 0; i < threadNames.size(); ++i) {
+            if (line.find("\"name\":\"" + threadNames[i] + "\"}") != std::string::npos) {
+                threadByTid[traceField(line, "tid")] = i;
+            }
+        }
+    }
+    if (threadByTid.size() != threadNames.size()) {
+        return "metadados de nome das threads ausentes";
+    }
+
+    std::vector<double> lastTimestamp(threadNames.size(), 0.0);
+    std::vector<std::vector<std::string>> stacks(threadNames.size());
+    eventCounts.assign(threadNames.size(), 0);
+
+    lines.clear();
+    lines.seekg(0);
+    while (std::getline(lines, line)) {
+        const std::string phase = traceField(line, "ph");
+        const auto thread = threadByTid.find(traceField(line, "tid"));
+        if (phase.empty() || phase == "M" || thread == threadByTid.end()) {
+            continue;
+        }
+
+        const size_t index = thread->second;
+        const std::string name = traceField(line, "name");
+        const double timestamp = strtod(traceField(line, "ts").c_str(), nullptr);
+        if (timestamp < lastTimestamp[index]) {
+            return threadNames[index] + ": instante fora de ordem em " + name;
+        }
+        lastTimestamp[index] = timestamp;
+
+        if (phase == "B") {
+            stacks[index].push_back(name);
+        } else if (phase == "E") {
+            if (stacks[index].empty() || stacks[index].back() != name) {
+                return threadNames[index] + ": fim de " + name + " sem início correspondente";
+            }
+            stacks[index].pop_back();
+        }
+        ++eventCounts[index];
+    }
+    return "";
+}
+
+/**
+ * @brief Espera uma condição ficar verdadeira, verificando a cada milissegundo
+ * @param condition Condição
+ * @param timeoutMs Tempo máximo de espera
+ * @return true se a condição ficou verdadeira no prazo
+ */
+bool waitFor(const std::function<bool()>& condition, int timeoutMs) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+SelfTest::SelfTest() {
+}
+
+int SelfTest::run(const std::string& filter) {
+    m_filter = filter;
+    m_results.clear();
+
+    // Mensagens informativas dos componentes montados a cada grupo não interessam aqui
+    Logger::setLogLevel(LOG_WARNING);
+
+    testOutputThread();
+    testOutputRate();
+    testDs4Packing();
+    testFeedbackBurst();
+    testSeqLockStress();
+    testPhaseAlign();
+    testOutputFaults();
+    testMouseMapping();
+    testStickFilter();
+    testBusSharing();
+    testInputFusion();
+    testInputRecording();
+    testReplayDeterminism();
+    testMappingRules();
+    testLatencyHistogram();
+    testTickJitter();
+    testPipelineCounters();
+    testTraceExport();
+
+    Logger::setLogLevel(LOG_INFO);
+
+    int failures = 0;
+    for (const GroupResult& result : m_results) {
+        if (result.failures.empty()) {
+            Logger::info("Autoteste " + result.name + ": ok (" + std::to_string(result.checks) + " verificações)");
+        }
+
+        for (const std::string& failure : result.failures) {
+            Logger::error("Autoteste " + result.name + " falhou: " + failure);
+        }
+        for (const std::string& text : result.notes) {
+            Logger::info("  " + result.name + ": " + text);
+        }
+        failures += static_cast<int>(result.failures.size());
+    }
+
+    Logger::info("Autoteste: " + std::to_string(m_results.size()) + " grupos, " + std::to_string(failures) + " falhas");
+    return failures;
+}
+
+bool SelfTest::beginGroup(const std::string& name) {
+    if (!m_filter.empty() && name.find(m_filter) == std::string::npos) {
+        return false;
+    }
+
+    GroupResult result;
+    result.name = name;
+    result.checks = 0;
+    m_results.push_back(result);
+    return true;
+}
+
+bool SelfTest::expect(bool condition, const std::string& description) {
+    GroupResult& result = m_results.back();
+    ++result.checks;
+    if (!condition) {
+        result.failures.push_back(description);
+    }
+    return condition;
+}
+
+void SelfTest::note(const std::string& text) {
+    m_results.back().notes.push_back(text);
+}
+
+void SelfTest::testOutputThread() {
+    if (!beginGroup("output_thread")) {
+        return;
+    }
+
+    const int sinkDelayMicros = 5000;
+    const int actionCount = 200;
+
+    FakeOutputSink sink;
+    VirtualController controller;
+    expect(controller.initialize(&sink), "inicialização com destino de teste");
+    expect(waitFor([&]() { return !sink.getReports().empty(); }, SETTLE_TIMEOUT_MS), "estado inicial enviado");
+
+    // Driver lento: cada envio leva 5 ms, mas a thread de entrada não pode esperar por ele
+    sink.setDelayMicros(sinkDelayMicros);
+    int64_t slowestMicros = 0;
+    for (int i = 1; i <= actionCount; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        controller.applyAction(axisAction(0, static_cast<short>(i * 100)));
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        slowestMicros = std::max<int64_t>(slowestMicros,
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+    expect(slowestMicros < sinkDelayMicros / 5,
+           "applyAction bloqueou " + std::to_string(slowestMicros) + " us com destino de 5 ms");
+
+    // O consumidor envia sempre o estado mais recente, coalescendo os intermediários
+    const short finalValue = static_cast<short>(actionCount * 100);
+    expect(waitFor([&]() {
+        const std::vector<XUSB_REPORT> reports = sink.getReports();
+        return reports.back().sThumbLX == finalValue;
+    }, SETTLE_TIMEOUT_MS), "estado final do eixo não chegou ao destino");
+    const size_t axisReports = sink.getReports().size();
+    expect(axisReports < static_cast<size_t>(actionCount / 2),
+           std::to_string(axisReports) + " envios para " + std::to_string(actionCount) + " ações (sem coalescência)");
+
+    // Toque curto entre dois consumos: o pressionamento ainda precisa ser enviado
+    controller.applyAction(axisAction(0, 0));
+    controller.applyAction(buttonAction(XUSB_GAMEPAD_A, true));
+    controller.applyAction(buttonAction(XUSB_GAMEPAD_A, false));
+
+    // O eixo zerado sozinho já satisfaz o estado final: esperar também pelo toque
+    expect(waitFor([&]() {
+        const std::vector<XUSB_REPORT> reports = sink.getReports();
+        return std::any_of(reports.begin() + axisReports, reports.end(),
+                           [](const XUSB_REPORT& report) { return (report.wButtons & XUSB_GAMEPAD_A) != 0; });
+    }, SETTLE_TIMEOUT_MS), "toque curto do botão A perdido na coalescência");
+    expect(waitFor([&]() {
+        const std::vector<XUSB_REPORT> reports = sink.getReports();
+        return reports.back().sThumbLX == 0 && !(reports.back().wButtons & XUSB_GAMEPAD_A);
+    }, SETTLE_TIMEOUT_MS), "estado após o toque não chegou ao destino");
+}
+
+void SelfTest::testOutputRate() {
+    if (!beginGroup("output_rate")) {
+        return;
+    }
+
+    FakeOutputSink sink;
+    VirtualController controller;
+    expect(controller.initialize(&sink), "inicialização com destino de teste");
+    expect(waitFor([&]() { return !sink.getReports().empty(); }, SETTLE_TIMEOUT_MS), "estado inicial enviado");
+
+    // Rajada de ações de eixo a 250 Hz: no máximo um envio por tick, não um por ação
+    {
+        const int actionCount = 2000;
+        const int64_t tickMicros = 4000;
+        controller.setOutputRate(250, true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        const uint64_t submitsBefore = controller.getSubmitCount();
+        const size_t reportsBefore = sink.getReports().size();
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 1; i <= actionCount; ++i) {
+            controller.applyAction(axisAction(2, static_cast<short>(i * 10)));
+            if (i % 100 == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        const short finalValue = static_cast<short>(actionCount * 10);
+        expect(waitFor([&]() {
+            const std::vector<XUSB_REPORT> reports = sink.getReports();
+            return !reports.empty() && reports.back().sThumbRX == finalValue;
+        }, SETTLE_TIMEOUT_MS), "rajada: estado final do eixo não chegou ao destino");
+        const int64_t elapsedMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        const uint64_t submits = controller.getSubmitCount() - submitsBefore;
+        const uint64_t maxSubmits = static_cast<uint64_t>(elapsedMicros / tickMicros) + 2;
+        expect(submits <= maxSubmits, "rajada: " + std::to_string(submits) + " envios em " +
+               std::to_string(elapsedMicros) + " us (máximo " + std::to_string(maxSubmits) + ")");
+        expect(sink.getReports().size() - reportsBefore == submits, "rajada: envios contados diferentes dos recebidos");
+        note("rajada: " + std::to_string(actionCount) + " ações, " + std::to_string(submits) + " envios em " +
+             std::to_string(elapsedMicros) + " us");
+    }
+
+    // Tick lento (500 ms): logo depois de um tick, só uma borda de botão pode ser enviada antes do próximo.
+    // A espera deixa passar o tick do período anterior antes da ação que marca o novo
+    const auto waitTick = [&](short value) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        controller.applyAction(axisAction(0, value));
+        return waitFor([&]() {
+            const std::vector<XUSB_REPORT> reports = sink.getReports();
+            return !reports.empty() && reports.back().sThumbLX == value;
+        }, SETTLE_TIMEOUT_MS);
+    };
+    const auto hasButton = [&](XUSB_BUTTON button) {
+        const std::vector<XUSB_REPORT> reports = sink.getReports();
+        return !reports.empty() && (reports.back().wButtons & button) != 0;
+    };
+
+    {
+        controller.setOutputRate(2, true);
+        expect(waitTick(1000), "botões imediatos: eixo não enviado no tick");
+
+        controller.applyAction(axisAction(1, 3000));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        expect(sink.getReports().back().sThumbLY != 3000, "botões imediatos: eixo enviado antes do tick");
+
+        controller.applyAction(buttonAction(XUSB_GAMEPAD_A, true));
+        expect(waitFor([&]() { return hasButton(XUSB_GAMEPAD_A); }, 150),
+               "botões imediatos: borda do botão A esperou o tick");
+        expect(sink.getReports().back().sThumbLY == 3000, "botões imediatos: envio do botão sem o eixo pendente");
+    }
+
+    {
+        controller.setOutputRate(2, false);
+        expect(waitTick(2000), "botões no tick: eixo não enviado no tick");
+
+        controller.applyAction(buttonAction(XUSB_GAMEPAD_B, true));
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        expect(!hasButton(XUSB_GAMEPAD_B), "botões no tick: borda do botão B enviada antes do tick");
+        expect(waitFor([&]() { return hasButton(XUSB_GAMEPAD_B); }, SETTLE_TIMEOUT_MS),
+               "botões no tick: botão B não enviado no tick seguinte");
+    }
+
+    // Estado reaplicado sem mudança: contado como suprimido, sem chamar o destino
+    {
+        controller.setOutputRate(0);
+        expect(waitTick(7000), "supressão: eixo não enviado");
+
+        const uint64_t submitsBefore = controller.getSubmitCount();
+        const uint64_t suppressedBefore = controller.getSuppressedSubmitCount();
+        const size_t reportsBefore = sink.getReports().size();
+
+        // Eixo com o mesmo valor e botão já pressionado (repetição de tecla)
+        const ControllerAction repeats[] = { axisAction(0, 7000), buttonAction(XUSB_GAMEPAD_A, true),
+                                             axisAction(0, 7000) };
+        for (size_t i = 0; i < sizeof(repeats) / sizeof(repeats[0]); ++i) {
+            controller.applyAction(repeats[i]);
+            expect(waitFor([&]() { return controller.getSuppressedSubmitCount() > suppressedBefore + i; },
+                           SETTLE_TIMEOUT_MS),
+                   "supressão: repetição " + std::to_string(i) + " não contada como suprimida");
+        }
+        expect(controller.getSubmitCount() == submitsBefore, "supressão: estado repetido contado como envio");
+        expect(sink.getReports().size() == reportsBefore, "supressão: estado repetido chegou ao destino");
+    }
+}
+
+void SelfTest::testDs4Packing() {
+    if (!beginGroup("ds4_packing")) {
+        return;
+    }
+
+    struct Vector {
+        const char* name;
+        XUSB_REPORT state;
+        uint8_t expected[9];
+    };
+
+    // Bytes esperados: LX, LY, RX, RY, botões (baixo, alto), especial, L2, R2.
+    // Eixos Y invertidos; direcional como chapéu (8 = solto, 0 = norte, sentido horário)
+    static const Vector vectors[] = {
+        { "neutro",
+          { 0, 0, 0, 0, 0, 0, 0 },
+          { 0x80, 0x80, 0x80, 0x80, 0x08, 0x00, 0x00, 0x00, 0x00 } },
+        { "extremos, A, nordeste, Guide, L2",
+          { static_cast<WORD>(XUSB_GAMEPAD_A | XUSB_GAMEPAD_DPAD_UP | XUSB_GAMEPAD_DPAD_RIGHT | XUSB_GAMEPAD_GUIDE),
+            255, 0, 32767, 32767, -32768, -32768 },
+          { 0xFF, 0x00, 0x00, 0xFF, 0x21, 0x04, 0x01, 0xFF, 0x00 } },
+        { "demais botões, cima+baixo se anulam, R2 mínimo",
+          { static_cast<WORD>(XUSB_GAMEPAD_B | XUSB_GAMEPAD_X | XUSB_GAMEPAD_Y | XUSB_GAMEPAD_LEFT_SHOULDER |
+                              XUSB_GAMEPAD_RIGHT_SHOULDER | XUSB_GAMEPAD_BACK | XUSB_GAMEPAD_START |
+                              XUSB_GAMEPAD_LEFT_THUMB | XUSB_GAMEPAD_RIGHT_THUMB |
+                              XUSB_GAMEPAD_DPAD_UP | XUSB_GAMEPAD_DPAD_DOWN | XUSB_GAMEPAD_DPAD_LEFT),
+            0, 1, -1, -1, 256, 256 },
+          { 0x7F, 0x80, 0x81, 0x7F, 0xD6, 0xFB, 0x00, 0x00, 0x01 } },
+        { "sudoeste",
+          { static_cast<WORD>(XUSB_GAMEPAD_DPAD_DOWN | XUSB_GAMEPAD_DPAD_LEFT), 0, 0, 0, 0, 0, 0 },
+          { 0x80, 0x80, 0x80, 0x80, 0x05, 0x00, 0x00, 0x00, 0x00 } }
+    };
+
+    for (const Vector& vector : vectors) {
+        DS4_REPORT report;
+        memset(&report, 0xCD, sizeof(report));
+        OutputTarget<OUTPUT_TARGET_DS4>::translate(vector.state, report);
+
+        uint8_t bytes[9];
+        packDs4Report(report, bytes);
+        expect(memcmp(bytes, vector.expected, sizeof(bytes)) == 0,
+               std::string(vector.name) + ": esperado " + toHex(vector.expected, 9) + "obtido " + toHex(bytes, 9));
+    }
+
+    // Xbox 360: o relatório nativo é o próprio estado
+    const XUSB_REPORT state = vectors[1].state;
+    XUSB_REPORT x360;
+    OutputTarget<OUTPUT_TARGET_X360>::translate(state, x360);
+    expect(memcmp(&x360, &state, sizeof(XUSB_REPORT)) == 0, "Xbox 360 alterou o estado na tradução");
+}
+
+void SelfTest::testFeedbackBurst() {
+    if (!beginGroup("feedback_burst")) {
+        return;
+    }
+
+    const int listenerDelayMicros = 200;
+    const int eventCount = 20000;
+
+    SimulatedClock clock;
+    SlowFeedbackListener listener(listenerDelayMicros);
+    FeedbackChannel channel(&clock);
+    channel.addListener(&listener);
+    expect(channel.start(), "thread de despacho iniciada");
+
+    // Thread do driver simulada: notificações seguidas, muito mais rápidas que o consumidor
+    int64_t slowestMicros = 0;
+    uint64_t accepted = 0;
+    const auto burstStart = std::chrono::steady_clock::now();
+    std::thread driver([&]() {
+        for (int i = 0; i < eventCount; ++i) {
+            FeedbackEvent event;
+            event.timestamp = clock.nowMicros();
+            event.largeMotor = static_cast<BYTE>(i);
+            event.smallMotor = 0;
+            event.ledNumber = 0;
+            event.red = 0;
+            event.green = 0;
+            event.blue = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            if (channel.push(event)) {
+                ++accepted;
+            }
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            slowestMicros = std::max<int64_t>(slowestMicros,
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        }
+    });
+    driver.join();
+    const int64_t burstMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - burstStart).count();
+
+    // Se o driver esperasse o consumidor, a rajada levaria eventCount * 200 us (4 s)
+    expect(burstMicros < static_cast<int64_t>(eventCount) * listenerDelayMicros / 10,
+           "rajada levou " + std::to_string(burstMicros) + " us (driver esperou o consumidor)");
+    expect(slowestMicros < 10000, "push mais lento levou " + std::to_string(slowestMicros) + " us");
+
+    expect(channel.getReceivedCount() == static_cast<uint64_t>(eventCount),
+           std::to_string(channel.getReceivedCount()) + " notificações recebidas de " + std::to_string(eventCount));
+    expect(channel.getDroppedCount() > 0, "consumidor lento sem descartes: a fila não foi exercitada");
+    expect(channel.getDroppedCount() + accepted == static_cast<uint64_t>(eventCount),
+           "descartes (" + std::to_string(channel.getDroppedCount()) + ") + aceitas (" + std::to_string(accepted) +
+           ") diferente do total");
+
+    FeedbackEvent latest;
+    expect(channel.getLatest(latest) && latest.largeMotor == static_cast<BYTE>(eventCount - 1),
+           "estado mais recente não é a última notificação");
+
+    // O encerramento entrega tudo o que foi aceito
+    channel.stop();
+    expect(listener.getDelivered() == accepted,
+           std::to_string(listener.getDelivered()) + " entregues de " + std::to_string(accepted) + " aceitas");
+}
+
+void SelfTest::testSeqLockStress() {
+    if (!beginGroup("seqlock_stress")) {
+        return;
+    }
+
+    // Valor de várias palavras: uma leitura parcial mistura publicações diferentes
+    struct Value {
+        uint64_t fields[8];
+    };
+
+    const uint64_t writeCount = 2000000;
+    const int readerCount = 4;
+
+    SeqLock<Value> lock;
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> tornReads(0);
+    std::atomic<uint64_t> mismatchedSequences(0);
+    std::atomic<uint64_t> backwardsReads(0);
+    std::atomic<uint64_t> totalReads(0);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < readerCount; ++r) {
+        readers.emplace_back([&]() {
+            uint64_t lastSequence = 0;
+            uint64_t reads = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                Value value;
+                const uint64_t sequence = lock.read(value);
+                ++reads;
+
+                for (size_t i = 1; i < 8; ++i) {
+                    if (value.fields[i] != value.fields[0]) {
+                        tornReads.fetch_add(1, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+                // A publicação n grava n em todos os campos
+                if (value.fields[0] != sequence) {
+                    mismatchedSequences.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (sequence < lastSequence) {
+                    backwardsReads.fetch_add(1, std::memory_order_relaxed);
+                }
+                lastSequence = sequence;
+            }
+            totalReads.fetch_add(reads, std::memory_order_relaxed);
+        });
+    }
+
+    for (uint64_t n = 1; n <= writeCount; ++n) {
+        Value value;
+        for (size_t i = 0; i < 8; ++i) {
+            value.fields[i] = n;
+        }
+        lock.write(value);
+    }
+    done.store(true, std::memory_order_release);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    expect(tornReads == 0, std::to_string(tornReads.load()) + " leituras parciais em " +
+           std::to_string(totalReads.load()));
+    expect(mismatchedSequences == 0, std::to_string(mismatchedSequences.load()) +
+           " leituras com sequência diferente do valor");
+    expect(backwardsReads == 0, std::to_string(backwardsReads.load()) + " leituras voltaram no tempo");
+    expect(totalReads >= static_cast<uint64_t>(readerCount), "leitores não executaram");
+
+    Value last;
+    expect(lock.read(last) == writeCount && last.fields[7] == writeCount, "última publicação não lida");
+}
+
+void SelfTest::testPhaseAlign() {
+    if (!beginGroup("phase_align")) {
+        return;
+    }
+
+    // Primeiro envio alinhado deve sair em cerca de um quadro, não no período de 1 s da taxa nula
+    const int alignedTimeoutMs = 200;
+    const int64_t framePeriodMicros = 16667;
+
+    // Ativado pelas notificações, sem taxa fixa: a thread de saída dormia sem prazo
+    {
+        SimulatedClock clock;
+        clock.setMicros(1000000);
+        FakeOutputSink sink;
+        PollPhaseScheduler scheduler(&clock);
+        scheduler.configure(0.0, 1500);
+
+        VirtualController controller(&clock);
+        expect(controller.initialize(&sink), "notificações: inicialização com destino de teste");
+        controller.setPollScheduler(&scheduler);
+        expect(waitFor([&]() { return !sink.getReports().empty(); }, SETTLE_TIMEOUT_MS),
+               "notificações: estado inicial enviado");
+
+        scheduler.observePoll(clock.nowMicros());
+        clock.advanceMicros(framePeriodMicros);
+        scheduler.observePoll(clock.nowMicros());
+        expect(scheduler.isActive(), "notificações: agendador não ativou com duas leituras");
+
+        const auto start = std::chrono::steady_clock::now();
+        controller.applyAction(axisAction(0, 12000));
+        expect(waitFor([&]() { return sink.getReports().back().sThumbLX == 12000; }, alignedTimeoutMs),
+               "notificações: eixo não enviado após a ativação do agendador");
+
+        const int64_t elapsedMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        controller.applyAction(axisAction(0, -12000));
+        expect(waitFor([&]() { return sink.getReports().back().sThumbLX == -12000; }, alignedTimeoutMs),
+               "notificações: eixo seguinte não enviado (" + std::to_string(elapsedMicros) + " us no primeiro)");
+    }
+
+    // Ativado pela taxa de quadros configurada antes de a thread de saída começar a ticar
+    {
+        SimulatedClock clock;
+        clock.setMicros(1000000);
+        FakeOutputSink sink;
+        PollPhaseScheduler scheduler(&clock);
+        scheduler.configure(60.0, 1500);
+
+        VirtualController controller(&clock);
+        expect(controller.initialize(&sink), "taxa de quadros: inicialização com destino de teste");
+        expect(waitFor([&]() { return !sink.getReports().empty(); }, SETTLE_TIMEOUT_MS),
+               "taxa de quadros: estado inicial enviado");
+        controller.setPollScheduler(&scheduler);
+
+        // Deixar a thread de saída adotar o agendamento antes da ação
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        const auto start = std::chrono::steady_clock::now();
+        controller.applyAction(axisAction(1, 8000));
+        const bool sent = waitFor([&]() {
+            const std::vector<XUSB_REPORT> reports = sink.getReports();
+            return !reports.empty() && reports.back().sThumbLY == 8000;
+        }, alignedTimeoutMs);
+        const int64_t elapsedMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        expect(sent, "taxa de quadros: eixo não enviado em " + std::to_string(alignedTimeoutMs) + " ms");
+        expect(elapsedMicros < 4 * framePeriodMicros,
+               "taxa de quadros: primeiro envio alinhado levou " + std::to_string(elapsedMicros) + " us");
+    }
+}
+
+void SelfTest::testOutputFaults() {
+    if (!beginGroup("output_faults")) {
+        return;
+    }
+
+    // Relógio simulado parado: o intervalo degradado (20 ms) só passa quando o teste avança o relógio
+    SimulatedClock clock;
+    clock.setMicros(1000000);
+    FaultInjectingSink sink;
+    VirtualController controller(&clock);
+    controller.configureHealthMonitor(5000, 0.25, 0.5, 50, 1000);
+    expect(controller.initialize(&sink), "inicialização com destino de teste");
+    expect(waitFor([&]() { return !sink.getReports().empty(); }, SETTLE_TIMEOUT_MS), "estado inicial enviado");
+
+    // Controle removido pelo driver: as falhas seguidas ativam o modo degradado
+    sink.disconnect();
+    controller.applyAction(axisAction(0, 5000));
+    expect(waitFor([&]() { return controller.getHealthMetrics().degraded; }, SETTLE_TIMEOUT_MS),
+           "falhas seguidas não ativaram o modo degradado (" + std::to_string(sink.getFailedSubmits()) + " falhas)");
+
+    // Toque durante o modo degradado: o pressionamento é limitado e precisa esperar a reconexão
+    const size_t reportsBefore = sink.getReports().size();
+    controller.applyAction(buttonAction(XUSB_GAMEPAD_A, true));
+    controller.applyAction(buttonAction(XUSB_GAMEPAD_A, false));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    expect(controller.getHealthMetrics().rateLimitedSubmits > 0, "modo degradado não limitou os envios");
+
+    // Passado o intervalo de reconexão: o destino é reconectado e o estado restaurado
+    clock.advanceMicros(1100000);
+    expect(waitFor([&]() { return sink.getRecoveries() > 0; }, SETTLE_TIMEOUT_MS), "reconexão não tentada");
+    expect(waitFor([&]() { return !controller.getHealthMetrics().degraded; }, SETTLE_TIMEOUT_MS),
+           "modo degradado continuou após a reconexão com o controle parado");
+    expect(waitFor([&]() {
+        const std::vector<XUSB_REPORT> reports = sink.getReports();
+        return reports.size() > reportsBefore && reports.back().sThumbLX == 5000 &&
+               !(reports.back().wButtons & XUSB_GAMEPAD_A);
+    }, SETTLE_TIMEOUT_MS), "estado atual não restaurado após a reconexão");
+
+    const std::vector<XUSB_REPORT> restored = sink.getReports();
+    const bool tapSent = std::any_of(restored.begin() + reportsBefore, restored.end(),
+                                     [](const XUSB_REPORT& report) { return (report.wButtons & XUSB_GAMEPAD_A) != 0; });
+    expect(tapSent, "toque do botão A durante o modo degradado perdido");
+    expect(controller.getHealthMetrics().recoveryEvents == 1, "saída do modo degradado não registrada");
+
+    // Envios normais retomados: com o relógio ainda parado, nada mais é limitado
+    const uint64_t rateLimited = controller.getHealthMetrics().rateLimitedSubmits;
+    for (int i = 1; i <= 5; ++i) {
+        controller.applyAction(axisAction(0, static_cast<short>(5000 + i)));
+        expect(waitFor([&]() { return sink.getReports().back().sThumbLX == 5000 + i; }, SETTLE_TIMEOUT_MS),
+               "envio " + std::to_string(i) + " após a recuperação não chegou");
+    }
+    expect(controller.getHealthMetrics().rateLimitedSubmits == rateLimited, "envios limitados após a recuperação");
+
+    // Envio recusado e estado desfeito para o último enviado: nada mais a reenviar
+    FaultInjectingSink revertSink;
+    VirtualController reverting;
+    reverting.configureHealthMonitor(5000, 0.25, 0.5, 50, 1000);
+    expect(reverting.initialize(&revertSink), "inicialização com destino de teste");
+    reverting.applyAction(axisAction(0, 5000));
+    expect(waitFor([&]() {
+        const std::vector<XUSB_REPORT> reports = revertSink.getReports();
+        return !reports.empty() && reports.back().sThumbLX == 5000;
+    }, SETTLE_TIMEOUT_MS),
+           "estado inicial do caso de reversão não chegou");
+
+    revertSink.disconnect();
+    reverting.applyAction(axisAction(0, 6000));
+    expect(waitFor([&]() { return revertSink.getFailedSubmits() > 0; }, SETTLE_TIMEOUT_MS), "envio recusado não ocorreu");
+    const uint64_t suppressedBefore = reverting.getSuppressedSubmitCount();
+    reverting.applyAction(axisAction(0, 5000));
+    expect(waitFor([&]() { return reverting.getSuppressedSubmitCount() > suppressedBefore; }, SETTLE_TIMEOUT_MS),
+           "estado revertido não foi reconhecido como já enviado");
+
+    const uint64_t suppressedAfter = reverting.getSuppressedSubmitCount();
+    const uint64_t failedAfter = revertSink.getFailedSubmits();
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    expect(reverting.getSuppressedSubmitCount() == suppressedAfter && revertSink.getFailedSubmits() == failedAfter,
+           "reenvio continuou após reverter ao último estado enviado (" +
+           std::to_string(reverting.getSuppressedSubmitCount() - suppressedAfter) + " supressões, " +
+           std::to_string(revertSink.getFailedSubmits() - failedAfter) + " falhas)");
+}
+
+void SelfTest::testMouseMapping() {
+    if (!beginGroup("mouse_mapping")) {
+        return;
+    }
+
+    const size_t strokeCount = 500;
+
+    // Movimentos pseudoaleatórios reproduzíveis, com intervalos de 125 us a 4 ms
+    std::vector<InterceptionMouseStroke> strokes;
+    std::vector<int64_t> intervals;
+    uint32_t seed = 12345;
+    auto nextRandom = [&seed](int range) {
+        seed = seed * 1103515245 + 12345;
+        return static_cast<int>((seed >> 16) % range);
+    };
+    for (size_t i = 0; i < strokeCount; ++i) {
+        InputEvent event = mouseEvent(nextRandom(81) - 40, nextRandom(81) - 40);
+        if (event.data.mouse.x == 0 && event.data.mouse.y == 0) {
+            event.data.mouse.y = 1;
+        }
+        strokes.push_back(event.data.mouse);
+        intervals.push_back(125 + nextRandom(3876));
+    }
+
+    // Evento a evento, como o estágio map do pipeline
+    std::vector<ControllerAction> scalarActions;
+    {
+        ScratchConfig config("selftest_mouse_scalar.tmp.json");
+        SimulatedClock clock(1000000);
+        EventMapper mapper(config.get(), &clock);
+
+        MappedActions actions;
+        for (size_t i = 0; i < strokeCount; ++i) {
+            clock.advanceMicros(intervals[i]);
+            InputEvent event = mouseEvent(strokes[i].x, strokes[i].y);
+            mapper.mapEvent(event, actions);
+            scalarActions.insert(scalarActions.end(), actions.actions, actions.actions + actions.count);
+        }
+    }
+
+    // Em lote, com os mesmos intervalos
+    std::vector<ControllerAction> batchActions;
+    {
+        ScratchConfig config("selftest_mouse_batch.tmp.json");
+        SimulatedClock clock(1000000);
+        EventMapper mapper(config.get(), &clock);
+
+        std::vector<float> deltaTimes;
+        for (size_t i = 0; i < strokeCount; ++i) {
+            deltaTimes.push_back(static_cast<float>(intervals[i]) / 1000000.0f);
+        }
+        mapper.mapMouseMotionBatch(strokes.data(), deltaTimes.data(), strokeCount, batchActions);
+    }
+
+    // Mapeamento padrão: X -> RX e Y -> RY em cada movimento
+    expect(scalarActions.size() == strokeCount * 2,
+           std::to_string(scalarActions.size()) + " ações evento a evento para " + std::to_string(strokeCount) +
+           " movimentos (esperado um eixo por mapeamento)");
+    expect(scalarActions.size() == batchActions.size(),
+           std::to_string(scalarActions.size()) + " ações evento a evento, " + std::to_string(batchActions.size()) +
+           " em lote");
+
+    size_t firstDifference = scalarActions.size();
+    for (size_t i = 0; i < std::min(scalarActions.size(), batchActions.size()); ++i) {
+        const ControllerAction& a = scalarActions[i];
+        const ControllerAction& b = batchActions[i];
+        if (a.type != b.type || a.data.axisData.axis != b.data.axisData.axis ||
+            a.data.axisData.value != b.data.axisData.value) {
+            firstDifference = i;
+            break;
+        }
+    }
+    expect(firstDifference == scalarActions.size(),
+           "ação " + std::to_string(firstDifference) + " difere: " +
+           (firstDifference < std::min(scalarActions.size(), batchActions.size())
+                ? describeAction(scalarActions[firstDifference]) + " contra " +
+                  describeAction(batchActions[firstDifference])
+                : std::string("-")));
+
+    const bool bothAxes = scalarActions.size() >= 2 &&
+                          scalarActions[0].data.axisData.axis == 2 && scalarActions[1].data.axisData.axis == 3;
+    expect(bothAxes, "movimento do mouse não gerou RX e RY");
+}
+
+void SelfTest::testStickFilter() {
+    if (!beginGroup("stick_filter")) {
+        return;
+    }
+
+    // Mouse de 1 kHz com tremor de +-1 contagem; ticks de saída de 250 Hz;
+    // degrau de velocidade de ~8,4 para ~20,4 contagens/ms em 1 s
+    const int64_t mouseMicros = 1000;
+    const int64_t tickMicros = 4000;
+    const int64_t stepMicros = 1000000;
+    const int64_t durationMicros = 2000000;
+    const int64_t startMicros = 1000000;
+
+    std::vector<int> deltas;
+    uint32_t seed = 777;
+    double position = 0.0;
+    int reported = 0;
+    for (int64_t t = mouseMicros; t <= durationMicros; t += mouseMicros) {
+        position += (t <= stepMicros) ? 8.4 : 20.4;
+        seed = seed * 1103515245 + 12345;
+        const int tremor = static_cast<int>((seed >> 16) % 3) - 1;
+        const int delta = static_cast<int>(std::floor(position)) - reported + tremor;
+        reported += delta;
+        deltas.push_back(delta);
+    }
+
+    // Mapeamento sem filtro e com o filtro por amostra (configuração padrão)
+    StickSeries raw;
+    StickSeries perSample;
+    StickSeries perTick;
+    {
+        ScratchConfig rawConfig("selftest_filter_raw.tmp.json");
+        rawConfig.get()->setBoolValue("stick_filter_enabled", false);
+        ScratchConfig filteredConfig("selftest_filter_on.tmp.json");
+
+        SimulatedClock clock(startMicros);
+        EventMapper rawMapper(rawConfig.get(), &clock);
+        EventMapper filteredMapper(filteredConfig.get(), &clock);
+
+        // Alternativa avaliada: mesmo filtro aplicado ao último valor bruto a cada tick
+        OneEuroFilter tickFilter(filteredConfig.get()->getFloatValue("stick_filter_min_cutoff", 5.0f),
+                                 filteredConfig.get()->getFloatValue("stick_filter_beta", 0.0005f),
+                                 filteredConfig.get()->getFloatValue("stick_filter_d_cutoff", 1.0f));
+
+        MappedActions actions;
+        short latestRaw = 0;
+        short latestFiltered = 0;
+        for (size_t i = 0; i < deltas.size(); ++i) {
+            const int64_t t = static_cast<int64_t>(i + 1) * mouseMicros;
+            clock.setMicros(startMicros + t);
+            const InputEvent event = mouseEvent(deltas[i], 0);
+            if (rawMapper.mapEvent(event, actions) > 0) {
+                latestRaw = actions.actions[0].data.axisData.value;
+            }
+            if (filteredMapper.mapEvent(event, actions) > 0) {
+                latestFiltered = actions.actions[0].data.axisData.value;
+            }
+
+            if (t % tickMicros == 0) {
+                raw.values.push_back(latestRaw);
+                perSample.values.push_back(latestFiltered);
+                perTick.values.push_back(tickFilter.filter(latestRaw, tickMicros));
+            }
+        }
+    }
+
+    // Referência: médias do sinal bruto nos trechos estáveis
+    const size_t ticksPerStep = static_cast<size_t>(stepMicros / tickMicros);
+    const double slowMean = meanOf(raw.values, ticksPerStep / 2, ticksPerStep);
+    const double fastMean = meanOf(raw.values, ticksPerStep * 3 / 2, raw.values.size());
+    measureStickSeries(raw, tickMicros, stepMicros, slowMean, fastMean);
+    measureStickSeries(perSample, tickMicros, stepMicros, slowMean, fastMean);
+    measureStickSeries(perTick, tickMicros, stepMicros, slowMean, fastMean);
+
+    char text[160];
+    snprintf(text, sizeof(text), "sem filtro: jitter %.0f, subida %lld us (resolução de um tick)", raw.jitter,
+             static_cast<long long>(raw.riseMicros));
+    note(text);
+    snprintf(text, sizeof(text), "por amostra: jitter %.0f (-%.0f%%), atraso adicionado %lld us", perSample.jitter,
+             100.0 * (1.0 - perSample.jitter / raw.jitter),
+             static_cast<long long>(perSample.riseMicros - raw.riseMicros));
+    note(text);
+    snprintf(text, sizeof(text), "no tick: jitter %.0f (-%.0f%%), atraso adicionado %lld us", perTick.jitter,
+             100.0 * (1.0 - perTick.jitter / raw.jitter),
+             static_cast<long long>(perTick.riseMicros - raw.riseMicros));
+    note(text);
+
+    expect(raw.riseMicros >= 0 && perSample.riseMicros >= 0 && perTick.riseMicros >= 0,
+           "degrau de velocidade não alcançado por alguma das séries");
+    expect(perSample.jitter < raw.jitter * 0.5, "filtro por amostra reduziu o jitter menos da metade");
+    expect(perSample.riseMicros - raw.riseMicros <= 50000, "filtro por amostra atrasou mais de 50 ms");
+
+    // O filtro fica no mapeamento porque, no tick, veria só uma amostra em cada
+    // quatro: menos suavização e mais atraso
+    expect(perSample.jitter <= perTick.jitter, "filtro no tick suavizou mais que o filtro por amostra");
+    expect(perSample.riseMicros <= perTick.riseMicros, "filtro no tick atrasou menos que o filtro por amostra");
+}
+
+void SelfTest::testBusSharing() {
+    if (!beginGroup("bus_sharing")) {
+        return;
+    }
+
+    FakeVirtualBus bus;
+    {
+        BusOutputSink firstSink(&bus, 0, OUTPUT_TARGET_X360);
+        BusOutputSink secondSink(&bus, 1, OUTPUT_TARGET_DS4);
+        VirtualController first;
+        VirtualController second;
+        expect(first.initialize(&firstSink) && second.initialize(&secondSink), "inicialização no barramento de teste");
+        expect(bus.getConnects() == 1, std::to_string(bus.getConnects()) + " conexões para dois controles no mesmo barramento");
+        expect(bus.isPresent(0) && bus.isPresent(1), "controles não adicionados ao barramento");
+
+        // Cada controle envia apenas ao seu índice
+        first.applyAction(axisAction(0, 1111));
+        second.applyAction(axisAction(0, 2222));
+        expect(waitFor([&]() {
+            return !bus.getReports(0).empty() && bus.getReports(0).back().sThumbLX == 1111 &&
+                   !bus.getReports(1).empty() && bus.getReports(1).back().sThumbLX == 2222;
+        }, SETTLE_TIMEOUT_MS), "estado de cada controle não chegou ao seu índice");
+        const std::vector<XUSB_REPORT> firstReports = bus.getReports(0);
+        expect(std::none_of(firstReports.begin(), firstReports.end(),
+                            [](const XUSB_REPORT& report) { return report.sThumbLX == 2222; }),
+               "estado do segundo controle enviado ao primeiro índice");
+
+        // Envio recusado pelo driver: o mesmo estado é reenviado sem nova ação
+        bus.failNextUpdates(0, 2);
+        first.applyAction(axisAction(0, 3333));
+        expect(waitFor([&]() {
+            return !bus.getReports(0).empty() && bus.getReports(0).back().sThumbLX == 3333;
+        }, SETTLE_TIMEOUT_MS), "envio recusado não foi repetido");
+    }
+
+    // Controles destruídos: cada destino remove apenas o seu índice, o cliente continua
+    expect(!bus.isPresent(0) && !bus.isPresent(1), "controles não removidos do barramento ao fechar");
+    expect(bus.getConnects() == 1, "barramento reconectado ao fechar os controles");
+}
+
+void SelfTest::testInputFusion() {
+    if (!beginGroup("input_fusion")) {
+        return;
+    }
+
+    const auto makeReport = [](WORD buttons, BYTE leftTrigger, BYTE rightTrigger,
+                               SHORT lx, SHORT ly, SHORT rx, SHORT ry) {
+        XUSB_REPORT report;
+        ZeroMemory(&report, sizeof(XUSB_REPORT));
+        report.wButtons = buttons;
+        report.bLeftTrigger = leftTrigger;
+        report.bRightTrigger = rightTrigger;
+        report.sThumbLX = lx;
+        report.sThumbLY = ly;
+        report.sThumbRX = rx;
+        report.sThumbRY = ry;
+        return report;
+    };
+
+    // Regras por campo: primário (prioridade 0) e duas fontes fixas, de prioridade 1 e -1.
+    // O gatilho direito da fonte 1 está solto e não pode vencer por prioridade
+    {
+        SimulatedClock clock(1);
+        ReplayGamepadSource high(false, &clock);
+        ReplayGamepadSource low(false, &clock);
+        ReplayGamepadSource empty(false, &clock);
+        high.addFrame(0, makeReport(XUSB_GAMEPAD_B, 50, 0, -30000, 10000, -1000, 1000));
+        low.addFrame(0, makeReport(XUSB_GAMEPAD_X, 150, 10, 25000, 25000, -32768, 0));
+        const XUSB_REPORT primary = makeReport(XUSB_GAMEPAD_A, 100, 30, 20000, 0, 0, 0);
+
+        InputFusion fusion(0);
+        XUSB_REPORT fused = fusion.fuse(primary);
+        expect(memcmp(&fused, &primary, sizeof(XUSB_REPORT)) == 0, "sem fontes: relatório primário alterado");
+
+        fusion.addSource(&high, 1);
+        fusion.addSource(&low, -1);
+        fusion.addSource(&empty, 5);
+
+        const struct {
+            FusionRule rule;
+            const char* name;
+            XUSB_REPORT expected;
+        } cases[] = {
+            { FUSION_PRIORITY, "priority", makeReport(XUSB_GAMEPAD_B, 50, 30, -30000, 10000, -1000, 1000) },
+            { FUSION_MAX, "max", makeReport(XUSB_GAMEPAD_A | XUSB_GAMEPAD_B | XUSB_GAMEPAD_X, 150, 30,
+                                             25000, 25000, -32768, 0) },
+            { FUSION_SUM_CLAMP, "sum", makeReport(XUSB_GAMEPAD_A | XUSB_GAMEPAD_B | XUSB_GAMEPAD_X, 255, 40,
+                                                   15000, 32767, -32768, 1000) },
+        };
+
+        for (const auto& test : cases) {
+            for (int field = 0; field < FUSION_FIELD_COUNT; ++field) {
+                fusion.setRule(static_cast<FusionField>(field), test.rule);
+            }
+            fused = fusion.fuse(primary);
+
+            const std::string name = test.name;
+            expect(fused.wButtons == test.expected.wButtons,
+                   name + ": botões " + std::to_string(fused.wButtons) + " em vez de " +
+                   std::to_string(test.expected.wButtons));
+            expect(fused.bLeftTrigger == test.expected.bLeftTrigger,
+                   name + ": gatilho esquerdo " + std::to_string(fused.bLeftTrigger));
+            expect(fused.bRightTrigger == test.expected.bRightTrigger,
+                   name + ": gatilho direito " + std::to_string(fused.bRightTrigger));
+            expect(fused.sThumbLX == test.expected.sThumbLX && fused.sThumbLY == test.expected.sThumbLY,
+                   name + ": analógico esquerdo " + std::to_string(fused.sThumbLX) + "," + std::to_string(fused.sThumbLY));
+            expect(fused.sThumbRX == test.expected.sThumbRX && fused.sThumbRY == test.expected.sThumbRY,
+                   name + ": analógico direito " + std::to_string(fused.sThumbRX) + "," + std::to_string(fused.sThumbRY));
+        }
+    }
+
+    // Reprodução em laço: período = última amostra + 1 us, com a fase mantida após vários laços
+    {
+        SimulatedClock clock;
+        clock.setMicros(1000000);
+        ReplayGamepadSource looped(true, &clock);
+        ReplayGamepadSource once(false, &clock);
+        for (int i = 0; i < 3; ++i) {
+            const XUSB_REPORT frame = makeReport(0, static_cast<BYTE>(10 * (i + 1)), 0, 0, 0, 0, 0);
+            looped.addFrame(i * 1000, frame);
+            once.addFrame(i * 1000, frame);
+        }
+
+        const struct {
+            int64_t elapsedMicros;
+            BYTE looped;
+            BYTE once;
+        } steps[] = {
+            { 0, 10, 10 }, { 999, 10, 10 }, { 1000, 20, 20 }, { 2000, 30, 30 },
+            { 2001, 10, 30 }, { 3501, 20, 30 }, { 10 * 2001 + 1500, 20, 30 }, { 12 * 2001 + 2000, 30, 30 },
+            { 12 * 2001 + 2001, 10, 30 },
+        };
+
+        XUSB_REPORT report;
+        for (const auto& step : steps) {
+            clock.setMicros(1000000 + step.elapsedMicros);
+            const std::string at = " em " + std::to_string(step.elapsedMicros) + " us";
+
+            const bool loopedPolled = looped.poll(report);
+            expect(loopedPolled && report.bLeftTrigger == step.looped,
+                   "laço: gatilho " + std::to_string(report.bLeftTrigger) + at);
+
+            const bool oncePolled = once.poll(report);
+            expect(oncePolled && report.bLeftTrigger == step.once,
+                   "sem laço: gatilho " + std::to_string(report.bLeftTrigger) + at);
+        }
+
+        // Arquivo: comentários ignorados, amostras reordenadas e valores limitados; o início é o load()
+        const char* const filename = "self_test_gamepad.tmp.txt";
+        {
+            std::ofstream file(filename);
+            file << "# tempo_us botoes lt rt lx ly rx ry\n"
+                 << "5000 1000 0 300 0 0 0 0\n"
+                 << "\n"
+                 << "0 0 0 0 0 0 0 0\n"
+                 << "2500 10 255 0 40000 -40000 0 0\n";
+        }
+        ReplayGamepadSource file(false, &clock);
+        expect(file.load(filename), "arquivo: gravação não carregada");
+        clock.advanceMicros(2500);
+        expect(file.poll(report) && report.wButtons == XUSB_GAMEPAD_START && report.bLeftTrigger == 255 &&
+               report.sThumbLX == 32767 && report.sThumbLY == -32768, "arquivo: amostra de 2500 us");
+        clock.advanceMicros(2500);
+        expect(file.poll(report) && report.wButtons == XUSB_GAMEPAD_A && report.bRightTrigger == 255,
+               "arquivo: amostra de 5000 us");
+        std::remove(filename);
+    }
+
+    // Mudança só na fonte, sem ação local: o tick seguinte envia o relatório combinado
+    {
+        SimulatedClock clock;
+        clock.setMicros(1000000);
+        ReplayGamepadSource source(false, &clock);
+        source.addFrame(0, makeReport(0, 0, 0, 0, 0, 0, 0));
+        source.addFrame(1000, makeReport(XUSB_GAMEPAD_Y, 0, 200, 0, 0, 0, 0));
+        InputFusion fusion(0);
+        fusion.addSource(&source, 1);
+
+        FakeOutputSink sink;
+        VirtualController controller;
+        controller.setInputFusion(&fusion);
+        expect(controller.initialize(&sink), "tick: inicialização com destino de teste");
+        expect(waitFor([&]() { return !sink.getReports().empty(); }, SETTLE_TIMEOUT_MS), "tick: estado inicial enviado");
+        controller.setOutputRate(250, true);
+
+        clock.advanceMicros(1000);
+        expect(waitFor([&]() {
+            const std::vector<XUSB_REPORT> reports = sink.getReports();
+            return reports.back().bRightTrigger == 200 && (reports.back().wButtons & XUSB_GAMEPAD_Y) != 0;
+        }, SETTLE_TIMEOUT_MS), "tick: mudança só da fonte de fusão não enviada");
+    }
+}
+
+void SelfTest::testInputRecording() {
+    if (!beginGroup("input_recording")) {
+        return;
+    }
+
+    const char* const filename = "self_test_input.tmp.bin";
+    const uint32_t eventCount = 3 * InputRecorder::CHUNK_EVENTS + 100;
+
+    // Mouse a 1 kHz em dois dispositivos, com teclas intercaladas
+    std::vector<InputEvent> events;
+    for (uint32_t i = 0; i < eventCount; ++i) {
+        InputEvent event = mouseEvent(static_cast<int>(i % 41) - 20, -static_cast<int>(i % 13));
+        event.deviceId = static_cast<InterceptionDevice>(11 + i % 2);
+        if (i % 7 == 0) {
+            event = InputEvent();
+            event.type = InputEvent::TYPE_KEYBOARD;
+            event.deviceId = 1;
+            event.data.keyboard.code = static_cast<unsigned short>(0x10 + i % 30);
+            event.data.keyboard.state = static_cast<unsigned short>(i % 2);
+        }
+        event.timestamp = 1000000 + static_cast<int64_t>(i) * 1000;
+        events.push_back(event);
+    }
+
+    int64_t slowestMicros = 0;
+    {
+        InputRecorder recorder;
+        if (!expect(recorder.open(filename), "gravação não criada")) {
+            return;
+        }
+        for (const InputEvent& event : events) {
+            const auto start = std::chrono::steady_clock::now();
+            recorder.append(event);
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            slowestMicros = std::max<int64_t>(slowestMicros,
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        }
+        expect(recorder.getEventCount() == eventCount, "eventos contados na gravação");
+        recorder.close();
+        expect(!recorder.isOpen(), "gravação continua aberta após close()");
+    }
+    note("append mais lento: " + std::to_string(slowestMicros) + " us");
+
+    // Leitura: todos os blocos, na ordem, com os mesmos eventos
+    InputRecordingReader reader;
+    if (!expect(reader.open(filename), "gravação não pôde ser lida")) {
+        return;
+    }
+    expect(reader.getChunks().size() == 4, std::to_string(reader.getChunks().size()) + " blocos em vez de 4");
+    expect(reader.getEventCount() == eventCount, "total de eventos do índice");
+
+    bool ordered = true;
+    for (size_t i = 1; i < reader.getChunks().size(); ++i) {
+        ordered = ordered && reader.getChunks()[i].offset > reader.getChunks()[i - 1].offset &&
+                  reader.getChunks()[i].firstTimestamp == events[i * InputRecorder::CHUNK_EVENTS].timestamp;
+    }
+    expect(ordered, "blocos fora de ordem no índice");
+
+    size_t read = 0;
+    size_t mismatches = 0;
+    InputEvent event;
+    while (reader.next(event)) {
+        const InputEvent& expected = events[std::min(read, events.size() - 1)];
+        const bool same = event.type == expected.type && event.deviceId == expected.deviceId &&
+                          event.timestamp == expected.timestamp &&
+                          (event.type == InputEvent::TYPE_KEYBOARD
+                               ? event.data.keyboard.code == expected.data.keyboard.code &&
+                                 event.data.keyboard.state == expected.data.keyboard.state
+                               : event.data.mouse.x == expected.data.mouse.x &&
+                                 event.data.mouse.y == expected.data.mouse.y);
+        mismatches += same ? 0 : 1;
+        ++read;
+    }
+    expect(read == eventCount, std::to_string(read) + " eventos lidos de " + std::to_string(eventCount));
+    expect(mismatches == 0, std::to_string(mismatches) + " eventos lidos diferentes dos gravados");
+
+    reader.close();
+    std::remove(filename);
+}
+
+void SelfTest::testReplayDeterminism() {
+    if (!beginGroup("replay_determinism")) {
+        return;
+    }
+
+    const char* const recordingFile = "self_test_replay.tmp.bin";
+    const char* const configFile = "self_test_replay_config.tmp.json";
+    const char* const firstFile = "self_test_replay_a.tmp.bin";
+    const char* const secondFile = "self_test_replay_b.tmp.bin";
+    const char* const roundTripFile = "self_test_replay_round_trip.tmp.bin";
+
+    // Mouse a 1 kHz com intervalos irregulares, eixo (W) e botão (espaço) intercalados
+    {
+        InputRecorder recorder;
+        if (!expect(recorder.open(recordingFile), "gravação não criada")) {
+            return;
+        }
+        for (int i = 0; i < 600; ++i) {
+            InputEvent event = mouseEvent(i % 9 - 4, 3 - i % 7);
+            if (i % 25 == 0) {
+                event = keyEvent(DIK_W, (i / 25) % 2 == 0);
+            } else if (i % 40 == 5) {
+                event = keyEvent(DIK_SPACE, (i / 40) % 2 == 0);
+            }
+            event.timestamp = 1000000 + i * 1000 + (i % 3) * 137;
+            recorder.append(event);
+        }
+        recorder.close();
+    }
+
+    // Mapeamento padrão, sem depender da configuração de quem roda o autoteste
+    {
+        std::ofstream config(configFile);
+        config << "{\n}\n";
+    }
+
+    const struct {
+        const char* name;
+        int outputRateHz;
+    } modes[] = {
+        { "imediato", 0 },
+        { "250 Hz", 250 },
+    };
+
+    for (const auto& mode : modes) {
+        ReplayOptions options;
+        options.recordingFile = recordingFile;
+        options.configFile = configFile;
+        options.outputRateHz = mode.outputRateHz;
+
+        options.outputFile = firstFile;
+        const bool firstRun = InputReplay(options).run();
+
+        // A segunda execução compara com a primeira pelo mesmo caminho de --replay-golden
+        options.outputFile = secondFile;
+        options.goldenFile = firstFile;
+        const bool secondRun = InputReplay(options).run();
+
+        expect(firstRun, std::string(mode.name) + ": reprodução falhou");
+        expect(secondRun, std::string(mode.name) + ": segunda reprodução diferente da primeira");
+        expect(InputReplay::compareReports(secondFile, firstFile),
+               std::string(mode.name) + ": relatórios das duas reproduções diferem");
+
+        std::vector<RecordedReport> reports;
+        if (!expect(RecordingOutputSink::load(firstFile, reports) && reports.size() > 1,
+                    std::string(mode.name) + ": relatórios não lidos")) {
+            continue;
+        }
+
+        bool ordered = true;
+        bool aligned = true;
+        bool stickMoved = false;
+        bool buttonPressed = false;
+        for (size_t i = 1; i < reports.size(); ++i) {
+            ordered = ordered && reports[i].timestamp >= reports[i - 1].timestamp;
+            if (mode.outputRateHz > 0) {
+                aligned = aligned && (reports[i].timestamp - reports[0].timestamp) % (1000000 / mode.outputRateHz) == 0;
+            }
+            stickMoved = stickMoved || reports[i].report.sThumbRX != 0;
+            buttonPressed = buttonPressed || (reports[i].report.wButtons & XUSB_GAMEPAD_A) != 0;
+        }
+        expect(ordered, std::string(mode.name) + ": instantes dos relatórios fora de ordem");
+        expect(aligned, std::string(mode.name) + ": relatórios fora dos ticks da taxa fixa");
+        expect(stickMoved && buttonPressed, std::string(mode.name) + ": mouse ou botão não chegaram aos relatórios");
+        note(std::string(mode.name) + ": " + std::to_string(reports.size()) + " relatórios");
+    }
+
+    // Ida e volta do formato: valores extremos em todos os campos, com instante negativo
+    {
+        std::vector<RecordedReport> written(3);
+        memset(written.data(), 0, written.size() * sizeof(RecordedReport));
+        written[0].timestamp = -5;
+        written[1].timestamp = 1234567890123LL;
+        written[1].report.wButtons = 0xF3FF;
+        written[1].report.bLeftTrigger = 255;
+        written[1].report.bRightTrigger = 1;
+        written[1].report.sThumbLX = -32768;
+        written[1].report.sThumbLY = 32767;
+        written[1].report.sThumbRX = -1;
+        written[1].report.sThumbRY = 256;
+        written[2].timestamp = INT64_MAX;
+        written[2].report.sThumbLX = 1;
+
+        {
+            RecordingOutputSink sink(roundTripFile);
+            expect(sink.open(), "ida e volta: arquivo não criado");
+            for (const RecordedReport& entry : written) {
+                sink.submit(entry.report, entry.timestamp);
+            }
+            expect(sink.getRecordCount() == written.size(), "ida e volta: relatórios contados");
+        }
+
+        std::vector<RecordedReport> loaded;
+        expect(RecordingOutputSink::load(roundTripFile, loaded), "ida e volta: arquivo não lido");
+        bool same = loaded.size() == written.size();
+        for (size_t i = 0; same && i < loaded.size(); ++i) {
+            same = loaded[i].timestamp == written[i].timestamp &&
+                   memcmp(&loaded[i].report, &written[i].report, sizeof(XUSB_REPORT)) == 0;
+        }
+        expect(same, "ida e volta: " + std::to_string(loaded.size()) + " relatórios lidos diferentes dos gravados");
+    }
+
+    std::remove(recordingFile);
+    std::remove(configFile);
+    std::remove(firstFile);
+    std::remove(secondFile);
+    std::remove(roundTripFile);
+}
+
+void SelfTest::testMappingRules() {
+    if (!beginGroup("mapping_rules")) {
+        return;
+    }
+
+    MappingRules rules;
+    std::string error;
+    expect(rules.addRule("mouse.right -> allow.X", error), "regra allow não compilada: " + error);
+    expect(rules.addRule("key.0x10->block.A", error), "regra block não compilada: " + error);
+    expect(rules.addRule("trigger.L>50%->scale.R=0.5", error), "regra scale não compilada: " + error);
+    expect(rules.addRule("key.0x1E&!button.A->remap.B=Y", error), "regra remap não compilada: " + error);
+    expect(rules.size() == 4, "número de regras compiladas");
+
+    // Erros de compilação não alteram as regras já compiladas
+    std::string longCondition = "key.1";
+    for (int i = 2; i <= 40; ++i) {
+        longCondition += "&key." + std::to_string(i);
+    }
+    const char* const invalidRules[] = { "mouse.right allow.X", "mouse.right->allow.Q", "trigger.L>->block.A",
+                                         "axis.LX<0->scale.LX=abc" };
+    for (const char* text : invalidRules) {
+        error.clear();
+        expect(!rules.addRule(text, error) && !error.empty(), std::string("regra inválida aceita: ") + text);
+    }
+    error.clear();
+    expect(!rules.addRule(longCondition + "->block.B", error) && !error.empty(),
+           "condição acima do limite de registradores/instruções aceita");
+    expect(rules.size() == 4, "regra inválida alterou o conjunto compilado");
+
+    RuleState state;
+    ControllerAction action;
+
+    // allow: X só passa com o botão direito do mouse pressionado; a soltura sempre passa
+    action = buttonAction(XUSB_GAMEPAD_X, true);
+    expect(rules.apply(action, state) && action.type == ControllerAction::TYPE_NONE,
+           "allow.X deixou passar X sem o botão direito do mouse");
+    state.mouseButtons = 0x02;
+    action = buttonAction(XUSB_GAMEPAD_X, true);
+    expect(!rules.apply(action, state) && action.type == ControllerAction::TYPE_BUTTON,
+           "allow.X bloqueou X com o botão direito do mouse");
+    state.mouseButtons = 0;
+    action = buttonAction(XUSB_GAMEPAD_X, false);
+    expect(action.type == ControllerAction::TYPE_BUTTON && !rules.apply(action, state),
+           "soltura de X bloqueada pela regra allow");
+
+    // block: A não é pressionado enquanto a tecla Q estiver pressionada
+    state.setKey(0x10, true);
+    action = buttonAction(XUSB_GAMEPAD_A, true);
+    expect(rules.apply(action, state) && action.type == ControllerAction::TYPE_NONE,
+           "block.A deixou passar A com a tecla pressionada");
+    state.setKey(0x10, false);
+    action = buttonAction(XUSB_GAMEPAD_A, true);
+    expect(!rules.apply(action, state), "block.A bloqueou A sem a tecla pressionada");
+
+    // scale: analógico direito pela metade com o gatilho esquerdo acima de 50%
+    action = axisAction(2, 20000);
+    rules.apply(action, state);
+    expect(action.data.axisData.value == 20000, "scale.R aplicado com o gatilho solto");
+    state.triggers[0] = 200;
+    action = axisAction(3, -20000);
+    expect(rules.apply(action, state) && action.data.axisData.value == -10000,
+           "scale.R=0.5 resultou em " + std::to_string(action.data.axisData.value) + " para -20000");
+    action = axisAction(0, 20000);
+    rules.apply(action, state);
+    expect(action.data.axisData.value == 20000, "scale.R alterou o analógico esquerdo");
+    state.triggers[0] = 0;
+
+    // remap: B vira Y com a tecla A pressionada e o botão A solto; a soltura segue o botão trocado
+    state.setKey(0x1E, true);
+    action = buttonAction(XUSB_GAMEPAD_B, true);
+    expect(rules.apply(action, state) && action.data.buttonData.button == XUSB_GAMEPAD_Y, "remap.B=Y não trocou B");
+    state.applyAction(action);
+    state.setKey(0x1E, false);
+    action = buttonAction(XUSB_GAMEPAD_B, false);
+    expect(rules.apply(action, state) && action.data.buttonData.button == XUSB_GAMEPAD_Y,
+           "soltura de B não acompanhou o Y pressionado (botão preso)");
+    state.applyAction(action);
+    state.setKey(0x1E, true);
+    state.buttons |= XUSB_GAMEPAD_A;
+    action = buttonAction(XUSB_GAMEPAD_B, true);
+    expect(!rules.apply(action, state) && action.data.buttonData.button == XUSB_GAMEPAD_B,
+           "remap.B=Y aplicado com o botão A pressionado");
+}
+
+void SelfTest::testLatencyHistogram() {
+    if (!beginGroup("latency_histogram")) {
+        return;
+    }
+
+    // Cada balde cobre o valor e erra no máximo 1/16 para cima
+    bool boundsOk = true;
+    for (uint64_t value = 0; value < 10000000; value = value * 9 / 8 + 1) {
+        const uint64_t bound = LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketIndex(value));
+        boundsOk = boundsOk && bound >= value && bound <= value + value / LatencyHistogram::SUB_BUCKETS;
+    }
+    expect(boundsOk, "limite de balde fora de [valor, valor + 1/16]");
+
+    // Distribuição uniforme de 1 a 100000 ns: percentis exatos conhecidos
+    std::unique_ptr<LatencyHistogram> histogram(new LatencyHistogram());
+    const uint64_t sampleCount = 100000;
+    for (uint64_t value = 1; value <= sampleCount; ++value) {
+        histogram->record(value);
+    }
+
+    const LatencySummary summary = histogram->summarize();
+    auto withinError = [](uint64_t measured, uint64_t exact) {
+        return measured >= exact && measured <= exact + exact / LatencyHistogram::SUB_BUCKETS;
+    };
+    expect(summary.count == sampleCount, "contagem do histograma");
+    expect(std::fabs(summary.meanNanos - 50000.5) < 0.01, "média " + std::to_string(summary.meanNanos) + " em vez de 50000.5");
+    expect(withinError(summary.p50Nanos, 50000), "p50 " + std::to_string(summary.p50Nanos) + " para 50000");
+    expect(withinError(summary.p99Nanos, 99000), "p99 " + std::to_string(summary.p99Nanos) + " para 99000");
+    expect(withinError(summary.p999Nanos, 99900), "p99.9 " + std::to_string(summary.p999Nanos) + " para 99900");
+    expect(summary.maxNanos == sampleCount && histogram->getPercentile(1.0) == sampleCount,
+           "máximo limitado ao maior valor gravado");
+    note("uniforme 1..100000 ns: p50 " + std::to_string(summary.p50Nanos) + ", p99 " + std::to_string(summary.p99Nanos) +
+         ", p99.9 " + std::to_string(summary.p999Nanos));
+
+    // Cauda: 1% de amostras lentas aparece no p99.9, não no p50
+    std::unique_ptr<LatencyHistogram> tail(new LatencyHistogram());
+    for (int i = 0; i < 9900; ++i) {
+        tail->record(20000);
+    }
+    for (int i = 0; i < 100; ++i) {
+        tail->record(5000000);
+    }
+    expect(withinError(tail->getPercentile(0.5), 20000) && withinError(tail->getPercentile(0.999), 5000000),
+           "cauda de 1% não separada do p50");
+
+    // Blocos por thread somados no registro: nenhuma amostra perdida
+    const uint64_t before = LatencyRegistry::getSummary(LATENCY_PASS_THROUGH).count;
+    const int threadCount = 4;
+    const int perThread = 50000;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threadCount; ++t) {
+        writers.emplace_back([t]() {
+            for (int i = 0; i < perThread; ++i) {
+                LatencyRegistry::record(LATENCY_PASS_THROUGH, static_cast<uint64_t>(1000 * (t + 1)));
+            }
+        });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    const LatencySummary merged = LatencyRegistry::getSummary(LATENCY_PASS_THROUGH);
+    expect(merged.count - before == static_cast<uint64_t>(threadCount * perThread),
+           std::to_string(merged.count - before) + " amostras somadas de " + std::to_string(threadCount * perThread));
+    expect(merged.maxNanos >= 4000, "máximo das threads não somado");
+}
+
+void SelfTest::testTickJitter() {
+    if (!beginGroup("tick_jitter")) {
+        return;
+    }
+
+    TickSource ticks(500);
+    expect(ticks.open(), "timer não criado");
+
+    // Prazos avulsos (como o reenvio do modo degradado), vencidos ou futuros
+    ticks.waitUntil(ticks.nowMicros() - 5000);
+    ticks.waitUntil(ticks.nowMicros() + 1000);
+    expect(ticks.getStats().ticks == 0,
+           std::to_string(ticks.getStats().ticks) + " prazos avulsos contados como ticks");
+
+    // Ticks periódicos, pelo próprio período ou por prazo marcado como tick
+    for (int i = 0; i < 3; ++i) {
+        ticks.waitNextTick();
+    }
+    ticks.waitUntil(ticks.nowMicros() + 1000, nullptr, true);
+    expect(ticks.getStats().ticks == 4, std::to_string(ticks.getStats().ticks) + " ticks contados em vez de 4");
+
+    ticks.close();
+}
+
+void SelfTest::testPipelineCounters() {
+    if (!beginGroup("pipeline_counters")) {
+        return;
+    }
+
+    const int threadCount = 8;
+    const uint64_t perThread = 200000;
+    const CounterSnapshot before = PipelineCounters::snapshot();
+
+    // Escritores em threads próprias enquanto um leitor soma os blocos
+    std::atomic<bool> writing(true);
+    std::atomic<int> finished(0);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threadCount; ++t) {
+        writers.emplace_back([&finished]() {
+            for (uint64_t i = 0; i < perThread; ++i) {
+                PipelineCounters::increment(COUNTER_QUEUE_OVERFLOWS);
+                PipelineCounters::increment(COUNTER_FEEDBACK_DROPPED, 3);
+            }
+            ++finished;
+        });
+    }
+
+    bool monotonic = true;
+    int snapshots = 0;
+    uint64_t previous = before.values[COUNTER_QUEUE_OVERFLOWS];
+    while (writing) {
+        const CounterSnapshot current = PipelineCounters::snapshot();
+        monotonic = monotonic && current.values[COUNTER_QUEUE_OVERFLOWS] >= previous;
+        previous = current.values[COUNTER_QUEUE_OVERFLOWS];
+        ++snapshots;
+        writing = finished < threadCount;
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+
+    // Threads encerradas: os blocos continuam somados e nenhum incremento se perde
+    const CounterSnapshot after = PipelineCounters::snapshot();
+    const uint64_t overflows = after.values[COUNTER_QUEUE_OVERFLOWS] - before.values[COUNTER_QUEUE_OVERFLOWS];
+    const uint64_t dropped = after.values[COUNTER_FEEDBACK_DROPPED] - before.values[COUNTER_FEEDBACK_DROPPED];
+    expect(overflows == threadCount * perThread,
+           std::to_string(overflows) + " incrementos somados de " + std::to_string(threadCount * perThread));
+    expect(dropped == 3 * threadCount * perThread,
+           std::to_string(dropped) + " somados de " + std::to_string(3 * threadCount * perThread) + " (incremento de 3)");
+    expect(monotonic, "total diminuiu entre leituras durante a escrita");
+    expect(after.values[COUNTER_SUBMITS] == before.values[COUNTER_SUBMITS], "contador não incrementado alterado");
+    note(std::to_string(snapshots) + " leituras durante a escrita de " + std::to_string(threadCount) + " threads");
+}
+
+void SelfTest::testTraceExport() {
+    if (!beginGroup("trace_export")) {
+        return;
+    }
+
+    const char* const filename = "self_test_trace.tmp.json";
+    const std::vector<std::string> threadNames = { "autoteste_curta", "autoteste_longa" };
+    const int shortIterations = 1000;
+    const int longIterations = 10000;  // 5 eventos por volta: o buffer circular dá várias voltas
+
+    TraceRecorder::setEnabled(true);
+    std::atomic<bool> exported(false);
+    std::vector<std::thread> writers;
+    for (size_t t = 0; t < threadNames.size(); ++t) {
+        const int iterations = (t == 0) ? shortIterations : longIterations;
+        writers.emplace_back([&threadNames, &exported, t, iterations]() {
+            TraceRecorder::setThreadName(threadNames[t]);
+            // A thread longa continua gravando até a exportação concorrente terminar
+            for (int i = 0; i < iterations || (t == 1 && !exported); ++i) {
+                TraceRecorder::begin("externo");
+                TraceRecorder::begin("interno");
+                TraceRecorder::instant("valor", i);
+                TraceRecorder::end("interno");
+                TraceRecorder::end("externo");
+            }
+        });
+    }
+
+    // Exportação durante a gravação: eventos sobrescritos na cópia são descartados
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    std::vector<size_t> counts;
+    const bool writtenDuring = TraceRecorder::writeChromeTrace(filename);
+    exported = true;
+    std::string problem = checkChromeTrace(filename, threadNames, counts);
+    expect(writtenDuring && problem.empty(), "exportação durante a gravação: " + problem);
+
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    TraceRecorder::setEnabled(false);
+
+    // Exportação final: cada thread com todos os seus eventos ou, após dar a volta, os últimos
+    expect(TraceRecorder::writeChromeTrace(filename), "rastreamento não gravado");
+    problem = checkChromeTrace(filename, threadNames, counts);
+    expect(problem.empty(), "exportação final: " + problem);
+    if (counts.size() == threadNames.size()) {
+        expect(counts[0] == 5 * shortIterations,
+               std::to_string(counts[0]) + " eventos da thread curta de " + std::to_string(5 * shortIterations));
+        expect(counts[1] > TraceRecorder::EVENTS_PER_THREAD - 5 && counts[1] <= TraceRecorder::EVENTS_PER_THREAD,
+               std::to_string(counts[1]) + " eventos da thread que deu a volta no buffer");
+        note("thread longa: " + std::to_string(counts[1]) + " eventos mantidos de " +
+             std::to_string(TraceRecorder::EVENTS_PER_THREAD));
+    }
+
+    std::remove(filename);
+}
@@ -0,0 +1,151 @@
+/**
+ * @file self_test.h
+ * @brief Verificações automáticas dos componentes, executadas sem driver nem janela
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @class SelfTest
+ * @brief Executa verificações de comportamento com destinos, barramentos e relógios simulados
+ *
+ * Cada grupo monta os componentes reais sobre substitutos sem driver
+ * (OutputSink de teste, SimulatedClock) e confere os resultados. As falhas
+ * são acumuladas e registradas no log ao final, junto com um resumo por grupo.
+ */
+class SelfTest {
+public:
+    SelfTest();
+
+    /**
+     * @brief Executa os grupos de verificação
+     * @param filter Executa apenas os grupos cujo nome contém este texto (vazio = todos)
+     * @return Número de verificações que falharam
+     */
+    int run(const std::string& filter = "");
+
+private:
+    struct GroupResult {
+        std::string name;
+        int checks;
+        std::vector<std::string> failures;
+        std::vector<std::string> notes;
+    };
+
+    std::string m_filter;
+    std::vector<GroupResult> m_results;
+
+    /**
+     * @brief Inicia um grupo, se ele passar pelo filtro
+     * @param name Nome do grupo
+     * @return true se o grupo deve ser executado
+     */
+    bool beginGroup(const std::string& name);
+
+    /**
+     * @brief Registra uma verificação do grupo atual
+     * @param condition Resultado da verificação
+     * @param description Descrição usada no log em caso de falha
+     * @return O próprio resultado
+     */
+    bool expect(bool condition, const std::string& description);
+
+    /**
+     * @brief Registra uma medida do grupo atual, mostrada no log junto com o resultado
+     * @param text Medida
+     */
+    void note(const std::string& text);
+
+    /**
+     * @brief Thread de saída com destino lento: a entrada não bloqueia e o estado mais recente chega
+     */
+    void testOutputThread();
+
+    /**
+     * @brief Taxa fixa: no máximo um envio por tick, botões fora do tick e estado repetido suprimido
+     */
+    void testOutputRate();
+
+    /**
+     * @brief Tradução para o relatório do DualShock 4 conferida byte a byte com vetores de referência
+     */
+    void testDs4Packing();
+
+    /**
+     * @brief Rajada de notificações de retorno com consumidor lento: o driver nunca espera e as perdas são contadas
+     */
+    void testFeedbackBurst();
+
+    /**
+     * @brief SeqLock com um escritor e vários leitores: nenhuma leitura parcial e sequência monotônica
+     */
+    void testSeqLockStress();
+
+    /**
+     * @brief Alinhamento de fase ativado por notificações ou pela taxa de quadros: eixos continuam chegando
+     */
+    void testPhaseAlign();
+
+    /**
+     * @brief Destino que desconecta: modo degradado, reconexão, toque preservado e saída do modo
+     */
+    void testOutputFaults();
+
+    /**
+     * @brief Movimento do mouse evento a evento e em lote: as mesmas ações, com os dois eixos
+     */
+    void testMouseMapping();
+
+    /**
+     * @brief Filtro dos analógicos por amostra e no tick: redução de jitter e atraso adicionado
+     */
+    void testStickFilter();
+
+    /**
+     * @brief Dois controles em um barramento simulado: uma conexão, índices independentes e reenvio após falha
+     */
+    void testBusSharing();
+
+    /**
+     * @brief Fusão: cada regra por campo, reprodução de controle em laço e envio de mudanças só da fonte no tick
+     */
+    void testInputFusion();
+
+    /**
+     * @brief Gravação de entrada com vários blocos: leitura idêntica e captura sem esperar pelo disco
+     */
+    void testInputRecording();
+
+    /**
+     * @brief Reprodução: duas execuções idênticas, imediata e com taxa fixa, e leitura dos relatórios gravados
+     */
+    void testReplayDeterminism();
+
+    /**
+     * @brief Regras condicionais: allow, block, scale e remap, soltura sem botão preso e erros de compilação
+     */
+    void testMappingRules();
+
+    /**
+     * @brief Histograma de latência: percentis de distribuições conhecidas e soma dos blocos de várias threads
+     */
+    void testLatencyHistogram();
+
+    /**
+     * @brief Jitter dos ticks: só prazos periódicos entram nas estatísticas, não os avulsos
+     */
+    void testTickJitter();
+
+    /**
+     * @brief Contadores incrementados por várias threads: totais exatos e leituras monotônicas durante a escrita
+     */
+    void testPipelineCounters();
+
+    /**
+     * @brief Rastreamento exportado durante e após a gravação: JSON válido, instantes em ordem e intervalos aninhados
+     */
+    void testTraceExport();
+};
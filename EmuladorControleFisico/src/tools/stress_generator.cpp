@@ -0,0 +1,314 @@
+/**
+ * @file stress_generator.cpp
+ * @brief Implementação do gerador de carga sintética
+ */
+
+#include "stress_generator.h"
+#include "scratch_config.h"
+#include "../core/event_mapper.h"
+#include "../core/input_pipeline.h"
+#include "../core/output_sink.h"
+#include "../core/shard_router.h"
+#include "../core/virtual_controller.h"
+#include "../utils/clock.h"
+#include "../utils/command_line.h"
+#include "../utils/latency_histogram.h"
+#include "../utils/logger.h"
+#include "../utils/pipeline_counters.h"
+#include "../utils/tick_source.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const int MAX_DEVICES = 10;
+const int UNTHROTTLED_BATCH = 1000;
+const int64_t DRAIN_TIMEOUT_MICROS = 1000000;
+
+// Teclas pressionadas juntas nas rajadas (mapeadas e não mapeadas)
+const WORD ROLLOVER_KEYS[] = {
+    DIK_W, DIK_A, DIK_S, DIK_D, DIK_SPACE, DIK_LCONTROL, DIK_E, DIK_R,
+    DIK_Q, DIK_F, DIK_Z, DIK_C, DIK_1, DIK_2, DIK_3, DIK_4
+};
+const int ROLLOVER_KEY_COUNT = sizeof(ROLLOVER_KEYS) / sizeof(ROLLOVER_KEYS[0]);
+
+} // namespace
+
+/**
+ * @struct StressGenerator::Shard
+ * @brief Caminho completo de um shard, com configuração descartável e destino nulo
+ */
+struct StressGenerator::Shard {
+    ScratchConfig config;
+    EventMapper mapper;
+    NullOutputSink sink;
+    VirtualController controller;
+    InputPipeline pipeline;
+
+    explicit Shard(int index)
+        : config("stress_shard_" + std::to_string(index) + ".tmp.json"),
+          mapper(config.get()) {
+    }
+};
+
+// StressOptions
+
+StressOptions::StressOptions()
+    : scenario(STRESS_MIXED), rateHz(8000), seconds(10), devices(1), shards(1),
+      burstEveryMs(0), burstMs(50), burstFactor(4), outputRateHz(0),
+      pipelineSpec("filter,map,apply") {
+}
+
+StressOptions StressOptions::fromCommandLine(const CommandLine& commandLine) {
+    StressOptions options;
+
+    const std::string scenario = commandLine.getValue("--stress-scenario", "mixed");
+    if (scenario == "mouse") {
+        options.scenario = STRESS_MOUSE;
+    } else if (scenario == "rollover") {
+        options.scenario = STRESS_ROLLOVER;
+    } else if (scenario == "wheel") {
+        options.scenario = STRESS_WHEEL;
+    } else if (scenario != "mixed") {
+        Logger::warning("Cenário de carga desconhecido: " + scenario + " (usando mixed)");
+    }
+
+    options.rateHz = std::max(0, commandLine.getIntValue("--stress-rate", options.rateHz));
+    options.seconds = std::max(1, commandLine.getIntValue("--stress-seconds", options.seconds));
+    options.devices = std::max(1, std::min(MAX_DEVICES, commandLine.getIntValue("--stress-devices", options.devices)));
+    options.shards = std::max(1, std::min(ShardRouter::MAX_SHARDS, commandLine.getIntValue("--stress-shards", options.shards)));
+    options.burstEveryMs = std::max(0, commandLine.getIntValue("--stress-burst-every", options.burstEveryMs));
+    options.burstMs = std::max(1, commandLine.getIntValue("--stress-burst-ms", options.burstMs));
+    options.burstFactor = std::max(1, commandLine.getIntValue("--stress-burst-factor", options.burstFactor));
+    options.outputRateHz = std::max(0, commandLine.getIntValue("--stress-output-rate", options.outputRateHz));
+    options.pipelineSpec = commandLine.getValue("--stress-pipeline", options.pipelineSpec);
+    return options;
+}
+
+// StressGenerator
+
+StressGenerator::StressGenerator(const StressOptions& options)
+    : m_options(options), m_sequence(0), m_random(0x9E3779B9u) {
+}
+
+StressGenerator::~StressGenerator() {
+}
+
+const char* StressGenerator::getScenarioName(StressScenario scenario) {
+    switch (scenario) {
+        case STRESS_MOUSE:
+            return "mouse";
+        case STRESS_ROLLOVER:
+            return "rollover";
+        case STRESS_WHEEL:
+            return "wheel";
+        default:
+            return "mixed";
+    }
+}
+
+uint32_t StressGenerator::nextRandom() {
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+    return m_random;
+}
+
+bool StressGenerator::setupShards() {
+    for (int i = 0; i < m_options.shards; ++i) {
+        m_shards.emplace_back(new Shard(i));
+        Shard& shard = *m_shards.back();
+
+        shard.controller.setOutputRate(m_options.outputRateHz);
+        if (!shard.controller.initialize(&shard.sink)) {
+            Logger::error("Falha ao inicializar o controle virtual do shard " + std::to_string(i));
+            return false;
+        }
+
+        // Sem driver não há como repassar eventos: o estágio passthrough só é usado se pedido
+        shard.pipeline.registerStage(new FilterStage());
+        shard.pipeline.registerStage(new MapStage(&shard.mapper));
+        shard.pipeline.registerStage(new ApplyStage(&shard.controller));
+        shard.pipeline.registerStage(new PassThroughStage(&m_interceptManager));
+        if (!shard.pipeline.configure(m_options.pipelineSpec) || !shard.pipeline.start()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+InputEvent StressGenerator::nextEvent(StressScenario scenario) {
+    if (scenario == STRESS_MIXED) {
+        const uint32_t pick = nextRandom() % 10;
+        scenario = pick < 7 ? STRESS_MOUSE : (pick < 9 ? STRESS_ROLLOVER : STRESS_WHEEL);
+    }
+
+    const uint64_t sequence = m_sequence++;
+    const int device = static_cast<int>(sequence % m_options.devices);
+    InputEvent event;
+
+    switch (scenario) {
+        case STRESS_ROLLOVER: {
+            // Ciclos de todas as teclas pressionadas em ordem e depois soltas em ordem
+            const int step = static_cast<int>(sequence % (2 * ROLLOVER_KEY_COUNT));
+            event.type = InputEvent::TYPE_KEYBOARD;
+            event.deviceId = 1 + device;
+            event.data.keyboard.code = ROLLOVER_KEYS[step % ROLLOVER_KEY_COUNT];
+            event.data.keyboard.state = step < ROLLOVER_KEY_COUNT ? INTERCEPTION_KEY_DOWN : INTERCEPTION_KEY_UP;
+            break;
+        }
+
+        case STRESS_WHEEL:
+            event.type = InputEvent::TYPE_MOUSE;
+            event.deviceId = INTERCEPTION_MAX_KEYBOARD + 1 + device;
+            event.data.mouse.state = INTERCEPTION_MOUSE_WHEEL;
+            event.data.mouse.rolling = (sequence & 1) ? 120 : -120;
+            break;
+
+        default:
+            event.type = InputEvent::TYPE_MOUSE;
+            event.deviceId = INTERCEPTION_MAX_KEYBOARD + 1 + device;
+            event.data.mouse.flags = INTERCEPTION_MOUSE_MOVE_RELATIVE;
+            event.data.mouse.x = static_cast<int>(nextRandom() % 21) - 10;
+            event.data.mouse.y = static_cast<int>(nextRandom() % 21) - 10;
+            break;
+    }
+
+    return event;
+}
+
+bool StressGenerator::run() {
+    if (!setupShards()) {
+        Logger::error("Falha ao montar os shards do teste de carga");
+        return false;
+    }
+
+    // Dispositivos distribuídos entre os shards; teclado e mouse de mesmo índice no mesmo shard
+    ShardRouter router(&m_interceptManager);
+    for (auto& shard : m_shards) {
+        router.addShard(&shard->pipeline);
+    }
+    for (int device = 0; device < m_options.devices; ++device) {
+        router.assignDevice(1 + device, device % m_options.shards);
+        router.assignDevice(INTERCEPTION_MAX_KEYBOARD + 1 + device, device % m_options.shards);
+    }
+    router.setDefaultShard(0);
+    if (!router.start()) {
+        return false;
+    }
+
+    char line[200];
+    snprintf(line, sizeof(line), "Teste de carga: cenário %s, %d eventos/s%s, %d s, %d dispositivos, %d shards",
+             getScenarioName(m_options.scenario), m_options.rateHz, m_options.rateHz ? "" : " (sem limite)",
+             m_options.seconds, m_options.devices, m_options.shards);
+    Logger::info(line);
+    if (m_options.burstEveryMs > 0) {
+        Logger::info("Rajadas de " + std::to_string(m_options.burstMs) + " ms a cada " +
+                     std::to_string(m_options.burstEveryMs) + " ms (taxa x" + std::to_string(m_options.burstFactor) + ")");
+    }
+
+    const CounterSnapshot before = PipelineCounters::snapshot();
+    Clock* clock = Clock::getDefault();
+    TickSource ticks(1000);
+    ticks.open();
+
+    const int64_t start = clock->nowMicros();
+    const int64_t end = start + static_cast<int64_t>(m_options.seconds) * 1000000;
+    int64_t now = start;
+    int64_t lastBudgetUpdate = start;
+    double budget = 0.0;
+    uint64_t generated = 0;
+    uint64_t depthSamples = 0;
+    uint64_t depthTotal = 0;
+    size_t depthMax = 0;
+
+    while (now < end) {
+        int batch = UNTHROTTLED_BATCH;
+        if (m_options.rateHz > 0) {
+            ticks.waitNextTick();
+            now = clock->nowMicros();
+
+            // Orçamento pelo tempo decorrido, para compensar ticks atrasados
+            const int64_t elapsedMs = (now - start) / 1000;
+            const bool burst = m_options.burstEveryMs > 0 && (elapsedMs % m_options.burstEveryMs) < m_options.burstMs;
+            const double rate = static_cast<double>(m_options.rateHz) * (burst ? m_options.burstFactor : 1);
+            budget += rate * (now - lastBudgetUpdate) / 1000000.0;
+            lastBudgetUpdate = now;
+            batch = static_cast<int>(budget);
+            budget -= batch;
+        }
+
+        for (int i = 0; i < batch; ++i) {
+            InputEvent event = nextEvent(m_options.scenario);
+            event.timestamp = clock->nowMicros();
+            router.dispatch(event);
+        }
+        generated += batch;
+
+        size_t depth = 0;
+        for (int i = 0; i < router.getShardCount(); ++i) {
+            depth += router.getQueueDepth(i) + m_shards[i]->pipeline.getQueueDepth();
+        }
+        depthTotal += depth;
+        depthMax = std::max(depthMax, depth);
+        ++depthSamples;
+
+        now = clock->nowMicros();
+    }
+
+    const int64_t generationMicros = now - start;
+
+    // Esperar as filas esvaziarem antes de encerrar as threads
+    bool drained = false;
+    while (!drained && clock->nowMicros() - now < DRAIN_TIMEOUT_MICROS) {
+        drained = true;
+        for (int i = 0; i < router.getShardCount(); ++i) {
+            if (router.getQueueDepth(i) > 0 || m_shards[i]->pipeline.getQueueDepth() > 0) {
+                drained = false;
+            }
+        }
+        if (!drained) {
+            Sleep(1);
+        }
+    }
+
+    router.stop();
+    for (auto& shard : m_shards) {
+        shard->pipeline.stop();
+    }
+
+    const CounterSnapshot after = PipelineCounters::snapshot();
+    const auto delta = [&](PipelineCounter counter) { return after.values[counter] - before.values[counter]; };
+    const double seconds = generationMicros / 1000000.0;
+
+    const std::string target = m_options.rateHz ? std::to_string(m_options.rateHz) + "/s" : "sem limite";
+    snprintf(line, sizeof(line), "Gerados %llu eventos em %.2f s: %.0f eventos/s (alvo %s)",
+             static_cast<unsigned long long>(generated), seconds, generated / seconds, target.c_str());
+    Logger::info(line);
+
+    const uint64_t strokes = delta(COUNTER_KEYBOARD_STROKES) + delta(COUNTER_MOUSE_STROKES);
+    const uint64_t actions = delta(COUNTER_BUTTON_ACTIONS) + delta(COUNTER_AXIS_ACTIONS) + delta(COUNTER_TRIGGER_ACTIONS);
+    snprintf(line, sizeof(line), "Processados: %llu eventos, %llu filtrados, %llu ações, %llu envios, %llu repetidos suprimidos",
+             static_cast<unsigned long long>(strokes), static_cast<unsigned long long>(delta(COUNTER_FILTERED_STROKES)),
+             static_cast<unsigned long long>(actions), static_cast<unsigned long long>(delta(COUNTER_SUBMITS)),
+             static_cast<unsigned long long>(delta(COUNTER_SUPPRESSED_REPEATS)));
+    Logger::info(line);
+
+    snprintf(line, sizeof(line), "Filas: profundidade média %.1f, máxima %llu, %llu inserções com fila cheia%s",
+             depthSamples ? static_cast<double>(depthTotal) / depthSamples : 0.0, static_cast<unsigned long long>(depthMax),
+             static_cast<unsigned long long>(delta(COUNTER_QUEUE_OVERFLOWS)), drained ? "" : " (filas não esvaziaram)");
+    Logger::info(line);
+
+    if (m_options.rateHz > 0) {
+        const TickStats tickStats = ticks.getStats();
+        if (tickStats.skippedTicks > 0) {
+            Logger::warning("Gerador atrasado: " + std::to_string(tickStats.skippedTicks) + " ticks de 1 ms perdidos");
+        }
+    }
+
+    LatencyRegistry::logSummary();
+    for (auto& shard : m_shards) {
+        shard->pipeline.logStageStats();
+    }
+    return true;
+}
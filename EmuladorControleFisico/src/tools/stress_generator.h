@@ -0,0 +1,118 @@
+/**
+ * @file stress_generator.h
+ * @brief Gerador de carga sintética para o pipeline de entrada
+ */
+
+#pragma once
+
+#include "../core/interception_manager.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CommandLine;
+
+/**
+ * @enum StressScenario
+ * @brief Composição dos eventos gerados
+ */
+enum StressScenario {
+    STRESS_MOUSE,      // Movimento relativo contínuo (ex.: mouse de 8 kHz)
+    STRESS_ROLLOVER,   // Rajadas de várias teclas pressionadas e soltas em sequência
+    STRESS_WHEEL,      // Roda do mouse sem pausa
+    STRESS_MIXED       // 70% movimento, 20% teclado, 10% roda
+};
+
+/**
+ * @struct StressOptions
+ * @brief Parâmetros de uma execução de carga
+ */
+struct StressOptions {
+    StressScenario scenario;
+    int rateHz;              // Eventos por segundo (0 = o mais rápido possível)
+    int seconds;             // Duração da geração
+    int devices;             // Dispositivos de cada tipo (1 a 10)
+    int shards;              // Shards de processamento (1 a ShardRouter::MAX_SHARDS)
+    int burstEveryMs;        // Período das rajadas (0 = sem rajadas)
+    int burstMs;             // Duração de cada rajada
+    int burstFactor;         // Multiplicador da taxa durante a rajada
+    int outputRateHz;        // Taxa de envio do controle virtual (0 = imediato)
+    std::string pipelineSpec;
+
+    StressOptions();
+
+    /**
+     * @brief Lê as opções --stress-* da linha de comando
+     * @param commandLine Linha de comando
+     * @return Opções, com padrões para as ausentes
+     */
+    static StressOptions fromCommandLine(const CommandLine& commandLine);
+};
+
+/**
+ * @class StressGenerator
+ * @brief Sintetiza eventos a uma taxa controlada e os passa pelo caminho real de mapeamento e saída
+ *
+ * O gerador faz o papel da thread de captura: monta um ShardRouter com um
+ * EventMapper, um VirtualController e um pipeline por shard, todos com
+ * destino de saída nulo, e despacha os eventos sintéticos com o instante de
+ * geração como instante de captura. Roda sem driver nem janela.
+ *
+ * Ao final registra no log a vazão obtida, a profundidade das filas, os
+ * contadores do pipeline e a distribuição de latência.
+ */
+class StressGenerator {
+public:
+    /**
+     * @brief Construtor
+     * @param options Parâmetros da execução
+     */
+    explicit StressGenerator(const StressOptions& options);
+
+    /**
+     * @brief Destrutor
+     */
+    ~StressGenerator();
+
+    /**
+     * @brief Monta os shards, gera a carga e registra o relatório
+     * @return true se executado, false se a montagem falhou
+     */
+    bool run();
+
+    /**
+     * @brief Obtém o nome de um cenário
+     * @param scenario Cenário
+     * @return Nome usado em --stress-scenario
+     */
+    static const char* getScenarioName(StressScenario scenario);
+
+private:
+    struct Shard;
+
+    StressOptions m_options;
+    InterceptionManager m_interceptManager;  // Nunca inicializado: nenhum evento é repassado
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    uint64_t m_sequence;
+    uint32_t m_random;
+
+    /**
+     * @brief Cria mapeador, controle virtual e pipeline de cada shard
+     * @return true se todos foram criados
+     */
+    bool setupShards();
+
+    /**
+     * @brief Gera o próximo evento do cenário
+     * @param scenario Cenário
+     * @return Evento sintético
+     */
+    InputEvent nextEvent(StressScenario scenario);
+
+    /**
+     * @brief Gerador pseudoaleatório determinístico (xorshift)
+     * @return Próximo valor
+     */
+    uint32_t nextRandom();
+};
@@ -6,7 +6,10 @@
 
 #include "main_window.h"
 #include "../utils/logger.h"
+#include "../core/feedback_channel.h"
+#include "../core/virtual_controller.h"
 #include <commctrl.h>
+#include <cstdio>
 #include <string>
 #include <sstream>
 
@@ -20,6 +23,9 @@
 #define IDC_DEADZONE_VALUE 107
 #define IDC_SAVE_BUTTON 108
 #define IDC_TOGGLE_BUTTON 109
+#define IDC_FEEDBACK_LABEL 110
+#define IDC_PAD_STATE_LABEL 111
+#define IDC_RATES_LABEL 112
 
 // Timer para atualização da interface
 #define TIMER_UPDATE_UI 1001
@@ -32,7 +38,8 @@ MainWindow* g_mainWindow = nullptr;
 
 MainWindow::MainWindow(HINSTANCE hInstance, ConfigManager* configManager, std::atomic<bool>* emulationActive)
     : m_hInstance(hInstance), m_hWnd(NULL), m_configManager(configManager), 
-      m_emulationActive(emulationActive), m_mouseSensitivity(1.0f), m_deadzone(3200) {
+      m_emulationActive(emulationActive), m_feedbackChannel(nullptr), m_virtualController(nullptr),
+      m_feedbackLabel(NULL), m_padStateLabel(NULL), m_ratesLabel(NULL), m_mouseSensitivity(1.0f), m_deadzone(3200) {
     
     // Carregar configurações
     if (m_configManager) {
@@ -80,6 +87,14 @@ int MainWindow::run(int nCmdShow) {
     return (int)msg.wParam;
 }
 
+void MainWindow::setFeedbackChannel(FeedbackChannel* feedbackChannel) {
+    m_feedbackChannel = feedbackChannel;
+}
+
+void MainWindow::setVirtualController(const VirtualController* virtualController) {
+    m_virtualController = virtualController;
+}
+
 bool MainWindow::initWindow() {
     // Registrar classe da janela
     WNDCLASSEX wcex;
@@ -142,6 +157,19 @@ void MainWindow::createControls() {
     );
     SendMessage(m_statusLabel, WM_SETFONT, (WPARAM)hFont, TRUE);
     
+    // Criar indicador de vibração pedida pelo jogo
+    m_feedbackLabel = CreateWindow(
+        "STATIC",
+        "",
+        WS_CHILD | WS_VISIBLE | SS_CENTER,
+        10, 48, 460, 18,
+        m_hWnd,
+        (HMENU)IDC_FEEDBACK_LABEL,
+        m_hInstance,
+        NULL
+    );
+    SendMessage(m_feedbackLabel, WM_SETFONT, (WPARAM)hFont, TRUE);
+    
     // Criar controles para sensibilidade do mouse
     CreateWindow(
         "STATIC",
@@ -246,6 +274,32 @@ void MainWindow::createControls() {
     );
     SendMessage(toggleButton, WM_SETFONT, (WPARAM)hFont, TRUE);
     
+    // Estado atual do controle virtual
+    m_padStateLabel = CreateWindow(
+        "STATIC",
+        "",
+        WS_CHILD | WS_VISIBLE | SS_CENTER,
+        10, 280, 460, 20,
+        m_hWnd,
+        (HMENU)IDC_PAD_STATE_LABEL,
+        m_hInstance,
+        NULL
+    );
+    SendMessage(m_padStateLabel, WM_SETFONT, (WPARAM)hFont, TRUE);
+    
+    // Taxas por segundo do pipeline
+    m_ratesLabel = CreateWindow(
+        "STATIC",
+        "",
+        WS_CHILD | WS_VISIBLE | SS_CENTER,
+        10, 305, 460, 20,
+        m_hWnd,
+        (HMENU)IDC_RATES_LABEL,
+        m_hInstance,
+        NULL
+    );
+    SendMessage(m_ratesLabel, WM_SETFONT, (WPARAM)hFont, TRUE);
+    
     // Atualizar valores iniciais
     updateUI();
 }
@@ -270,6 +324,37 @@ void MainWindow::updateUI() {
     }
     SetWindowText(m_statusLabel, statusText.c_str());
     
+    // Atualizar indicador de vibração com o estado mais recente do canal de retorno
+    FeedbackEvent feedback;
+    if (m_feedbackChannel && m_feedbackChannel->getLatest(feedback)) {
+        std::string feedbackText = "Vibração: grave " + std::to_string(feedback.largeMotor * 100 / 255) +
+                                   "% / agudo " + std::to_string(feedback.smallMotor * 100 / 255) + "%";
+        SetWindowText(m_feedbackLabel, feedbackText.c_str());
+    }
+    
+    // Atualizar estado do controle com uma cópia consistente, sem bloquear a thread de saída
+    ControllerSnapshot snapshot;
+    if (m_virtualController && m_virtualController->getSnapshot(snapshot)) {
+        char padText[128];
+        snprintf(padText, sizeof(padText), "LX %6d  LY %6d  RX %6d  RY %6d  LT %3u  RT %3u  Botões 0x%04X",
+                 snapshot.report.sThumbLX, snapshot.report.sThumbLY, snapshot.report.sThumbRX,
+                 snapshot.report.sThumbRY, snapshot.report.bLeftTrigger, snapshot.report.bRightTrigger,
+                 snapshot.report.wButtons);
+        SetWindowText(m_padStateLabel, padText);
+    }
+    
+    // Atualizar taxas do pipeline (recalculadas no máximo uma vez por segundo)
+    if (m_rateMeter.update()) {
+        char ratesText[160];
+        snprintf(ratesText, sizeof(ratesText), "Entrada %.0f/s  Ações %.0f/s  Repasse %.0f/s  Envios %.0f/s  Falhas %.0f/s",
+                 m_rateMeter.getRate(COUNTER_KEYBOARD_STROKES) + m_rateMeter.getRate(COUNTER_MOUSE_STROKES),
+                 m_rateMeter.getRate(COUNTER_BUTTON_ACTIONS) + m_rateMeter.getRate(COUNTER_AXIS_ACTIONS) +
+                     m_rateMeter.getRate(COUNTER_TRIGGER_ACTIONS),
+                 m_rateMeter.getRate(COUNTER_PASSED_THROUGH), m_rateMeter.getRate(COUNTER_SUBMITS),
+                 m_rateMeter.getRate(COUNTER_SUBMIT_FAILURES));
+        SetWindowText(m_ratesLabel, ratesText);
+    }
+    
     // Atualizar texto do botão de toggle
     SetWindowText(GetDlgItem(m_hWnd, IDC_TOGGLE_BUTTON), 
                  (*m_emulationActive) ? "Desativar Emulação" : "Ativar Emulação");
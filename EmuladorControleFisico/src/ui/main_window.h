@@ -10,6 +10,10 @@
 #include <string>
 #include <atomic>
 #include "../utils/config_manager.h"
+#include "../utils/pipeline_counters.h"
+
+class FeedbackChannel;
+class VirtualController;
 
 /**
  * @class MainWindow
@@ -36,15 +40,32 @@ public:
      * @return Código de saída do aplicativo
      */
     int run(int nCmdShow);
+    
+    /**
+     * @brief Define o canal de retorno exibido no indicador de vibração
+     * @param feedbackChannel Canal de retorno (nullptr oculta o indicador; não assume a posse)
+     */
+    void setFeedbackChannel(FeedbackChannel* feedbackChannel);
+    
+    /**
+     * @brief Define o controle virtual cujo estado é exibido na janela
+     * @param virtualController Controle virtual (nullptr oculta o estado; não assume a posse)
+     */
+    void setVirtualController(const VirtualController* virtualController);
 
 private:
     HINSTANCE m_hInstance;
     HWND m_hWnd;
     ConfigManager* m_configManager;
     std::atomic<bool>* m_emulationActive;
+    FeedbackChannel* m_feedbackChannel;
+    const VirtualController* m_virtualController;
     
     // Controles da interface
     HWND m_statusLabel;
+    HWND m_feedbackLabel;
+    HWND m_padStateLabel;
+    HWND m_ratesLabel;
     HWND m_sensitivitySlider;
     HWND m_sensitivityValue;
     HWND m_deadzoneSlider;
@@ -54,6 +75,9 @@ private:
     float m_mouseSensitivity;
     int m_deadzone;
     
+    // Taxas do pipeline exibidas na janela
+    CounterRateMeter m_rateMeter;
+    
     /**
      * @brief Inicializa a janela
      * @return true se inicializada com sucesso, false caso contrário
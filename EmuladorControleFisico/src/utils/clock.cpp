@@ -0,0 +1,39 @@
+/**
+ * @file clock.cpp
+ * @brief Implementação dos relógios real e simulado
+ */
+
+#include "clock.h"
+#include <chrono>
+
+Clock* Clock::getDefault() {
+    static SteadyClock steadyClock;
+    return &steadyClock;
+}
+
+int64_t SteadyClock::nowMicros() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SimulatedClock::SimulatedClock(int64_t startMicros)
+    : m_now(startMicros) {
+}
+
+int64_t SimulatedClock::nowMicros() const {
+    return m_now.load(std::memory_order_acquire);
+}
+
+void SimulatedClock::setMicros(int64_t micros) {
+    // Manter a monotonicidade mesmo com timestamps fora de ordem
+    int64_t current = m_now.load(std::memory_order_relaxed);
+    while (micros > current &&
+           !m_now.compare_exchange_weak(current, micros, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+void SimulatedClock::advanceMicros(int64_t micros) {
+    if (micros > 0) {
+        m_now.fetch_add(micros, std::memory_order_release);
+    }
+}
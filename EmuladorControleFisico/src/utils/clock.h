@@ -0,0 +1,73 @@
+/**
+ * @file clock.h
+ * @brief Abstração de relógio monotônico (real ou simulado)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class Clock
+ * @brief Fonte de tempo monotônico em microssegundos
+ *
+ * Componentes que dependem de tempo recebem um Clock em vez de consultar
+ * std::chrono diretamente, para que gravações possam ser reproduzidas de
+ * forma determinística e mais rápida que o tempo real.
+ */
+class Clock {
+public:
+    virtual ~Clock() {}
+
+    /**
+     * @brief Obtém o instante atual
+     * @return Tempo monotônico em microssegundos
+     */
+    virtual int64_t nowMicros() const = 0;
+
+    /**
+     * @brief Obtém o relógio real do sistema, compartilhado pelo processo
+     * @return Relógio monotônico real
+     */
+    static Clock* getDefault();
+};
+
+/**
+ * @class SteadyClock
+ * @brief Relógio real baseado em std::chrono::steady_clock
+ */
+class SteadyClock : public Clock {
+public:
+    int64_t nowMicros() const override;
+};
+
+/**
+ * @class SimulatedClock
+ * @brief Relógio controlado manualmente, avançado pelos timestamps reproduzidos
+ */
+class SimulatedClock : public Clock {
+public:
+    /**
+     * @brief Construtor
+     * @param startMicros Instante inicial em microssegundos
+     */
+    explicit SimulatedClock(int64_t startMicros = 0);
+
+    int64_t nowMicros() const override;
+
+    /**
+     * @brief Define o instante atual (nunca volta no tempo)
+     * @param micros Novo instante em microssegundos
+     */
+    void setMicros(int64_t micros);
+
+    /**
+     * @brief Avança o relógio
+     * @param micros Intervalo em microssegundos
+     */
+    void advanceMicros(int64_t micros);
+
+private:
+    std::atomic<int64_t> m_now;
+};
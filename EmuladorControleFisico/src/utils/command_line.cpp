@@ -0,0 +1,83 @@
+/**
+ * @file command_line.cpp
+ * @brief Implementação da leitura da linha de comando
+ */
+
+#include "command_line.h"
+#include "logger.h"
+#include <cctype>
+
+CommandLine::CommandLine(const std::string& commandLine) {
+    std::string current;
+    bool quoted = false;
+    bool hasToken = false;
+
+    for (char c : commandLine) {
+        if (c == '"') {
+            quoted = !quoted;
+            hasToken = true;
+        } else if (!quoted && isspace(static_cast<unsigned char>(c))) {
+            if (hasToken) {
+                m_args.push_back(current);
+                current.clear();
+                hasToken = false;
+            }
+        } else {
+            current += c;
+            hasToken = true;
+        }
+    }
+
+    if (hasToken) {
+        m_args.push_back(current);
+    }
+}
+
+const std::string* CommandLine::find(const std::string& name) const {
+    for (const std::string& arg : m_args) {
+        if (arg.compare(0, name.size(), name) == 0 && (arg.size() == name.size() || arg[name.size()] == '=')) {
+            return &arg;
+        }
+    }
+    return nullptr;
+}
+
+bool CommandLine::hasFlag(const std::string& name) const {
+    return find(name) != nullptr;
+}
+
+std::string CommandLine::getValue(const std::string& name, const std::string& defaultValue) const {
+    const std::string* arg = find(name);
+    if (!arg || arg->size() == name.size()) {
+        return defaultValue;
+    }
+    return arg->substr(name.size() + 1);
+}
+
+int CommandLine::getIntValue(const std::string& name, int defaultValue) const {
+    const std::string value = getValue(name);
+    if (value.empty()) {
+        return defaultValue;
+    }
+
+    try {
+        return std::stoi(value);
+    } catch (...) {
+        Logger::warning("Valor inválido para " + name + ": " + value);
+        return defaultValue;
+    }
+}
+
+double CommandLine::getDoubleValue(const std::string& name, double defaultValue) const {
+    const std::string value = getValue(name);
+    if (value.empty()) {
+        return defaultValue;
+    }
+
+    try {
+        return std::stod(value);
+    } catch (...) {
+        Logger::warning("Valor inválido para " + name + ": " + value);
+        return defaultValue;
+    }
+}
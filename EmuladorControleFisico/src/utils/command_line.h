@@ -0,0 +1,63 @@
+/**
+ * @file command_line.h
+ * @brief Leitura das opções passadas na linha de comando
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @class CommandLine
+ * @brief Separa a linha de comando em argumentos e consulta opções "--nome" e "--nome=valor"
+ */
+class CommandLine {
+public:
+    /**
+     * @brief Construtor
+     * @param commandLine Linha de comando sem o nome do programa (aspas agrupam espaços)
+     */
+    explicit CommandLine(const std::string& commandLine);
+
+    /**
+     * @brief Verifica se uma opção foi passada, com ou sem valor
+     * @param name Nome da opção (ex.: "--benchmark")
+     * @return true se presente
+     */
+    bool hasFlag(const std::string& name) const;
+
+    /**
+     * @brief Obtém o valor de uma opção "--nome=valor"
+     * @param name Nome da opção
+     * @param defaultValue Valor padrão se a opção não existir
+     * @return Valor da opção
+     */
+    std::string getValue(const std::string& name, const std::string& defaultValue = "") const;
+
+    /**
+     * @brief Obtém o valor inteiro de uma opção "--nome=valor"
+     * @param name Nome da opção
+     * @param defaultValue Valor padrão se a opção não existir ou for inválida
+     * @return Valor da opção
+     */
+    int getIntValue(const std::string& name, int defaultValue = 0) const;
+
+    /**
+     * @brief Obtém o valor de ponto flutuante de uma opção "--nome=valor"
+     * @param name Nome da opção
+     * @param defaultValue Valor padrão se a opção não existir ou for inválida
+     * @return Valor da opção
+     */
+    double getDoubleValue(const std::string& name, double defaultValue = 0.0) const;
+
+private:
+    std::vector<std::string> m_args;
+
+    /**
+     * @brief Procura o argumento de uma opção
+     * @param name Nome da opção
+     * @return Ponteiro para o argumento, ou nullptr se ausente
+     */
+    const std::string* find(const std::string& name) const;
+};
@@ -0,0 +1,211 @@
+/**
+ * @file latency_histogram.cpp
+ * @brief Implementação dos histogramas de latência por thread
+ */
+
+#include "latency_histogram.h"
+#include "logger.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+int highestBit(uint64_t value) {
+#ifdef _MSC_VER
+    // _BitScanReverse64 não existe em x86; procurar nas duas metades
+    unsigned long index;
+    if (_BitScanReverse(&index, static_cast<unsigned long>(value >> 32))) {
+        return static_cast<int>(index) + 32;
+    }
+    _BitScanReverse(&index, static_cast<unsigned long>(value));
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+// Incremento por um único escritor: leitura e escrita relaxadas, sem lock
+inline void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+struct ThreadBlock {
+    LatencyHistogram histograms[LATENCY_METRIC_COUNT];
+};
+
+std::mutex g_blocksMutex;
+std::vector<std::unique_ptr<ThreadBlock>>& allBlocks() {
+    static std::vector<std::unique_ptr<ThreadBlock>> blocks;
+    return blocks;
+}
+
+ThreadBlock* currentBlock() {
+    thread_local ThreadBlock* block = nullptr;
+    if (!block) {
+        std::lock_guard<std::mutex> lock(g_blocksMutex);
+        allBlocks().emplace_back(new ThreadBlock());
+        block = allBlocks().back().get();
+    }
+    return block;
+}
+
+} // namespace
+
+// LatencyHistogram
+
+LatencyHistogram::LatencyHistogram()
+    : m_count(0), m_total(0), m_max(0) {
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<int>(value);
+    }
+
+    const int exponent = highestBit(value);
+    if (exponent > MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+
+    // Os SUB_BUCKET_BITS bits abaixo do mais alto escolhem a subdivisão
+    const int sub = static_cast<int>(value >> (exponent - SUB_BUCKET_BITS)) - SUB_BUCKETS;
+    return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index);
+    }
+
+    const int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    const uint64_t sub = static_cast<uint64_t>((index - SUB_BUCKETS) % SUB_BUCKETS);
+    const uint64_t lower = (SUB_BUCKETS + sub) << shift;
+    return lower + (1ULL << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t valueNanos) {
+    bump(m_buckets[bucketIndex(valueNanos)], 1);
+    bump(m_count, 1);
+    bump(m_total, valueNanos);
+    if (valueNanos > m_max.load(std::memory_order_relaxed)) {
+        m_max.store(valueNanos, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        bump(m_buckets[i], other.m_buckets[i].load(std::memory_order_relaxed));
+    }
+    bump(m_count, other.m_count.load(std::memory_order_relaxed));
+    bump(m_total, other.m_total.load(std::memory_order_relaxed));
+
+    const uint64_t otherMax = other.m_max.load(std::memory_order_relaxed);
+    if (otherMax > m_max.load(std::memory_order_relaxed)) {
+        m_max.store(otherMax, std::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::getPercentile(double fraction) const {
+    // Somar os baldes em vez de usar m_count: com um escritor ativo os dois
+    // podem divergir por algumas amostras
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        total += m_buckets[i].load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    const uint64_t target = static_cast<uint64_t>(fraction * total + 0.5);
+    const uint64_t maxValue = m_max.load(std::memory_order_relaxed);
+    uint64_t accumulated = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        accumulated += m_buckets[i].load(std::memory_order_relaxed);
+        if (accumulated >= target && accumulated > 0) {
+            const uint64_t bound = bucketUpperBound(i);
+            return bound < maxValue ? bound : maxValue;
+        }
+    }
+    return maxValue;
+}
+
+LatencySummary LatencyHistogram::summarize() const {
+    LatencySummary summary;
+    summary.count = m_count.load(std::memory_order_relaxed);
+    summary.meanNanos = summary.count ? static_cast<double>(m_total.load(std::memory_order_relaxed)) / summary.count : 0.0;
+    summary.p50Nanos = getPercentile(0.5);
+    summary.p99Nanos = getPercentile(0.99);
+    summary.p999Nanos = getPercentile(0.999);
+    summary.maxNanos = m_max.load(std::memory_order_relaxed);
+    return summary;
+}
+
+// LatencyRegistry
+
+void LatencyRegistry::record(LatencyMetric metric, uint64_t valueNanos) {
+    currentBlock()->histograms[metric].record(valueNanos);
+}
+
+void LatencyRegistry::recordMicros(LatencyMetric metric, int64_t fromMicros, int64_t toMicros) {
+    // Eventos sem instante de captura (ex.: sintéticos) não entram na medida
+    if (fromMicros <= 0 || toMicros < fromMicros) {
+        return;
+    }
+    record(metric, static_cast<uint64_t>(toMicros - fromMicros) * 1000);
+}
+
+LatencySummary LatencyRegistry::getSummary(LatencyMetric metric) {
+    std::unique_ptr<LatencyHistogram> merged(new LatencyHistogram());
+
+    std::lock_guard<std::mutex> lock(g_blocksMutex);
+    for (const auto& block : allBlocks()) {
+        merged->add(block->histograms[metric]);
+    }
+    return merged->summarize();
+}
+
+std::string LatencyRegistry::getMetricName(LatencyMetric metric) {
+    switch (metric) {
+        case LATENCY_CAPTURE_TO_MAPPED:
+            return "captura->mapeado";
+        case LATENCY_MAPPED_TO_SUBMITTED:
+            return "mapeado->enviado";
+        case LATENCY_SUBMIT_CALL:
+            return "chamada de envio";
+        case LATENCY_PASS_THROUGH:
+            return "captura->repasse";
+        default:
+            return "desconhecida";
+    }
+}
+
+void LatencyRegistry::logSummary() {
+    for (int metric = 0; metric < LATENCY_METRIC_COUNT; ++metric) {
+        const LatencySummary summary = getSummary(static_cast<LatencyMetric>(metric));
+        if (summary.count == 0) {
+            continue;
+        }
+
+        std::ostringstream line;
+        line << "Latência " << getMetricName(static_cast<LatencyMetric>(metric)) << ": " << summary.count
+             << " amostras, média " << static_cast<uint64_t>(summary.meanNanos / 1000) << " us, p50 "
+             << summary.p50Nanos / 1000 << " us, p99 " << summary.p99Nanos / 1000 << " us, p99.9 "
+             << summary.p999Nanos / 1000 << " us, máximo " << summary.maxNanos / 1000 << " us";
+        Logger::info(line.str());
+    }
+}
+
+uint64_t LatencyRegistry::nowNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
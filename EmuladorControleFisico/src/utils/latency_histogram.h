@@ -0,0 +1,151 @@
+/**
+ * @file latency_histogram.h
+ * @brief Histogramas de latência com baldes logarítmicos, gravados por thread
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @enum LatencyMetric
+ * @brief Trechos do caminho de entrada medidos
+ */
+enum LatencyMetric {
+    LATENCY_CAPTURE_TO_MAPPED,     // Captura do evento até a ação mapeada
+    LATENCY_MAPPED_TO_SUBMITTED,   // Publicação da ação até o envio do relatório
+    LATENCY_SUBMIT_CALL,           // Duração da chamada ao destino de saída
+    LATENCY_PASS_THROUGH,          // Captura até o evento ser devolvido ao sistema
+    LATENCY_METRIC_COUNT
+};
+
+/**
+ * @struct LatencySummary
+ * @brief Percentis de um histograma, em nanossegundos
+ */
+struct LatencySummary {
+    uint64_t count;
+    double meanNanos;
+    uint64_t p50Nanos;
+    uint64_t p99Nanos;
+    uint64_t p999Nanos;
+    uint64_t maxNanos;
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief Histograma de baldes logarítmicos com 16 subdivisões por potência de dois
+ *
+ * O erro relativo de cada balde é de no máximo 1/16 (~6%), de 1 ns a ~36 min.
+ * Um único escritor chama record; leitores de outras threads podem somar o
+ * histograma a qualquer momento (os contadores são atômicos, mas o escritor
+ * não usa instruções com lock).
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_EXPONENT = 40;
+    static const int BUCKET_COUNT = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    /**
+     * @brief Registra uma amostra (apenas na thread dona do histograma)
+     * @param valueNanos Latência em nanossegundos
+     */
+    void record(uint64_t valueNanos);
+
+    /**
+     * @brief Soma outro histograma a este
+     * @param other Histograma a somar (pode estar sendo gravado por outra thread)
+     */
+    void add(const LatencyHistogram& other);
+
+    /**
+     * @brief Calcula os percentis
+     * @return Resumo do histograma
+     */
+    LatencySummary summarize() const;
+
+    /**
+     * @brief Obtém o valor abaixo do qual está a fração pedida das amostras
+     * @param fraction Fração entre 0 e 1 (ex.: 0.99)
+     * @return Limite superior do balde correspondente, em nanossegundos
+     */
+    uint64_t getPercentile(double fraction) const;
+
+    /**
+     * @brief Obtém o índice do balde de um valor
+     * @param value Valor em nanossegundos
+     * @return Índice do balde
+     */
+    static int bucketIndex(uint64_t value);
+
+    /**
+     * @brief Obtém o maior valor contido em um balde
+     * @param index Índice do balde
+     * @return Limite superior do balde
+     */
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_total;
+    std::atomic<uint64_t> m_max;
+};
+
+/**
+ * @class LatencyRegistry
+ * @brief Histogramas de latência por thread, somados sob demanda
+ *
+ * Cada thread que grava recebe, no primeiro uso, um bloco próprio com um
+ * histograma por métrica; gravar não compartilha memória entre threads.
+ * Os blocos vivem até o fim do processo, para que as amostras de threads já
+ * encerradas continuem no resumo final.
+ */
+class LatencyRegistry {
+public:
+    /**
+     * @brief Registra uma amostra no bloco da thread atual
+     * @param metric Trecho medido
+     * @param valueNanos Latência em nanossegundos
+     */
+    static void record(LatencyMetric metric, uint64_t valueNanos);
+
+    /**
+     * @brief Registra uma amostra em microssegundos (timestamps do Clock)
+     * @param metric Trecho medido
+     * @param fromMicros Início do trecho
+     * @param toMicros Fim do trecho
+     */
+    static void recordMicros(LatencyMetric metric, int64_t fromMicros, int64_t toMicros);
+
+    /**
+     * @brief Soma os blocos de todas as threads para uma métrica
+     * @param metric Trecho medido
+     * @return Resumo com percentis
+     */
+    static LatencySummary getSummary(LatencyMetric metric);
+
+    /**
+     * @brief Obtém o nome de uma métrica para log
+     * @param metric Trecho medido
+     * @return Nome da métrica
+     */
+    static std::string getMetricName(LatencyMetric metric);
+
+    /**
+     * @brief Registra no log o resumo de todas as métricas com amostras
+     */
+    static void logSummary();
+
+    /**
+     * @brief Obtém o instante atual para medir trechos curtos
+     * @return Tempo monotônico em nanossegundos
+     */
+    static uint64_t nowNanos();
+};
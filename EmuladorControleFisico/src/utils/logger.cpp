@@ -5,6 +5,9 @@
  */
 
 #include "logger.h"
+#include "clock.h"
+#include <Windows.h>
+#include <chrono>
 #include <iostream>
 #include <ctime>
 #include <iomanip>
@@ -16,35 +19,39 @@ LogLevel Logger::m_minLevel = LOG_INFO;
 bool Logger::m_consoleOutput = true;
 std::mutex Logger::m_mutex;
 bool Logger::m_initialized = false;
+Clock* Logger::m_clock = nullptr;
 
 bool Logger::init(const std::string& filename, bool consoleOutput) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    if (m_initialized) {
-        // Já inicializado, fechar arquivo atual antes de reabrir
-        if (m_logFile.is_open()) {
-            m_logFile.close();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        
+        if (m_initialized) {
+            // Já inicializado, fechar arquivo atual antes de reabrir
+            if (m_logFile.is_open()) {
+                m_logFile.close();
+            }
         }
+        
+        m_logFile.open(filename, std::ios::out | std::ios::app);
+        if (!m_logFile.is_open()) {
+            return false;
+        }
+        
+        m_consoleOutput = consoleOutput;
+        m_initialized = true;
     }
     
-    m_logFile.open(filename, std::ios::out | std::ios::app);
-    if (!m_logFile.is_open()) {
-        return false;
-    }
-    
-    m_consoleOutput = consoleOutput;
-    m_initialized = true;
-    
+    // Fora do bloqueio: log() adquire o mesmo mutex (não recursivo)
     info("Sistema de log inicializado");
     return true;
 }
 
 void Logger::shutdown() {
+    info("Sistema de log finalizado");
+    
     std::lock_guard<std::mutex> lock(m_mutex);
     
     if (m_initialized) {
-        info("Sistema de log finalizado");
-        
         if (m_logFile.is_open()) {
             m_logFile.close();
         }
@@ -58,6 +65,11 @@ void Logger::setLogLevel(LogLevel level) {
     m_minLevel = level;
 }
 
+void Logger::setClock(Clock* clock) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_clock = clock;
+}
+
 void Logger::log(LogLevel level, const std::string& message) {
     std::lock_guard<std::mutex> lock(m_mutex);
     
@@ -130,6 +142,14 @@ void Logger::critical(const std::string& message) {
 }
 
 std::string Logger::getTimestamp() {
+    if (m_clock) {
+        // Tempo monotônico do relógio injetado: segundos com microssegundos
+        const int64_t micros = m_clock->nowMicros();
+        std::stringstream ss;
+        ss << (micros / 1000000) << '.' << std::setfill('0') << std::setw(6) << (micros % 1000000);
+        return ss.str();
+    }
+    
     auto now = std::chrono::system_clock::now();
     auto time = std::chrono::system_clock::to_time_t(now);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
@@ -10,6 +10,8 @@
 #include <fstream>
 #include <mutex>
 
+class Clock;
+
 /**
  * @enum LogLevel
  * @brief Níveis de severidade para mensagens de log
@@ -47,6 +49,16 @@ public:
      */
     static void setLogLevel(LogLevel level);
     
+    /**
+     * @brief Define um relógio para os timestamps das mensagens
+     * 
+     * Com um relógio definido (ex.: SimulatedClock em reprodução), o timestamp
+     * passa a ser o tempo monotônico desse relógio em vez da data e hora local.
+     * 
+     * @param clock Relógio a ser usado (nullptr volta à data e hora local)
+     */
+    static void setClock(Clock* clock);
+    
     /**
      * @brief Registra uma mensagem de log
      * @param level Nível de severidade
@@ -90,6 +102,7 @@ private:
     static bool m_consoleOutput;
     static std::mutex m_mutex;
     static bool m_initialized;
+    static Clock* m_clock;
     
     /**
      * @brief Obtém string representando o timestamp atual
@@ -0,0 +1,142 @@
+/**
+ * @file pipeline_counters.cpp
+ * @brief Implementação dos contadores por thread
+ */
+
+#include "pipeline_counters.h"
+#include "clock.h"
+#include "logger.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Alinhado à linha de cache: blocos de threads diferentes nunca dividem uma linha
+struct alignas(64) CounterBlock {
+    std::atomic<uint64_t> values[COUNTER_COUNT];
+
+    CounterBlock() {
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            values[i].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+std::mutex g_blocksMutex;
+std::vector<std::unique_ptr<CounterBlock>>& allBlocks() {
+    static std::vector<std::unique_ptr<CounterBlock>> blocks;
+    return blocks;
+}
+
+CounterBlock* currentBlock() {
+    thread_local CounterBlock* block = nullptr;
+    if (!block) {
+        std::lock_guard<std::mutex> lock(g_blocksMutex);
+        allBlocks().emplace_back(new CounterBlock());
+        block = allBlocks().back().get();
+    }
+    return block;
+}
+
+} // namespace
+
+// PipelineCounters
+
+void PipelineCounters::increment(PipelineCounter counter, uint64_t amount) {
+    // Único escritor por bloco: leitura e escrita relaxadas, sem lock
+    std::atomic<uint64_t>& value = currentBlock()->values[counter];
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+CounterSnapshot PipelineCounters::snapshot() {
+    CounterSnapshot result;
+    result.timestampMicros = Clock::getDefault()->nowMicros();
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        result.values[i] = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(g_blocksMutex);
+    for (const auto& block : allBlocks()) {
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            result.values[i] += block->values[i].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+std::string PipelineCounters::getCounterName(PipelineCounter counter) {
+    switch (counter) {
+        case COUNTER_KEYBOARD_STROKES:
+            return "eventos de teclado";
+        case COUNTER_MOUSE_STROKES:
+            return "eventos de mouse";
+        case COUNTER_FILTERED_STROKES:
+            return "eventos filtrados";
+        case COUNTER_BUTTON_ACTIONS:
+            return "ações de botão";
+        case COUNTER_AXIS_ACTIONS:
+            return "ações de eixo";
+        case COUNTER_TRIGGER_ACTIONS:
+            return "ações de gatilho";
+        case COUNTER_PASSED_THROUGH:
+            return "eventos repassados";
+        case COUNTER_BLOCKED:
+            return "eventos bloqueados";
+        case COUNTER_SUPPRESSED_REPEATS:
+            return "envios repetidos suprimidos";
+        case COUNTER_SUBMITS:
+            return "envios";
+        case COUNTER_SUBMIT_FAILURES:
+            return "falhas de envio";
+        case COUNTER_QUEUE_OVERFLOWS:
+            return "filas cheias";
+        case COUNTER_FEEDBACK_DROPPED:
+            return "vibrações perdidas";
+        default:
+            return "desconhecido";
+    }
+}
+
+void PipelineCounters::logSummary() {
+    const CounterSnapshot totals = snapshot();
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        if (totals.values[i] > 0) {
+            Logger::info("Contador " + getCounterName(static_cast<PipelineCounter>(i)) + ": " +
+                         std::to_string(totals.values[i]));
+        }
+    }
+}
+
+// CounterRateMeter
+
+CounterRateMeter::CounterRateMeter()
+    : m_previous(PipelineCounters::snapshot()) {
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        m_rates[i] = 0.0;
+    }
+}
+
+bool CounterRateMeter::update() {
+    if (Clock::getDefault()->nowMicros() - m_previous.timestampMicros < MIN_INTERVAL_MICROS) {
+        return false;
+    }
+
+    const CounterSnapshot current = PipelineCounters::snapshot();
+    const double seconds = static_cast<double>(current.timestampMicros - m_previous.timestampMicros) / 1000000.0;
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        // Os blocos nunca são removidos, então cada total só cresce
+        m_rates[i] = (current.values[i] - m_previous.values[i]) / seconds;
+    }
+
+    m_previous = current;
+    return true;
+}
+
+double CounterRateMeter::getRate(PipelineCounter counter) const {
+    return m_rates[counter];
+}
+
+uint64_t CounterRateMeter::getTotal(PipelineCounter counter) const {
+    return m_previous.values[counter];
+}
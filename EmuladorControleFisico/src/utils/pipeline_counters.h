@@ -0,0 +1,115 @@
+/**
+ * @file pipeline_counters.h
+ * @brief Contadores do caminho de entrada e saída, gravados por thread
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @enum PipelineCounter
+ * @brief Eventos contados ao longo do pipeline
+ */
+enum PipelineCounter {
+    COUNTER_KEYBOARD_STROKES,      // Eventos de teclado capturados
+    COUNTER_MOUSE_STROKES,         // Eventos de mouse capturados
+    COUNTER_FILTERED_STROKES,      // Eventos descartados pelo filtro
+    COUNTER_BUTTON_ACTIONS,        // Ações de botão aplicadas
+    COUNTER_AXIS_ACTIONS,          // Ações de eixo aplicadas
+    COUNTER_TRIGGER_ACTIONS,       // Ações de gatilho aplicadas
+    COUNTER_PASSED_THROUGH,        // Eventos devolvidos ao sistema
+    COUNTER_BLOCKED,               // Eventos consumidos pela emulação
+    COUNTER_SUPPRESSED_REPEATS,    // Relatórios idênticos ao último, não enviados
+    COUNTER_SUBMITS,               // Relatórios enviados com sucesso
+    COUNTER_SUBMIT_FAILURES,       // Envios recusados pelo destino
+    COUNTER_QUEUE_OVERFLOWS,       // Inserções que encontraram a fila cheia
+    COUNTER_FEEDBACK_DROPPED,      // Eventos de vibração perdidos
+    COUNTER_COUNT
+};
+
+/**
+ * @struct CounterSnapshot
+ * @brief Soma dos contadores de todas as threads em um instante
+ */
+struct CounterSnapshot {
+    int64_t timestampMicros;
+    uint64_t values[COUNTER_COUNT];
+};
+
+/**
+ * @class PipelineCounters
+ * @brief Contadores por thread, somados sob demanda
+ *
+ * Cada thread recebe, no primeiro uso, um bloco próprio alinhado à linha de
+ * cache; incrementar é uma leitura e uma escrita relaxadas no bloco da
+ * thread, sem instruções com lock nem linhas compartilhadas. Os blocos vivem
+ * até o fim do processo, como em LatencyRegistry.
+ */
+class PipelineCounters {
+public:
+    /**
+     * @brief Incrementa um contador no bloco da thread atual
+     * @param counter Contador
+     * @param amount Valor a somar
+     */
+    static void increment(PipelineCounter counter, uint64_t amount = 1);
+
+    /**
+     * @brief Soma os blocos de todas as threads
+     * @return Totais com o instante da leitura
+     */
+    static CounterSnapshot snapshot();
+
+    /**
+     * @brief Obtém o nome de um contador para log
+     * @param counter Contador
+     * @return Nome do contador
+     */
+    static std::string getCounterName(PipelineCounter counter);
+
+    /**
+     * @brief Registra no log os totais diferentes de zero
+     */
+    static void logSummary();
+};
+
+/**
+ * @class CounterRateMeter
+ * @brief Deriva taxas por segundo de leituras sucessivas dos contadores
+ *
+ * Usado por um único leitor (ex.: a interface); as taxas só são recalculadas
+ * depois de um intervalo mínimo, para não oscilar com leituras muito próximas.
+ */
+class CounterRateMeter {
+public:
+    static const int64_t MIN_INTERVAL_MICROS = 1000000;
+
+    CounterRateMeter();
+
+    /**
+     * @brief Lê os contadores e recalcula as taxas se o intervalo mínimo passou
+     * @return true se as taxas foram recalculadas
+     */
+    bool update();
+
+    /**
+     * @brief Obtém a taxa de um contador na última janela
+     * @param counter Contador
+     * @return Eventos por segundo
+     */
+    double getRate(PipelineCounter counter) const;
+
+    /**
+     * @brief Obtém o total de um contador na última leitura
+     * @param counter Contador
+     * @return Total desde o início do processo
+     */
+    uint64_t getTotal(PipelineCounter counter) const;
+
+private:
+    CounterSnapshot m_previous;
+    double m_rates[COUNTER_COUNT];
+};
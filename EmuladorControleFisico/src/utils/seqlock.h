@@ -0,0 +1,90 @@
+/**
+ * @file seqlock.h
+ * @brief Publicação de valor por sequence lock: um escritor, vários leitores
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+/**
+ * @class SeqLock
+ * @brief Valor publicado por um escritor e lido sem bloqueio por qualquer número de leitores
+ *
+ * O escritor nunca espera: incrementa a sequência (ímpar = escrita em
+ * andamento), copia o valor e incrementa de novo. O leitor copia o valor e
+ * repete se a sequência mudou no meio, de modo que nunca observa um valor
+ * parcialmente escrito. O valor é guardado em palavras atômicas para que a
+ * cópia concorrente seja bem definida.
+ *
+ * @tparam T Tipo do valor (trivialmente copiável)
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock exige tipo trivialmente copiável");
+
+public:
+    SeqLock()
+        : m_sequence(0) {
+        for (size_t i = 0; i < WORD_COUNT; ++i) {
+            m_words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Publica um novo valor (apenas na thread escritora; nunca bloqueia)
+     * @param value Valor a publicar
+     */
+    void write(const T& value) {
+        uint64_t words[WORD_COUNT] = {};
+        memcpy(words, &value, sizeof(T));
+
+        const uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < WORD_COUNT; ++i) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Lê uma cópia consistente do valor mais recente (qualquer thread)
+     * @param value Recebe o valor
+     * @return Número de publicações até o valor lido (0 = nenhuma ainda)
+     */
+    uint64_t read(T& value) const {
+        uint64_t words[WORD_COUNT];
+
+        for (;;) {
+            const uint64_t before = m_sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                // Escrita em andamento: ceder e tentar novamente
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (size_t i = 0; i < WORD_COUNT; ++i) {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before) {
+                memcpy(&value, words, sizeof(T));
+                return before / 2;
+            }
+        }
+    }
+
+private:
+    static const size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(64) std::atomic<uint64_t> m_sequence;
+    std::atomic<uint64_t> m_words[WORD_COUNT];
+};
@@ -0,0 +1,100 @@
+/**
+ * @file spsc_queue.h
+ * @brief Fila limitada sem bloqueio para um produtor e um consumidor
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @class SpscQueue
+ * @brief Fila circular de capacidade fixa, sem bloqueio e sem alocação
+ *
+ * Um único produtor chama tryPush e um único consumidor chama tryPop. Quando
+ * a fila está cheia, tryPush falha imediatamente em vez de esperar.
+ *
+ * @tparam T Tipo dos elementos (copiável)
+ * @tparam Capacity Capacidade (potência de dois)
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacidade deve ser potência de dois");
+
+public:
+    SpscQueue()
+        : m_head(0), m_cachedTail(0), m_tail(0), m_cachedHead(0) {
+    }
+
+    /**
+     * @brief Insere um elemento (apenas na thread produtora)
+     * @param value Elemento a inserir
+     * @return true se inserido, false se a fila estava cheia
+     */
+    bool tryPush(const T& value) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail >= Capacity) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail >= Capacity) {
+                return false;
+            }
+        }
+
+        m_items[head & (Capacity - 1)] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove o elemento mais antigo (apenas na thread consumidora)
+     * @param value Recebe o elemento
+     * @return true se havia elemento, false se a fila estava vazia
+     */
+    bool tryPop(T& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead) {
+                return false;
+            }
+        }
+
+        value = m_items[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Obtém o número aproximado de elementos na fila
+     * @return Número de elementos
+     */
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Verifica se a fila está vazia
+     * @return true se vazia
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Obtém a capacidade da fila
+     * @return Capacidade
+     */
+    static size_t capacity() {
+        return Capacity;
+    }
+
+private:
+    // Índices do produtor e do consumidor em linhas de cache separadas;
+    // cada lado mantém uma cópia local do índice do outro
+    alignas(64) std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+    alignas(64) std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+    alignas(64) T m_items[Capacity];
+};
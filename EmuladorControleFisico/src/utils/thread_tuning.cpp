@@ -0,0 +1,146 @@
+/**
+ * @file thread_tuning.cpp
+ * @brief Implementação da prioridade e afinidade de CPU das threads
+ */
+
+#include "thread_tuning.h"
+#include "config_manager.h"
+#include "logger.h"
+#include "trace_recorder.h"
+#include <avrt.h>
+#include <sstream>
+
+ThreadTuning::ThreadTuning(const std::string& name, Priority priority, DWORD_PTR affinityMask)
+    : m_name(name), m_priority(priority), m_affinityMask(affinityMask), m_mmcssHandle(nullptr) {
+}
+
+ThreadTuning ThreadTuning::fromConfig(const ConfigManager* config, const std::string& name,
+                                      Priority defaultPriority) {
+    if (!config) {
+        return ThreadTuning(name, defaultPriority);
+    }
+
+    const Priority priority = parsePriority(config->getStringValue("thread_" + name + "_priority"), defaultPriority);
+    const DWORD_PTR mask = parseCoreList(config->getStringValue("thread_" + name + "_cores"));
+    return ThreadTuning(name, priority, mask);
+}
+
+ThreadTuning::Priority ThreadTuning::parsePriority(const std::string& name, Priority defaultPriority) {
+    if (name == "normal") return PRIORITY_NORMAL;
+    if (name == "above_normal") return PRIORITY_ABOVE_NORMAL;
+    if (name == "highest") return PRIORITY_HIGHEST;
+    if (name == "time_critical") return PRIORITY_TIME_CRITICAL;
+    if (name == "mmcss") return PRIORITY_MMCSS_GAMES;
+
+    if (!name.empty()) {
+        Logger::warning("Prioridade de thread desconhecida: " + name);
+    }
+    return defaultPriority;
+}
+
+DWORD_PTR ThreadTuning::parseCoreList(const std::string& cores) {
+    const int maxCores = static_cast<int>(sizeof(DWORD_PTR) * 8);
+    DWORD_PTR mask = 0;
+
+    std::stringstream stream(cores);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+
+        int core = -1;
+        try {
+            core = std::stoi(item);
+        } catch (...) {
+        }
+
+        if (core < 0 || core >= maxCores) {
+            Logger::warning("Núcleo inválido na afinidade de thread: " + item);
+            return 0;
+        }
+        mask |= static_cast<DWORD_PTR>(1) << core;
+    }
+
+    return mask;
+}
+
+bool ThreadTuning::apply() {
+    TraceRecorder::setThreadName(m_name);
+
+    const HANDLE thread = GetCurrentThread();
+    bool success = true;
+    std::string priorityName = getPriorityName();
+
+    // Afinidade primeiro, para que a prioridade valha já nos núcleos escolhidos
+    if (m_affinityMask != 0 && SetThreadAffinityMask(thread, m_affinityMask) == 0) {
+        Logger::warning("Falha ao definir afinidade da thread " + m_name + ": " + std::to_string(GetLastError()));
+        success = false;
+    }
+
+    if (m_priority == PRIORITY_MMCSS_GAMES) {
+        DWORD taskIndex = 0;
+        m_mmcssHandle = AvSetMmThreadCharacteristicsA("Games", &taskIndex);
+        if (m_mmcssHandle) {
+            AvSetMmThreadPriority(m_mmcssHandle, AVRT_PRIORITY_HIGH);
+        } else {
+            // Serviço MMCSS desativado: usar a maior prioridade sem tempo real
+            Logger::warning("MMCSS indisponível para a thread " + m_name + ": " + std::to_string(GetLastError()));
+            SetThreadPriority(thread, THREAD_PRIORITY_HIGHEST);
+            priorityName = "highest (fallback)";
+            success = false;
+        }
+    } else {
+        int level = THREAD_PRIORITY_NORMAL;
+        switch (m_priority) {
+            case PRIORITY_ABOVE_NORMAL:
+                level = THREAD_PRIORITY_ABOVE_NORMAL;
+                break;
+
+            case PRIORITY_HIGHEST:
+                level = THREAD_PRIORITY_HIGHEST;
+                break;
+
+            case PRIORITY_TIME_CRITICAL:
+                level = THREAD_PRIORITY_TIME_CRITICAL;
+                break;
+
+            default:
+                break;
+        }
+
+        if (!SetThreadPriority(thread, level)) {
+            Logger::warning("Falha ao definir prioridade da thread " + m_name + ": " + std::to_string(GetLastError()));
+            success = false;
+        }
+    }
+
+    std::stringstream affinity;
+    affinity << std::hex << m_affinityMask;
+    Logger::info("Thread " + m_name + " (id " + std::to_string(GetCurrentThreadId()) + "): prioridade " +
+                 priorityName + ", afinidade " + (m_affinityMask ? "0x" + affinity.str() : "todos os núcleos"));
+    return success;
+}
+
+void ThreadTuning::revert() {
+    if (m_mmcssHandle) {
+        AvRevertMmThreadCharacteristics(m_mmcssHandle);
+        m_mmcssHandle = nullptr;
+    }
+}
+
+std::string ThreadTuning::getPriorityName() const {
+    switch (m_priority) {
+        case PRIORITY_ABOVE_NORMAL:
+            return "above_normal";
+        case PRIORITY_HIGHEST:
+            return "highest";
+        case PRIORITY_TIME_CRITICAL:
+            return "time_critical";
+        case PRIORITY_MMCSS_GAMES:
+            return "mmcss (Games)";
+        case PRIORITY_NORMAL:
+        default:
+            return "normal";
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file thread_tuning.h
+ * @brief Prioridade e afinidade de CPU das threads do pipeline
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include <string>
+
+class ConfigManager;
+
+/**
+ * @class ThreadTuning
+ * @brief Configuração de prioridade e núcleos aplicada à thread que a chama
+ *
+ * Lida a partir das chaves "thread_<nome>_priority" e "thread_<nome>_cores"
+ * da configuração. A prioridade "mmcss" registra a thread na tarefa "Games"
+ * do Multimedia Class Scheduler Service; se o serviço não estiver disponível,
+ * a thread recebe THREAD_PRIORITY_HIGHEST.
+ */
+class ThreadTuning {
+public:
+    /**
+     * @enum Priority
+     * @brief Nível de prioridade da thread
+     */
+    enum Priority {
+        PRIORITY_NORMAL,
+        PRIORITY_ABOVE_NORMAL,
+        PRIORITY_HIGHEST,
+        PRIORITY_TIME_CRITICAL,
+        PRIORITY_MMCSS_GAMES
+    };
+
+    /**
+     * @brief Construtor
+     * @param name Nome da thread para log
+     * @param priority Nível de prioridade
+     * @param affinityMask Núcleos permitidos (0 = não alterar)
+     */
+    explicit ThreadTuning(const std::string& name = "", Priority priority = PRIORITY_NORMAL,
+                          DWORD_PTR affinityMask = 0);
+
+    /**
+     * @brief Lê a configuração de uma thread
+     * @param config Gerenciador de configuração (nullptr = valores padrão)
+     * @param name Nome da thread (ex.: "input", "output")
+     * @param defaultPriority Prioridade usada se a chave não existir
+     * @return Configuração lida
+     */
+    static ThreadTuning fromConfig(const ConfigManager* config, const std::string& name,
+                                   Priority defaultPriority = PRIORITY_NORMAL);
+
+    /**
+     * @brief Converte um nome ("normal", "above_normal", "highest", "time_critical", "mmcss")
+     * @param name Nome da prioridade
+     * @param defaultPriority Valor usado se o nome for desconhecido
+     * @return Prioridade correspondente
+     */
+    static Priority parsePriority(const std::string& name, Priority defaultPriority);
+
+    /**
+     * @brief Converte uma lista de núcleos ("2,3") em máscara de afinidade
+     * @param cores Índices de núcleos separados por vírgula
+     * @return Máscara de afinidade (0 se vazia ou inválida)
+     */
+    static DWORD_PTR parseCoreList(const std::string& cores);
+
+    /**
+     * @brief Aplica a configuração à thread atual e registra o resultado no log
+     * @return true se tudo foi aplicado, false se algo falhou (a thread continua funcionando)
+     */
+    bool apply();
+
+    /**
+     * @brief Desfaz o registro MMCSS da thread atual, se houver
+     */
+    void revert();
+
+    /**
+     * @brief Obtém o nome da prioridade para log
+     * @return Nome da prioridade
+     */
+    std::string getPriorityName() const;
+
+private:
+    std::string m_name;
+    Priority m_priority;
+    DWORD_PTR m_affinityMask;
+    HANDLE m_mmcssHandle;
+};
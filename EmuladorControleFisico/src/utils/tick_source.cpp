@@ -0,0 +1,210 @@
+/**
+ * @file tick_source.cpp
+ * @brief Implementação dos despertares periódicos de alta resolução
+ */
+
+#include "tick_source.h"
+#include "clock.h"
+#include "logger.h"
+#include "trace_recorder.h"
+#include <mmsystem.h>
+#include <algorithm>
+#include <cstring>
+
+TickSource::TickSource(int rateHz)
+    : m_timer(nullptr), m_highResolution(false), m_rateHz(0), m_periodMicros(0), m_nextTick(0) {
+    setRate(rateHz);
+    resetStats();
+}
+
+TickSource::~TickSource() {
+    close();
+}
+
+bool TickSource::open() {
+    if (m_timer) {
+        return true;
+    }
+
+    m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (m_timer) {
+        m_highResolution = true;
+        return true;
+    }
+
+    // Sistemas anteriores ao Windows 10 1803: timer comum com resolução de 1 ms
+    m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    if (!m_timer) {
+        Logger::error("Falha ao criar timer de espera: " + std::to_string(GetLastError()));
+        return false;
+    }
+
+    m_highResolution = false;
+    timeBeginPeriod(1);
+    Logger::warning("Timer de alta resolução indisponível; usando resolução de 1 ms");
+    return true;
+}
+
+void TickSource::close() {
+    if (!m_timer) {
+        return;
+    }
+
+    CloseHandle(m_timer);
+    m_timer = nullptr;
+
+    if (!m_highResolution) {
+        timeEndPeriod(1);
+    }
+    m_highResolution = false;
+}
+
+void TickSource::setRate(int rateHz) {
+    m_rateHz = std::max(0, rateHz);
+    m_periodMicros = m_rateHz > 0 ? 1000000 / m_rateHz : 0;
+    m_nextTick = 0;
+}
+
+int TickSource::getRate() const {
+    return m_rateHz;
+}
+
+bool TickSource::isHighResolution() const {
+    return m_highResolution;
+}
+
+int64_t TickSource::nowMicros() const {
+    return Clock::getDefault()->nowMicros();
+}
+
+bool TickSource::waitNextTick(HANDLE interruptEvent) {
+    if (m_periodMicros <= 0) {
+        return false;
+    }
+
+    if (m_nextTick == 0) {
+        m_nextTick = nowMicros() + m_periodMicros;
+    }
+
+    if (!waitUntil(m_nextTick, interruptEvent, true)) {
+        return false;
+    }
+
+    m_nextTick += m_periodMicros;
+
+    // Após um atraso longo, realinhar em vez de disparar ticks em rajada
+    const int64_t now = nowMicros();
+    if (now > m_nextTick + m_periodMicros) {
+        m_skippedTicks += static_cast<uint64_t>((now - m_nextTick) / m_periodMicros);
+        m_nextTick = now + m_periodMicros;
+    }
+    return true;
+}
+
+bool TickSource::waitUntil(int64_t deadlineMicros, HANDLE interruptEvent, bool periodicTick) {
+    if (deadlineMicros == NO_DEADLINE) {
+        if (interruptEvent) {
+            WaitForSingleObject(interruptEvent, INFINITE);
+        }
+        return false;
+    }
+
+    const int64_t now = nowMicros();
+    if (now >= deadlineMicros) {
+        if (periodicTick) {
+            recordJitter(deadlineMicros, now);
+        }
+        return true;
+    }
+
+    const int64_t remaining = deadlineMicros - now;
+    bool deadlineReached = true;
+
+    if (m_timer) {
+        // Prazo relativo em unidades de 100 ns (valor negativo)
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -remaining * 10;
+        SetWaitableTimer(m_timer, &dueTime, 0, nullptr, nullptr, FALSE);
+
+        HANDLE handles[2] = { m_timer, interruptEvent };
+        const DWORD result = WaitForMultipleObjects(interruptEvent ? 2 : 1, handles, FALSE, INFINITE);
+        deadlineReached = (result != WAIT_OBJECT_0 + 1);
+    } else {
+        // Sem timer: espera em milissegundos, arredondada para cima
+        const DWORD timeoutMs = static_cast<DWORD>((remaining + 999) / 1000);
+        if (interruptEvent) {
+            deadlineReached = (WaitForSingleObject(interruptEvent, timeoutMs) != WAIT_OBJECT_0);
+        } else {
+            Sleep(timeoutMs);
+        }
+    }
+
+    if (!deadlineReached) {
+        return false;
+    }
+
+    if (periodicTick) {
+        recordJitter(deadlineMicros, nowMicros());
+    }
+    return true;
+}
+
+TickStats TickSource::getStats() const {
+    TickStats stats;
+    stats.ticks = m_ticks;
+    stats.skippedTicks = m_skippedTicks;
+    stats.achievedRateHz = 0.0;
+    stats.meanJitterMicros = 0.0;
+    stats.p99JitterMicros = 0;
+    stats.maxJitterMicros = m_maxJitterMicros;
+
+    if (m_ticks == 0) {
+        return stats;
+    }
+
+    stats.meanJitterMicros = static_cast<double>(m_totalJitterMicros) / m_ticks;
+    if (m_lastTickMicros > m_firstTickMicros) {
+        stats.achievedRateHz = (m_ticks - 1) * 1000000.0 / (m_lastTickMicros - m_firstTickMicros);
+    }
+
+    // Limite superior do balde que contém o percentil 99
+    const uint64_t target = m_ticks - m_ticks / 100;
+    uint64_t accumulated = 0;
+    for (int bucket = 0; bucket < JITTER_BUCKETS; ++bucket) {
+        accumulated += m_jitterHistogram[bucket];
+        if (accumulated >= target) {
+            stats.p99JitterMicros = std::min<int64_t>(m_maxJitterMicros, (bucket + 1) * JITTER_BUCKET_MICROS);
+            break;
+        }
+    }
+
+    return stats;
+}
+
+void TickSource::resetStats() {
+    m_ticks = 0;
+    m_skippedTicks = 0;
+    m_firstTickMicros = 0;
+    m_lastTickMicros = 0;
+    m_totalJitterMicros = 0;
+    m_maxJitterMicros = 0;
+    memset(m_jitterHistogram, 0, sizeof(m_jitterHistogram));
+}
+
+void TickSource::recordJitter(int64_t deadlineMicros, int64_t wokeMicros) {
+    const int64_t jitter = std::max<int64_t>(0, wokeMicros - deadlineMicros);
+    TRACE_INSTANT("tick", jitter);
+
+    if (m_ticks == 0) {
+        m_firstTickMicros = wokeMicros;
+    }
+    m_lastTickMicros = wokeMicros;
+    ++m_ticks;
+
+    m_totalJitterMicros += jitter;
+    m_maxJitterMicros = std::max(m_maxJitterMicros, jitter);
+
+    // O último balde acumula todos os atrasos acima da faixa do histograma
+    const int bucket = static_cast<int>(std::min<int64_t>(jitter / JITTER_BUCKET_MICROS, JITTER_BUCKETS - 1));
+    ++m_jitterHistogram[bucket];
+}
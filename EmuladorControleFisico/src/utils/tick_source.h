@@ -0,0 +1,143 @@
+/**
+ * @file tick_source.h
+ * @brief Despertares periódicos de alta resolução com medição de jitter
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include <cstdint>
+
+/**
+ * @struct TickStats
+ * @brief Estatísticas de atraso dos despertares
+ */
+struct TickStats {
+    uint64_t ticks;             // Despertares por prazo de tick periódico atingido
+    uint64_t skippedTicks;      // Ticks descartados após um atraso maior que um período
+    double achievedRateHz;      // Ticks por segundo entre o primeiro e o último
+    double meanJitterMicros;    // Atraso médio em relação ao prazo
+    int64_t p99JitterMicros;    // Percentil 99 do atraso
+    int64_t maxJitterMicros;    // Maior atraso observado
+};
+
+/**
+ * @class TickSource
+ * @brief Espera até prazos absolutos com timer de espera de alta resolução
+ *
+ * Usa CREATE_WAITABLE_TIMER_HIGH_RESOLUTION quando o sistema oferece (Windows 10
+ * 1803+), o que dispensa timeBeginPeriod; caso contrário usa um timer comum
+ * com resolução de 1 ms enquanto estiver aberto. As esperas podem ser
+ * interrompidas por um evento, de modo que a mesma thread atende ações
+ * imediatas e ticks periódicos.
+ *
+ * Pertence a uma única thread; as estatísticas devem ser lidas por ela ou
+ * depois que ela terminar.
+ */
+class TickSource {
+public:
+    /** Prazo que nunca é atingido: espera apenas pelo evento */
+    static const int64_t NO_DEADLINE = INT64_MAX;
+
+    /**
+     * @brief Construtor
+     * @param rateHz Taxa dos ticks periódicos (0 = apenas prazos avulsos)
+     */
+    explicit TickSource(int rateHz = 0);
+
+    /**
+     * @brief Destrutor
+     */
+    ~TickSource();
+
+    /**
+     * @brief Cria o timer
+     * @return true se criado (alta resolução ou comum), false caso contrário
+     */
+    bool open();
+
+    /**
+     * @brief Libera o timer
+     */
+    void close();
+
+    /**
+     * @brief Define a taxa dos ticks periódicos e recomeça a contagem
+     * @param rateHz Ticks por segundo (0 = desativado)
+     */
+    void setRate(int rateHz);
+
+    /**
+     * @brief Obtém a taxa dos ticks periódicos
+     * @return Ticks por segundo
+     */
+    int getRate() const;
+
+    /**
+     * @brief Indica se o timer de alta resolução está em uso
+     * @return true se alta resolução, false se timer comum
+     */
+    bool isHighResolution() const;
+
+    /**
+     * @brief Obtém o instante atual no relógio usado pelos prazos
+     * @return Tempo monotônico em microssegundos
+     */
+    int64_t nowMicros() const;
+
+    /**
+     * @brief Espera até o próximo tick periódico
+     * @param interruptEvent Evento que interrompe a espera (nullptr = nenhum)
+     * @return true no tick, false se interrompido ou sem taxa definida
+     */
+    bool waitNextTick(HANDLE interruptEvent = nullptr);
+
+    /**
+     * @brief Espera até um prazo absoluto
+     *
+     * Só prazos de tick periódico entram nas estatísticas; prazos avulsos
+     * (reenvio, reconexão) não são ticks e distorceriam o jitter e a taxa.
+     *
+     * @param deadlineMicros Prazo em microssegundos (NO_DEADLINE = só o evento)
+     * @param interruptEvent Evento que interrompe a espera (nullptr = nenhum)
+     * @param periodicTick Se true, o prazo é um tick periódico e o despertar é registrado
+     * @return true se o prazo foi atingido, false se o evento foi sinalizado
+     */
+    bool waitUntil(int64_t deadlineMicros, HANDLE interruptEvent = nullptr, bool periodicTick = false);
+
+    /**
+     * @brief Obtém as estatísticas de atraso
+     * @return Estatísticas acumuladas desde a abertura ou o último reset
+     */
+    TickStats getStats() const;
+
+    /**
+     * @brief Zera as estatísticas
+     */
+    void resetStats();
+
+private:
+    static const int JITTER_BUCKETS = 512;
+    static const int JITTER_BUCKET_MICROS = 10;
+
+    HANDLE m_timer;
+    bool m_highResolution;
+    int m_rateHz;
+    int64_t m_periodMicros;
+    int64_t m_nextTick;
+
+    uint64_t m_ticks;
+    uint64_t m_skippedTicks;
+    int64_t m_firstTickMicros;
+    int64_t m_lastTickMicros;
+    int64_t m_totalJitterMicros;
+    int64_t m_maxJitterMicros;
+    uint64_t m_jitterHistogram[JITTER_BUCKETS];
+
+    /**
+     * @brief Registra o atraso de um despertar
+     * @param deadlineMicros Prazo pedido
+     * @param wokeMicros Instante do despertar
+     */
+    void recordJitter(int64_t deadlineMicros, int64_t wokeMicros);
+};
@@ -0,0 +1,194 @@
+/**
+ * @file trace_recorder.cpp
+ * @brief Implementação do rastreamento em buffers circulares por thread
+ */
+
+#include "trace_recorder.h"
+#include "logger.h"
+#include <Windows.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Campos atômicos para que a exportação concorrente com a gravação seja bem definida
+struct TraceSlot {
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> timestampNanos;
+    std::atomic<int64_t> value;
+    std::atomic<char> phase;
+};
+
+struct ThreadRing {
+    DWORD threadId;
+    std::string threadName;  // Protegido por g_ringsMutex
+    std::atomic<uint64_t> head;
+    TraceSlot slots[TraceRecorder::EVENTS_PER_THREAD];
+
+    ThreadRing() : threadId(GetCurrentThreadId()), head(0) {}
+};
+
+struct ExportedEvent {
+    const char* name;
+    uint64_t timestampNanos;
+    int64_t value;
+    char phase;
+};
+
+std::mutex g_ringsMutex;
+std::vector<std::unique_ptr<ThreadRing>>& allRings() {
+    static std::vector<std::unique_ptr<ThreadRing>> rings;
+    return rings;
+}
+
+thread_local std::string t_threadName;
+thread_local ThreadRing* t_ring = nullptr;
+
+ThreadRing* currentRing() {
+    if (!t_ring) {
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        allRings().emplace_back(new ThreadRing());
+        t_ring = allRings().back().get();
+        t_ring->threadName = t_threadName;
+    }
+    return t_ring;
+}
+
+uint64_t nowNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * Copia os eventos ainda válidos de um buffer. Eventos sobrescritos durante a
+ * cópia são descartados comparando a posição de escrita antes e depois.
+ */
+std::vector<ExportedEvent> copyRing(const ThreadRing& ring) {
+    const uint64_t capacity = TraceRecorder::EVENTS_PER_THREAD;
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+    const uint64_t first = head > capacity ? head - capacity : 0;
+
+    std::vector<ExportedEvent> events;
+    events.reserve(static_cast<size_t>(head - first));
+    for (uint64_t i = first; i < head; ++i) {
+        const TraceSlot& slot = ring.slots[i % capacity];
+        ExportedEvent event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.timestampNanos = slot.timestampNanos.load(std::memory_order_relaxed);
+        event.value = slot.value.load(std::memory_order_relaxed);
+        event.phase = slot.phase.load(std::memory_order_relaxed);
+        events.push_back(event);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t headAfter = ring.head.load(std::memory_order_relaxed);
+
+    // A posição headAfter pode estar sendo escrita agora e ocupa o slot de headAfter - capacity
+    const uint64_t firstValid = headAfter + 1 > capacity ? headAfter + 1 - capacity : 0;
+    if (firstValid > first) {
+        const size_t overwritten = static_cast<size_t>(std::min<uint64_t>(firstValid - first, events.size()));
+        events.erase(events.begin(), events.begin() + overwritten);
+    }
+    return events;
+}
+
+} // namespace
+
+std::atomic<bool> TraceRecorder::s_enabled(false);
+
+void TraceRecorder::setEnabled(bool enabled) {
+    s_enabled.store(enabled, std::memory_order_relaxed);
+    Logger::info(enabled ? "Rastreamento do pipeline ativado" : "Rastreamento do pipeline desativado");
+}
+
+void TraceRecorder::setThreadName(const std::string& name) {
+    t_threadName = name;
+    if (t_ring) {
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        t_ring->threadName = name;
+    }
+}
+
+void TraceRecorder::begin(const char* name) {
+    record('B', name, 0);
+}
+
+void TraceRecorder::end(const char* name) {
+    record('E', name, 0);
+}
+
+void TraceRecorder::instant(const char* name, int64_t value) {
+    record('i', name, value);
+}
+
+void TraceRecorder::record(char phase, const char* name, int64_t value) {
+    ThreadRing* ring = currentRing();
+
+    // Único escritor por buffer: preencher o slot e só então publicar a nova posição
+    const uint64_t index = ring->head.load(std::memory_order_relaxed);
+    TraceSlot& slot = ring->slots[index % EVENTS_PER_THREAD];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.timestampNanos.store(nowNanos(), std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.phase.store(phase, std::memory_order_relaxed);
+    ring->head.store(index + 1, std::memory_order_release);
+}
+
+bool TraceRecorder::writeChromeTrace(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        Logger::error("Falha ao criar arquivo de rastreamento: " + filename);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_ringsMutex);
+
+    size_t total = 0;
+    bool firstEntry = true;
+    char buffer[256];
+
+    file << "{\"traceEvents\":[\n";
+    for (const auto& ring : allRings()) {
+        const std::string threadName = ring->threadName.empty() ? "thread " + std::to_string(ring->threadId) : ring->threadName;
+        snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+                 static_cast<unsigned long>(ring->threadId), threadName.c_str());
+        file << (firstEntry ? "" : ",\n") << buffer;
+        firstEntry = false;
+
+        int depth = 0;
+        for (const ExportedEvent& event : copyRing(*ring)) {
+            // O início de um intervalo pode ter sido sobrescrito; descartar o fim órfão
+            if (event.phase == 'E' && depth == 0) {
+                continue;
+            }
+            depth += (event.phase == 'B') ? 1 : (event.phase == 'E') ? -1 : 0;
+
+            const double timestampMicros = event.timestampNanos / 1000.0;
+            if (event.phase == 'i') {
+                snprintf(buffer, sizeof(buffer),
+                         "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%lu,\"args\":{\"value\":%lld}}",
+                         event.name, timestampMicros, static_cast<unsigned long>(ring->threadId),
+                         static_cast<long long>(event.value));
+            } else {
+                snprintf(buffer, sizeof(buffer), "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%lu}",
+                         event.name, event.phase, timestampMicros, static_cast<unsigned long>(ring->threadId));
+            }
+            file << ",\n" << buffer;
+            ++total;
+        }
+    }
+    file << "\n]}\n";
+
+    if (!file.good()) {
+        Logger::error("Falha ao gravar arquivo de rastreamento: " + filename);
+        return false;
+    }
+
+    Logger::info("Rastreamento gravado em " + filename + " (" + std::to_string(total) + " eventos)");
+    return true;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file trace_recorder.h
+ * @brief Rastreamento opcional do pipeline em buffers circulares por thread
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class TraceRecorder
+ * @brief Grava intervalos e eventos instantâneos para análise em chrome://tracing ou Perfetto
+ *
+ * Cada thread grava em um buffer circular próprio, criado no primeiro evento;
+ * com o buffer cheio os eventos mais antigos são sobrescritos, de modo que o
+ * arquivo exportado contém sempre os últimos segundos de atividade. Os nomes
+ * dos eventos devem ser literais (apenas o ponteiro é guardado).
+ *
+ * Com o rastreamento desligado, cada ponto de rastreamento custa apenas o
+ * teste de isEnabled(). Definir DISABLE_TRACING remove os pontos na compilação.
+ */
+class TraceRecorder {
+public:
+    static const size_t EVENTS_PER_THREAD = 16384;
+
+    /**
+     * @brief Liga ou desliga a gravação
+     * @param enabled true para gravar
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Verifica se a gravação está ligada
+     * @return true se ligada
+     */
+    static bool isEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Define o nome da thread atual exibido no rastreamento
+     * @param name Nome da thread
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * @brief Grava o início de um intervalo na thread atual
+     * @param name Nome do intervalo (literal)
+     */
+    static void begin(const char* name);
+
+    /**
+     * @brief Grava o fim do intervalo aberto mais recente na thread atual
+     * @param name Nome do intervalo (literal)
+     */
+    static void end(const char* name);
+
+    /**
+     * @brief Grava um evento instantâneo na thread atual
+     * @param name Nome do evento (literal)
+     * @param value Valor exibido nos argumentos do evento
+     */
+    static void instant(const char* name, int64_t value);
+
+    /**
+     * @brief Grava os buffers de todas as threads no formato JSON de trace events
+     *
+     * O arquivo abre diretamente em chrome://tracing e em ui.perfetto.dev.
+     * Pode ser chamado com a gravação em andamento.
+     *
+     * @param filename Caminho do arquivo
+     * @return true se gravado com sucesso, false caso contrário
+     */
+    static bool writeChromeTrace(const std::string& filename);
+
+private:
+    static std::atomic<bool> s_enabled;
+
+    /**
+     * @brief Grava um evento no buffer da thread atual
+     * @param phase Fase do evento ('B', 'E' ou 'i')
+     * @param name Nome do evento
+     * @param value Valor do evento
+     */
+    static void record(char phase, const char* name, int64_t value);
+};
+
+/**
+ * @class TraceScope
+ * @brief Intervalo que começa na construção e termina na destruição
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : m_name(TraceRecorder::isEnabled() ? name : nullptr) {
+        if (m_name) {
+            TraceRecorder::begin(m_name);
+        }
+    }
+
+    ~TraceScope() {
+        if (m_name) {
+            TraceRecorder::end(m_name);
+        }
+    }
+
+private:
+    const char* m_name;
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifndef DISABLE_TRACING
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_INSTANT(name, value) \
+    do { if (TraceRecorder::isEnabled()) TraceRecorder::instant(name, static_cast<int64_t>(value)); } while (0)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_INSTANT(name, value) do {} while (0)
+#endif